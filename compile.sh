@@ -1 +1,43 @@
-g++ -std=c++17 src/*.cpp src/game_threads/*.cpp -lpthread -lncurses -o bin/breakout
+mkdir -p bin
+g++ -std=c++17 -O3 src/*.cpp src/game_threads/*.cpp -lpthread -lncurses -o bin/breakout
+
+# Biblioteca del entorno de RL (sin ncurses)
+g++ -std=c++17 -O3 -c src/sim.cpp -o bin/sim.o
+g++ -std=c++17 -O3 -c src/snapshot.cpp -o bin/snapshot.o
+g++ -std=c++17 -O3 -c src/events.cpp -o bin/events.o
+g++ -std=c++17 -O3 -c src/autopilot.cpp -o bin/autopilot.o
+g++ -std=c++17 -O3 -c src/replay.cpp -o bin/replay.o
+g++ -std=c++17 -O3 -c src/live_export.cpp -o bin/live_export.o
+g++ -std=c++17 -O3 -c src/telemetry.cpp -o bin/telemetry.o
+g++ -std=c++17 -O3 -c src/spectate.cpp -o bin/spectate.o
+g++ -std=c++17 -O3 -c src/netplay.cpp -o bin/netplay.o
+g++ -std=c++17 -O3 -c src/ghost.cpp -o bin/ghost.o
+g++ -std=c++17 -O3 -c src/engine.cpp -o bin/engine.o
+g++ -std=c++17 -O3 -c src/vterm.cpp -o bin/vterm.o
+g++ -std=c++17 -O3 -c src/rl/rl_env.cpp -o bin/rl_env.o
+ar rcs bin/libbreakout_env.a bin/sim.o bin/snapshot.o bin/events.o bin/autopilot.o bin/replay.o bin/live_export.o bin/telemetry.o bin/spectate.o bin/netplay.o bin/ghost.o bin/engine.o bin/vterm.o bin/rl_env.o
+
+# Benchmark (el render se dibuja sobre una terminal virtual)
+g++ -std=c++17 -O3 tools/bench.cpp src/draw.cpp src/term_capture.cpp bin/libbreakout_env.a -lpthread -lncurses -o bin/bench
+
+# Validador de puntajes (repite las grabaciones en todos los núcleos)
+g++ -std=c++17 -O3 tools/validate.cpp src/highscores.cpp bin/libbreakout_env.a -lpthread -o bin/validate
+
+# Monitor de partidas en curso (lee la memoria compartida que publica el juego)
+g++ -std=c++17 -O3 tools/monitor.cpp bin/libbreakout_env.a -lpthread -o bin/monitor
+
+# Análisis de la telemetría (resume los .bkt de telemetry/ en todos los núcleos)
+g++ -std=c++17 -O3 tools/telemetry.cpp bin/libbreakout_env.a -lpthread -o bin/telemetry
+
+# Búsqueda de fallas de la física (partidas al azar en todos los núcleos)
+g++ -std=c++17 -O3 tools/fuzz.cpp bin/libbreakout_env.a -lpthread -o bin/fuzz
+
+
+# Espectador de partidas en curso (se conecta al socket que abre el juego)
+g++ -std=c++17 -O3 tools/spectate.cpp src/term_capture.cpp bin/libbreakout_env.a -lpthread -lncurses -o bin/spectate
+
+# Prueba del coop en red (dos procesos por loopback con latencia y pérdida simuladas)
+g++ -std=c++17 -O3 tools/netplay.cpp bin/libbreakout_env.a -lpthread -o bin/netplay
+
+# Prueba de los hilos del juego (partidas sin terminal contra su repetición)
+g++ -std=c++17 -O3 tools/pipeline.cpp src/game.cpp src/draw.cpp src/game_threads/*.cpp bin/libbreakout_env.a -lpthread -lncurses -o bin/pipeline
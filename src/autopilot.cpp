@@ -0,0 +1,123 @@
+#include "autopilot.h"
+#include <algorithm>
+#include <cmath>
+
+// Frames que espera con la bola sobre la paleta antes de lanzarla
+static const int LAUNCH_DELAY = 15;
+
+// Refleja una coordenada "desplegada" dentro de [lo, hi], como si rebotara
+// contra ambos extremos
+static float foldInto(float x, float lo, float hi) {
+    float w = hi - lo;
+    if (w <= 0.0f) return lo;
+    float u = std::fmod(x - lo, 2.0f * w);
+    if (u < 0.0f) u += 2.0f * w;
+    return (u <= w) ? lo + u : lo + 2.0f * w - u;
+}
+
+float predictCrossing(const GameConfig& cfg, int i, float rowY) {
+    const WallBounds W = computeWallBounds(cfg);
+    float x = cfg.balls.x[i], y = cfg.balls.y[i];
+    float vx = cfg.balls.vx[i], vy = cfg.balls.vy[i];
+    if (vy == 0.0f) return x;
+
+    // Distancia vertical hasta la fila: directa si baja, o ida y vuelta al
+    // techo si sube (hasta donde rebota y desde donde queda después, como en
+    // simWallsPaddles). La velocidad escala el tiempo, no el recorrido
+    float dist;
+    if (vy > 0.0f) {
+        dist = rowY - y;
+        if (dist <= 0.0f) return x;
+    } else {
+        dist = std::max(0.0f, y - W.ceilingBounce) + (rowY - W.resetCeiling);
+    }
+    return foldInto(x + vx * (dist / std::fabs(vy)), W.left, W.right);
+}
+
+// Generador propio del autopiloto (xorshift). Se siembra con el estado del
+// de la partida la primera vez, sin avanzarlo
+static uint32_t nextRandom(Autopilot& ap, const GameConfig& cfg) {
+    if (ap.rng == 0) ap.rng = (cfg.rng * 2654435761u) | 1u;
+    uint32_t x = ap.rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    ap.rng = x;
+    return x;
+}
+
+void autopilotReset(Autopilot& ap) {
+    ap = Autopilot{};
+}
+
+// Bola a seguir: la más baja de las que bajan (o la 0 si ninguna baja)
+static int pickBall(const GameConfig& cfg) {
+    const BallPool& b = cfg.balls;
+    int best = -1;
+    float bestY = -1e9f;
+    for (int i = 0; i < b.count; ++i) {
+        if (b.vy[i] > 0.0f && b.y[i] > bestY) {
+            bestY = b.y[i];
+            best = i;
+        }
+    }
+    return (best >= 0) ? best : (b.count > 0 ? 0 : -1);
+}
+
+void autopilotStep(Autopilot& ap, GameConfig& cfg, int player) {
+    if (!cfg.running || cfg.paused) return;
+    ap.steps++;
+    Paddle& p = cfg.paddles[player];
+
+    if (!cfg.ballLaunched) {
+        p.desiredDir = 0;
+        ap.ball = -1;
+        if (++ap.waitFrames >= LAUNCH_DELAY) {
+            ap.waitFrames = 0;
+            simLaunch(cfg);
+        }
+        return;
+    }
+    if (cfg.laserFrames > 0) simFire(cfg);
+
+    int i = pickBall(cfg);
+    if (i < 0) { p.desiredDir = 0; return; }
+
+    // Sin sumar puntos por un rato la bola está en un ciclo
+    if (cfg.score != ap.lastScore) {
+        ap.lastScore = cfg.score;
+        ap.stallFrames = 0;
+    } else {
+        ap.stallFrames++;
+    }
+
+    // Sólo se predice de nuevo si cambió la bola o su dirección
+    const BallPool& b = cfg.balls;
+    if (i != ap.ball || b.vx[i] != ap.vx || b.vy[i] != ap.vy) {
+        // Al empezar una bajada nueva se elige dónde golpearla para variar
+        // los ángulos; en un ciclo, en toda la paleta
+        if (b.vy[i] > 0.0f && (i != ap.ball || ap.vy <= 0.0f)) {
+            int r = (int)(nextRandom(ap, cfg) >> 8);
+            if (ap.stallFrames < AUTOPILOT_STALL_FRAMES) {
+                ap.aim = 0.10f * (float)(r % 9 - 4);               // [-0.4..0.4]
+            } else {
+                ap.aim = 0.10f * (float)(r % 19 - 9);              // [-0.9..0.9]
+            }
+        }
+        ap.ball = i;
+        ap.vx = b.vx[i];
+        ap.vy = b.vy[i];
+        ap.targetX = predictCrossing(cfg, i, p.y - 1.5f);
+        ap.predictions++;
+    }
+
+    // El punto de golpe queda al menos a una celda y media del borde: la
+    // paleta se detiene con una celda de tolerancia
+    float half = p.w / 2.0f;
+    float reach = std::max(0.0f, half - 1.5f);
+    float goal = ap.targetX - std::max(-reach, std::min(reach, ap.aim * half));
+    float center = p.x + half;
+    if (goal > center + 1.0f) p.desiredDir = 1;
+    else if (goal < center - 1.0f) p.desiredDir = -1;
+    else p.desiredDir = 0;
+}
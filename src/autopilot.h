@@ -0,0 +1,45 @@
+/*
+autopilot.h - Jugador automático. Predice dónde cruzará la bola la fila de la
+paleta reflejando la trayectoria contra paredes y techo en forma analítica, y
+mueve la paleta hacia ese punto. La predicción sólo se recalcula cuando cambia
+la velocidad de la bola (un rebote o un ladrillo), no en cada frame.
+
+Dónde golpear la bola con la paleta se elige al azar en cada bajada, con un
+generador propio que se siembra con el de la partida sin consumirlo (las
+grabaciones del autopiloto se repiten igual). Si pasa AUTOPILOT_STALL_FRAMES
+sin sumar puntos apunta a cualquier parte de la paleta para salir del ciclo.
+
+Sirve para el modo demo del menú y como jugador determinista para pruebas de
+carga sin terminal. No depende de ncurses.
+*/
+#ifndef AUTOPILOT_H
+#define AUTOPILOT_H
+
+#include "sim.h"
+
+// Frames sin sumar puntos tras los que el autopiloto se considera en un ciclo
+const int AUTOPILOT_STALL_FRAMES = 600;
+
+struct Autopilot {
+    int ball = -1;                 // Bola que se sigue (-1 = ninguna)
+    float vx = 0.0f, vy = 0.0f;    // Velocidad con la que se hizo la predicción
+    float targetX = 0.0f;          // Columna donde la bola cruzará la paleta
+    float aim = 0.0f;              // Dónde golpearla, relativo al centro [-1..1]
+    int waitFrames = 0;            // Frames esperando para lanzar
+    uint32_t rng = 0;              // Generador propio (0 = sin sembrar todavía)
+    int lastScore = 0;
+    int stallFrames = 0;           // Frames sin romper ni golpear un ladrillo
+    unsigned long predictions = 0; // Predicciones calculadas
+    unsigned long steps = 0;       // Frames controlados
+};
+
+// Columna donde la bola i cruzará la fila y = rowY (rebotando en paredes y techo)
+float predictCrossing(const GameConfig& cfg, int i, float rowY);
+
+void autopilotReset(Autopilot& ap);
+
+// Decide el movimiento de la paleta `player` para este frame (antes de
+// simPaddles). También lanza la bola y dispara el láser cuando corresponde
+void autopilotStep(Autopilot& ap, GameConfig& cfg, int player = 0);
+
+#endif // AUTOPILOT_H
@@ -0,0 +1,394 @@
+#include "game.h"
+#include <ncurses.h>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <string>
+#include <algorithm>
+
+// Pares de color
+enum ColorPair {
+    PAIR_HP1 = 1,
+    PAIR_HP2,
+    PAIR_HP3,
+    PAIR_BALL,
+    PAIR_PADDLE,
+    PAIR_POWERUP
+};
+
+// Atributos de cada elemento (los fija initRenderColors)
+static attr_t g_hpAttr[4] = {A_NORMAL, A_NORMAL, A_NORMAL, A_NORMAL};   // Por HP (0 no se dibuja)
+static attr_t g_ballAttr = A_BOLD;
+static attr_t g_paddleAttr = A_REVERSE;
+static attr_t g_powerUpAttr = A_BOLD;
+static attr_t g_shotAttr = A_BOLD;
+static attr_t g_ghostAttr = A_DIM;
+
+void initRenderColors() {
+    if (!has_colors() || start_color() == ERR) {
+        g_hpAttr[1] = A_NORMAL;
+        g_hpAttr[2] = A_NORMAL;
+        g_hpAttr[3] = A_BOLD;
+        return;
+    }
+    short bg = (use_default_colors() == OK) ? -1 : COLOR_BLACK;
+    init_pair(PAIR_HP1, COLOR_GREEN, bg);
+    init_pair(PAIR_HP2, COLOR_YELLOW, bg);
+    init_pair(PAIR_HP3, COLOR_RED, bg);
+    init_pair(PAIR_BALL, COLOR_WHITE, bg);
+    init_pair(PAIR_PADDLE, COLOR_CYAN, bg);
+    init_pair(PAIR_POWERUP, COLOR_MAGENTA, bg);
+    g_hpAttr[1] = COLOR_PAIR(PAIR_HP1);
+    g_hpAttr[2] = COLOR_PAIR(PAIR_HP2);
+    g_hpAttr[3] = COLOR_PAIR(PAIR_HP3);
+    g_ballAttr = COLOR_PAIR(PAIR_BALL) | A_BOLD;
+    g_paddleAttr = COLOR_PAIR(PAIR_PADDLE) | A_REVERSE;
+    g_powerUpAttr = COLOR_PAIR(PAIR_POWERUP) | A_BOLD;
+    g_shotAttr = COLOR_PAIR(PAIR_PADDLE) | A_BOLD;
+    g_ghostAttr = COLOR_PAIR(PAIR_PADDLE) | A_DIM;
+}
+
+// Color según el HP que le queda; los ladrillos duros ('@') van en negrita
+// aunque estén dañados
+static attr_t brickAttr(const Brick& b) {
+    return g_hpAttr[std::min(b.hp, 3)] | (b.ch == '@' ? A_BOLD : A_NORMAL);
+}
+
+// Atributo actual de una ventana: sólo se cambia cuando el siguiente tramo
+// lo necesita, y se cuentan los cambios
+struct AttrState {
+    WINDOW* win;
+    attr_t cur = A_NORMAL;
+    int switches = 0;
+
+    explicit AttrState(WINDOW* w) : win(w) { wattrset(win, A_NORMAL); }
+
+    void set(attr_t a) {
+        if (a == cur) return;
+        wattrset(win, a);
+        cur = a;
+        ++switches;
+    }
+};
+
+// Ayuda inferior del juego normal
+static const char* const HELP_LINE =
+    "Flechas/A-D: Mover | SPACE: Lanzar | P: Pausa | R: Reiniciar | Q/ESC: Salir";
+
+// Marco y título del tablero (sólo cuando cambia la geometría o se reinicia)
+void drawBoardFrame(const DrawTarget& t, const GameConfig& local) {
+    int top = local.top - t.y, bottom = local.bottom - t.y;
+    int left = local.left - t.x, right = local.right - t.x;
+    mvwhline(t.win, top, left, '=', right - left + 1);
+    mvwhline(t.win, bottom, left, '=', right - left + 1);
+    mvwvline(t.win, top, left, '|', bottom - top + 1);
+    mvwvline(t.win, top, right, '|', bottom - top + 1);
+    mvwaddch(t.win, top, left, '+');
+    mvwaddch(t.win, top, right, '+');
+    mvwaddch(t.win, bottom, left, '+');
+    mvwaddch(t.win, bottom, right, '+');
+
+    // Título
+    const char* title = "BREAKOUT";
+    int titleLen = (int)std::strlen(title);
+    mvwaddstr(t.win, top, left + (local.w - titleLen) / 2, title);
+}
+
+void formatHud(const GameConfig& local, char* out, size_t size, const GhostFrame* ghost) {
+    int n = snprintf(out, size, " Score: %d | Lives: %d | Level: %d | %s%s ",
+                     local.score, local.lives, local.level, local.paused ? "PAUSED" : "PLAYING",
+                     local.laserFrames > 0 ? " | LASER" : "");
+    // Diferencia con el fantasma en el mismo frame
+    if (ghost && n > 0 && (size_t)n < size) {
+        snprintf(out + n, size - n, "| Fantasma: %+d ", local.score - ghost->score);
+    }
+}
+
+const char* boardMessage(const GameConfig& local) {
+    if (local.won) return "¡GANASTE! Presiona R";
+    if (local.lost) return "PERDISTE - Presiona R";
+    if (!local.ballLaunched && local.running) return "Presiona ESPACIO para lanzar la bola";
+    return nullptr;
+}
+
+// Largo con el que se muestra un mensaje (recortado al área jugable) y su
+// columna de pantalla
+static int messageLength(const GameConfig& local, const char* msg, int& x) {
+    int len = std::min((int)std::strlen(msg), local.w - 2);
+    x = local.x0 + (local.w - len) / 2;
+    return len;
+}
+
+// Vacía la cola de eventos de ladrillos del tablero y marca qué filas hay que
+// reconstruir. Se llama antes de copiar el estado: así todo evento leído ya
+// está reflejado en la copia
+void drainBrickEvents(Board* board, BrickRows& cache) {
+    GameEvent ev;
+    while (board->renderQueue.pop(ev)) noteBrickEvent(ev, cache);
+}
+
+void noteBrickEvent(const GameEvent& ev, BrickRows& cache) {
+    if (ev.type == EV_LEVEL_STARTED) {
+        cache.valid = false;
+    } else if ((ev.type == EV_BRICK_HIT || ev.type == EV_BRICK_DESTROYED) && ev.a >= 0 &&
+               ev.a < (int)cache.dirty.size()) {
+        cache.dirty[ev.a] = 1;
+    }
+}
+
+// Reconstruye la línea de una fila de ladrillos (huecos como espacios) y sus
+// tramos: ladrillos seguidos con el mismo atributo forman un solo tramo,
+// aunque haya un hueco entre ellos
+static void buildBrickRow(const GameConfig& local, const BrickLayout& L, int r, std::string& line,
+                          std::vector<BrickRun>& runs) {
+    line.assign(local.w - 2, ' ');
+    runs.clear();
+    int x = 0;
+    for (int c = 0; c < local.cols; ++c) {
+        int thisW = L.brickW + (c < L.remainder ? 1 : 0);
+        const Brick& b = local.grid[r][c];
+        if (b.hp > 0) {
+            int len = std::min(thisW, (int)line.size() - x);
+            for (int k = 0; k < len; ++k) line[x + k] = b.ch;
+            attr_t a = brickAttr(b);
+            if (len > 0) {
+                if (!runs.empty() && runs.back().attr == a && (c == 0 || local.grid[r][c - 1].hp > 0)) {
+                    runs.back().len = x + len - runs.back().x;
+                } else {
+                    runs.push_back(BrickRun{x, len, a});
+                }
+            }
+        }
+        x += thisW;
+        if (c < local.cols - 1) x += local.gapX;
+    }
+}
+
+void updateBrickRows(const GameConfig& local, BrickRows& cache) {
+    BrickLayout L = computeBrickLayout(local);
+    if ((int)cache.rows.size() != local.rows) {
+        cache.rows.resize(local.rows);
+        cache.runs.resize(local.rows);
+        cache.dirty.assign(local.rows, 1);
+        cache.valid = false;
+    }
+    bool changed = !cache.valid;
+    for (int r = 0; r < local.rows; ++r) {
+        if (!cache.valid || cache.dirty[r]) {
+            buildBrickRow(local, L, r, cache.rows[r], cache.runs[r]);
+            cache.dirty[r] = 0;
+            changed = true;
+        }
+    }
+    if (changed) {
+        cache.attrs.clear();
+        for (const auto& row : cache.runs) {
+            for (const BrickRun& run : row) {
+                if (std::find(cache.attrs.begin(), cache.attrs.end(), run.attr) == cache.attrs.end()) {
+                    cache.attrs.push_back(run.attr);
+                }
+            }
+        }
+    }
+    cache.valid = true;
+}
+
+// Área jugable: ladrillos, power-ups, paletas y pelotas. Se dibuja agrupado
+// por atributo (todos los ladrillos de un color, luego las paletas, luego las
+// bolas...) para cambiarlo una vez por grupo y no por celda
+int drawPlayfield(const DrawTarget& t, const GameConfig& local, const BrickRows& cache,
+                  const GhostFrame* ghost) {
+    WINDOW* win = t.win;
+    AttrState attr(win);
+
+    // 1) Limpiar el área (entre el marco, sin la fila del HUD)
+    for (int y = local.y0 + 1; y < local.y1; ++y) {
+        mvwhline(win, y - t.y, local.x0 + 1 - t.x, ' ', local.x1 - local.x0 - 1);
+    }
+
+    // 2) Ladrillos: tramos pre-calculados de cada fila, una pasada por atributo
+    int startY = local.y0 + 2;
+    int rows = std::min(local.rows, (int)cache.rows.size());
+    for (attr_t a : cache.attrs) {
+        attr.set(a);
+        for (int r = 0; r < rows; ++r) {
+            int by = startY + r * (local.brickH + local.gapY);
+            const std::string& line = cache.rows[r];
+            for (const BrickRun& run : cache.runs[r]) {
+                if (run.attr != a) continue;
+                for (int h = 0; h < local.brickH; ++h) {
+                    mvwaddnstr(win, by + h - t.y, local.x0 + 1 + run.x - t.x, line.c_str() + run.x, run.len);
+                }
+            }
+        }
+    }
+
+    // Ladrillos libres: pueden moverse en cada frame, así que van directo de
+    // la copia, también en una pasada por atributo
+    const FreeBricks& F = local.freeBricks;
+    attr_t freeAttrs[8];
+    int numFreeAttrs = 0;
+    for (int i = 0; i < F.count && numFreeAttrs < 8; ++i) {
+        if (F.brick[i].hp <= 0) continue;
+        attr_t a = brickAttr(F.brick[i]);
+        attr_t* end = freeAttrs + numFreeAttrs;
+        if (std::find(freeAttrs, end, a) == end) freeAttrs[numFreeAttrs++] = a;
+    }
+    for (int k = 0; k < numFreeAttrs; ++k) {
+        attr.set(freeAttrs[k]);
+        for (int i = 0; i < F.count; ++i) {
+            if (F.brick[i].hp <= 0 || brickAttr(F.brick[i]) != freeAttrs[k]) continue;
+            mvwhline(win, F.y[i] - t.y, F.x[i] - t.x, (unsigned char)F.brick[i].ch, F.w[i]);
+        }
+    }
+
+    // 3) Power-ups y disparos
+    static const char POWER_CH[POWER_COUNT] = {'W', 'M', 'L'};
+    if (local.powerUps.live > 0) attr.set(g_powerUpAttr);
+    for (int i = 0; i < local.powerUps.high; ++i) {
+        if (!local.powerUps.alive[i]) continue;
+        mvwaddch(win, (int)std::round(local.powerUps.y[i]) - t.y, (int)std::round(local.powerUps.x[i]) - t.x,
+                 POWER_CH[local.powerUps.kind[i]]);
+    }
+    if (local.shots.live > 0) attr.set(g_shotAttr);
+    for (int i = 0; i < local.shots.high; ++i) {
+        if (!local.shots.alive[i]) continue;
+        mvwaddch(win, (int)std::round(local.shots.y[i]) - t.y, (int)std::round(local.shots.x[i]) - t.x, '|');
+    }
+
+    // 4) Fantasma: tenue y antes que lo de la partida, que queda encima
+    if (ghost) {
+        attr.set(g_ghostAttr);
+        if (ghost->padW > 0) mvwhline(win, ghost->padY - t.y, ghost->padX - t.x, '-', ghost->padW);
+        for (int i = 0; i < ghost->balls; ++i) mvwaddch(win, ghost->ballY[i] - t.y, ghost->ballX[i] - t.x, 'o');
+    }
+
+    // 5) Paletas
+    attr.set(g_paddleAttr);
+    for (int p = 0; p < local.numPlayers; ++p) {
+        const Paddle& pad = local.paddles[p];
+        mvwhline(win, pad.y - t.y, pad.x - t.x, '=', pad.w);
+    }
+
+    // 6) Pelotas
+    attr.set(g_ballAttr);
+    for (int i = 0; i < local.balls.count; ++i) {
+        int ballScreenY = (int)std::round(local.balls.y[i]);
+        int ballScreenX = (int)std::round(local.balls.x[i]);
+        mvwaddch(win, ballScreenY - t.y, ballScreenX - t.x, 'o');
+    }
+
+    attr.set(A_NORMAL);
+    return attr.switches;
+}
+
+// Tablero completo sobre stdscr (versus): HUD, área jugable y mensaje
+int drawBoard(const GameConfig& local, const BrickRows& cache, const GhostFrame* ghost) {
+    char hud[128];
+    formatHud(local, hud, sizeof(hud), ghost);
+    mvaddnstr(local.top + 1, local.left + 2, hud, local.w - 3);
+
+    int switches = drawPlayfield(DrawTarget{stdscr, 0, 0}, local, cache, ghost);
+
+    if (const char* msg = boardMessage(local)) {
+        int x, len = messageLength(local, msg, x);
+        mvaddnstr(local.y0 + local.h / 2, x, msg, len);
+    }
+    return switches;
+}
+
+/*
+VENTANAS DEL JUEGO NORMAL
+*/
+
+bool openBoardWindows(BoardWindows& w, const GameConfig& cfg) {
+    closeBoardWindows(w);
+    // El marco incluye la fila de ayuda de abajo; se recorta a la pantalla
+    int frameH = std::min(cfg.bottom - cfg.top + 2, LINES - cfg.top);
+    int frameW = std::min(std::max(cfg.right - cfg.left + 1, (int)std::strlen(HELP_LINE) + 2),
+                          COLS - cfg.left);
+    if (cfg.top < 0 || cfg.left < 0 || frameH <= cfg.bottom - cfg.top || frameW <= 0) return false;
+
+    w.frame = newwin(frameH, frameW, cfg.top, cfg.left);
+    w.hud = newwin(1, cfg.w, cfg.y0, cfg.x0);
+    w.play = newwin(cfg.h - 1, cfg.w, cfg.y0 + 1, cfg.x0);
+    if (!w.frame || !w.hud || !w.play) {
+        closeBoardWindows(w);
+        return false;
+    }
+    return true;
+}
+
+void closeBoardWindows(BoardWindows& w) {
+    for (WINDOW** win : {&w.overlay, &w.play, &w.hud, &w.frame}) {
+        if (*win) delwin(*win);
+        *win = nullptr;
+    }
+    w.hudText.clear();
+    w.message = nullptr;
+}
+
+// Dibuja un frame en las ventanas. Cada ventana pasa a la pantalla virtual
+// sólo si cambió; el orden de wnoutrefresh es el de las capas (la última
+// queda arriba) y doupdate manda todo a la terminal de una vez
+int renderWindows(BoardWindows& w, const GameConfig& local, const BrickRows& bricks,
+                  bool redrawAll, const GhostFrame* ghost) {
+    if (redrawAll) {
+        // Lo que quedó del menú se borra con la pantalla completa
+        wclear(stdscr);
+        wnoutrefresh(stdscr);
+        werase(w.frame);
+        drawBoardFrame(DrawTarget{w.frame, local.top, local.left}, local);
+        mvwaddnstr(w.frame, local.bottom + 1 - local.top, 2, HELP_LINE, getmaxx(w.frame) - 2);
+        wnoutrefresh(w.frame);
+        w.hudText.clear();
+    }
+
+    // Área jugable: cambia con cada frame simulado
+    int switches = drawPlayfield(DrawTarget{w.play, local.y0 + 1, local.x0}, local, bricks, ghost);
+    wnoutrefresh(w.play);
+
+    // HUD: sólo si cambió el texto
+    char hud[128];
+    formatHud(local, hud, sizeof(hud), ghost);
+    if (redrawAll || w.hudText != hud) {
+        werase(w.hud);
+        mvwaddnstr(w.hud, 0, 1, hud, local.w - 3);
+        w.hudText = hud;
+        wnoutrefresh(w.hud);
+    }
+
+    // Mensaje: ventana del tamaño del texto, encima del área jugable. Como el
+    // área se copia completa en cada frame, el mensaje se vuelve a copiar
+    // después para que quede arriba
+    const char* msg = boardMessage(local);
+    if (redrawAll || msg != w.message) {
+        if (w.overlay) delwin(w.overlay);
+        w.overlay = nullptr;
+        if (msg) {
+            int x, len = messageLength(local, msg, x);
+            w.overlay = newwin(1, std::max(1, len), local.y0 + local.h / 2, x);
+            if (w.overlay) mvwaddnstr(w.overlay, 0, 0, msg, len);
+        }
+        w.message = msg;
+    }
+    if (w.overlay) {
+        touchwin(w.overlay);
+        wnoutrefresh(w.overlay);
+    }
+
+    doupdate();
+    return switches;
+}
+
+// Sin ventanas (no entraron en la terminal) se dibuja sobre stdscr
+int renderStdscr(const GameConfig& local, const BrickRows& bricks, bool redrawAll, const GhostFrame* ghost) {
+    if (redrawAll) {
+        clear();
+        drawBoardFrame(DrawTarget{stdscr, 0, 0}, local);
+        mvaddstr(local.bottom + 1, local.left + 2, HELP_LINE);
+    }
+    int switches = drawBoard(local, bricks, ghost);
+    refresh();
+    return switches;
+}
@@ -0,0 +1,93 @@
+#include "engine.h"
+#include <sched.h>
+
+EngineThreads::EngineThreads() {
+    pthread_mutex_init(&mutex, nullptr);
+    pthread_cond_init(&doneCV, nullptr);
+    for (int i = 0; i < ENGINE_THREADS; ++i) {
+        slots[i].group = this;
+        slots[i].index = i;
+        pthread_cond_init(&slots[i].cv, nullptr);
+    }
+}
+
+EngineThreads::~EngineThreads() {
+    stop();
+    for (Slot& s : slots) pthread_cond_destroy(&s.cv);
+    pthread_cond_destroy(&doneCV);
+    pthread_mutex_destroy(&mutex);
+}
+
+void* EngineThreads::worker(void* arg) {
+    auto* slot = (Slot*)arg;
+    EngineThreads* g = slot->group;
+
+#ifdef __linux__
+    cpu_set_t cpus;
+    bool haveCpus = pthread_getaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#endif
+
+    pthread_mutex_lock(&g->mutex);
+    while (true) {
+        while (!g->quit && !slot->assigned) pthread_cond_wait(&slot->cv, &g->mutex);
+        if (g->quit) break;
+        EngineJob job = slot->job;
+        pthread_mutex_unlock(&g->mutex);
+
+        job.fn(job.arg);
+
+        // El trabajo pudo fijar el hilo a un núcleo: vuelve al de antes
+#ifdef __linux__
+        if (haveCpus) pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+#endif
+
+        pthread_mutex_lock(&g->mutex);
+        slot->assigned = false;
+        if (--g->pending == 0) pthread_cond_signal(&g->doneCV);
+    }
+    pthread_mutex_unlock(&g->mutex);
+    return nullptr;
+}
+
+int EngineThreads::start() {
+    pthread_mutex_lock(&mutex);
+    quit = false;
+    while (started < ENGINE_THREADS &&
+           pthread_create(&slots[started].thread, nullptr, worker, &slots[started]) == 0) {
+        ++started;
+    }
+    int n = started;
+    pthread_mutex_unlock(&mutex);
+    return n;
+}
+
+void EngineThreads::stop() {
+    pthread_mutex_lock(&mutex);
+    quit = true;
+    for (int i = 0; i < started; ++i) pthread_cond_signal(&slots[i].cv);
+    int n = started;
+    started = 0;
+    pthread_mutex_unlock(&mutex);
+    for (int i = 0; i < n; ++i) pthread_join(slots[i].thread, nullptr);
+}
+
+bool EngineThreads::attach(const EngineJob* jobs, int n) {
+    pthread_mutex_lock(&mutex);
+    bool ok = n <= started && pending == 0;
+    if (ok) {
+        pending = n;
+        for (int i = 0; i < n; ++i) {
+            slots[i].job = jobs[i];
+            slots[i].assigned = true;
+            pthread_cond_signal(&slots[i].cv);
+        }
+    }
+    pthread_mutex_unlock(&mutex);
+    return ok;
+}
+
+void EngineThreads::detach() {
+    pthread_mutex_lock(&mutex);
+    while (pending > 0) pthread_cond_wait(&doneCV, &mutex);
+    pthread_mutex_unlock(&mutex);
+}
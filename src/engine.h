@@ -0,0 +1,71 @@
+/*
+engine.h - Hilos del motor: un grupo de hilos que se crea una vez al iniciar
+el programa y queda estacionado entre sesiones.
+
+Cada sesión (partida normal, versus, coop en red) le asigna sus funciones de
+hilo con attach() y espera con detach() a que todas vuelvan. Cada hilo duerme
+en su propia variable de condición: asignarle trabajo es una señal y no una
+creación de hilo, y al terminar queda listo para la próxima sesión con la
+afinidad de núcleo que tenía al crearse (versus fija los suyos).
+
+No depende de ncurses.
+*/
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <cstdint>
+#include <pthread.h>
+
+// Hilos del grupo: los que usa la sesión más grande (partida normal con
+// sonido, telemetría, espectadores y fantasma)
+const int ENGINE_THREADS = 12;
+
+typedef void* (*EngineFn)(void*);
+
+// Trabajo de un hilo durante una sesión
+struct EngineJob {
+    EngineFn fn;
+    void* arg;
+};
+
+class EngineThreads {
+private:
+    struct Slot {
+        EngineThreads* group;
+        int index;
+        pthread_t thread;
+        pthread_cond_t cv;        // El hilo duerme aquí entre trabajos
+        EngineJob job;
+        bool assigned = false;    // Tiene un trabajo de la sesión en curso
+    };
+
+    pthread_mutex_t mutex;
+    pthread_cond_t doneCV;        // detach() espera aquí
+    Slot slots[ENGINE_THREADS];
+    int started = 0;
+    int pending = 0;              // Trabajos de la sesión que no volvieron
+    bool quit = false;
+
+    static void* worker(void* arg);
+
+public:
+    EngineThreads();
+    ~EngineThreads();
+    EngineThreads(const EngineThreads&) = delete;
+    EngineThreads& operator=(const EngineThreads&) = delete;
+
+    // Crea los hilos que falten; devuelve cuántos hay
+    int start();
+    // Termina los hilos (sin sesión en curso)
+    void stop();
+    int size() const { return started; }
+
+    // Asigna un trabajo a cada uno de los primeros n hilos y los despierta,
+    // sin esperar. false si n supera los hilos que se pudieron crear o si
+    // todavía hay una sesión en curso
+    bool attach(const EngineJob* jobs, int n);
+    // Espera a que vuelvan todos los trabajos de la sesión
+    void detach();
+};
+
+#endif // ENGINE_H
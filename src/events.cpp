@@ -0,0 +1,84 @@
+#include "events.h"
+#include <cerrno>
+
+/*
+COLA DE EVENTOS (un productor, un consumidor)
+*/
+
+EventQueue::EventQueue(size_t capacityPow2) {
+    size_t cap = 1;
+    while (cap < capacityPow2) cap <<= 1;
+    buf.resize(cap);
+    mask = cap - 1;
+    sem_init(&ready, 0, 0);
+}
+
+EventQueue::~EventQueue() {
+    sem_destroy(&ready);
+}
+
+bool EventQueue::push(const GameEvent& ev) {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) > mask) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    buf[h & mask] = ev;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+bool EventQueue::pop(GameEvent& ev) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) return false;
+    ev = buf[t & mask];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+void EventQueue::notify() {
+    sem_post(&ready);
+}
+
+void EventQueue::wait() {
+    while (sem_wait(&ready) != 0 && errno == EINTR) {}
+}
+
+/*
+BUS DE EVENTOS
+*/
+
+EventBus::EventBus() {
+    for (int t = 0; t < EV_COUNT; ++t) published[t].store(0);
+}
+
+bool EventBus::subscribe(EventQueue* q, uint32_t mask, bool wake) {
+    if (count >= MAX_SUBSCRIBERS) return false;
+    queues[count] = q;
+    masks[count] = mask;
+    wakes[count] = wake;
+    ++count;
+    return true;
+}
+
+void EventBus::publish(FrameEvents& events) {
+    if (events.list.empty()) return;
+
+    for (const GameEvent& ev : events.list) {
+        published[ev.type].fetch_add(1, std::memory_order_relaxed);
+    }
+    for (int s = 0; s < count; ++s) {
+        bool any = false;
+        for (const GameEvent& ev : events.list) {
+            if (masks[s] & eventBit(ev.type)) any |= queues[s]->push(ev);
+        }
+        if (any && wakes[s]) queues[s]->notify();
+    }
+    events.clear();
+}
+
+void EventBus::notifyAll() {
+    for (int s = 0; s < count; ++s) {
+        if (wakes[s]) queues[s]->notify();
+    }
+}
@@ -0,0 +1,128 @@
+/*
+events.h - Eventos de la partida. La simulación anota lo que pasa en cada
+frame (ladrillo golpeado, vida perdida, nivel terminado...) en un buffer del
+propio GameConfig; al cerrar el frame, la etapa que lo termina publica esos
+eventos en el bus del tablero, que los copia a una cola por suscriptor.
+
+Las colas son de un productor y un consumidor, sin locks: el productor es
+siempre quien tiene el mutex del tablero y el consumidor es el hilo suscrito,
+que nunca necesita ese mutex para leerlos.
+*/
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <semaphore.h>
+
+// Línea de caché: lo que escriben hilos distintos se separa al menos esto
+const size_t CACHE_LINE = 64;
+
+enum EventType : uint8_t {
+    EV_BRICK_HIT,        // a, b = fila, columna (o FREE_BRICK_ROW, índice); value = HP restante
+    EV_BRICK_DESTROYED,  // a, b = fila, columna (o FREE_BRICK_ROW, índice); value = puntos
+    EV_SCORE_CHANGED,    // value = score nuevo; b = diferencia
+    EV_LIFE_LOST,        // value = vidas restantes (0 = fin de la partida)
+    EV_LEVEL_CLEARED,    // value = nivel terminado
+    EV_LEVEL_STARTED,    // value = nivel; la grilla se reconstruyó completa
+    EV_POWERUP_CAUGHT,   // a = jugador; b = tipo de power-up
+    EV_PADDLE_HIT,       // a = jugador; value = punto de impacto en milésimas [-1000..1000]
+    EV_COUNT
+};
+
+// Fila de los eventos de ladrillos fuera de la grilla (b es su índice)
+const int16_t FREE_BRICK_ROW = -1;
+
+// Máscara de suscripción a partir de los tipos
+constexpr uint32_t eventBit(EventType t) { return 1u << t; }
+const uint32_t EV_ALL = (1u << EV_COUNT) - 1;
+
+struct GameEvent {
+    EventType type;
+    int16_t a, b;
+    int32_t value;
+    uint32_t frame;
+};
+
+// Función que reacciona a un evento (por ejemplo, un hook de sonido)
+typedef void (*EventHook)(const GameEvent& ev, void* user);
+
+// Máximo de eventos que se anotan en un frame (los que sobran se descartan)
+const int MAX_FRAME_EVENTS = 512;
+
+// Eventos del frame en curso. La capacidad se reserva al iniciar la partida;
+// las copias de GameConfig (snapshots de render) no arrastran los eventos
+struct FrameEvents {
+    std::vector<GameEvent> list;
+    unsigned long dropped = 0;
+
+    FrameEvents() = default;
+    FrameEvents(const FrameEvents&) {}
+    FrameEvents& operator=(const FrameEvents&) { return *this; }
+
+    void init() { list.reserve(MAX_FRAME_EVENTS); list.clear(); }
+    void clear() { list.clear(); }
+
+    void push(EventType type, int a, int b, int value, unsigned long frame) {
+        if (list.size() >= list.capacity()) { ++dropped; return; }
+        list.push_back(GameEvent{type, (int16_t)a, (int16_t)b, (int32_t)value, (uint32_t)frame});
+    }
+};
+
+// Cola circular de un productor y un consumidor. El consumidor puede dormir
+// en el semáforo hasta que se publique algo
+class EventQueue {
+private:
+    std::vector<GameEvent> buf;
+    size_t mask;
+    alignas(CACHE_LINE) std::atomic<size_t> head{0};   // Escribe el productor
+    alignas(CACHE_LINE) std::atomic<size_t> tail{0};   // Escribe el consumidor
+    std::atomic<unsigned long> dropped{0};
+    sem_t ready;
+
+public:
+    explicit EventQueue(size_t capacityPow2 = 1024);
+    ~EventQueue();
+    EventQueue(const EventQueue&) = delete;
+    EventQueue& operator=(const EventQueue&) = delete;
+
+    bool push(const GameEvent& ev);   // Productor; false si la cola está llena
+    bool pop(GameEvent& ev);          // Consumidor; false si está vacía
+    void notify();                    // Despierta al consumidor
+    void wait();                      // Duerme hasta el próximo notify
+    unsigned long droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+};
+
+// Bus de eventos de un tablero. Los suscriptores se registran antes de lanzar
+// los hilos; después sólo se publica
+class EventBus {
+public:
+    static const int MAX_SUBSCRIBERS = 8;
+
+private:
+    EventQueue* queues[MAX_SUBSCRIBERS];
+    uint32_t masks[MAX_SUBSCRIBERS];
+    bool wakes[MAX_SUBSCRIBERS];
+    int count = 0;
+    std::atomic<unsigned long> published[EV_COUNT];
+
+public:
+    EventBus();
+    // wake = false para suscriptores que ya despiertan en cada frame y sólo
+    // vacían su cola (el render)
+    bool subscribe(EventQueue* q, uint32_t mask, bool wake = true);
+
+    // Reparte los eventos del frame a cada suscriptor, despierta a los que
+    // recibieron algo y vacía el buffer (requiere el mutex del tablero)
+    void publish(FrameEvents& events);
+
+    // Despierta a todos los suscriptores (al terminar la partida)
+    void notifyAll();
+
+    unsigned long publishedCount(EventType t) const {
+        return published[t].load(std::memory_order_relaxed);
+    }
+};
+
+#endif // EVENTS_H
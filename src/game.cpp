@@ -1,161 +1,332 @@
 #include "game.h"
+#include "sim.h"
 #include <ncurses.h>
+#include <cerrno>
 #include <cstdlib>
 #include <ctime>
 #include <unistd.h>
 #include <cstring>
+#include <fcntl.h>
+#include <algorithm>
+#include <cstdio>
+#include <sys/stat.h>
 
 /*
 DEFINICIONES DE LAS VARIABLES Y FUNCIONES GLOBALES DECLARADAS EN game.h
 */
 
-pthread_mutex_t gMutex = PTHREAD_MUTEX_INITIALIZER;
-pthread_cond_t gTickCV = PTHREAD_COND_INITIALIZER;
-pthread_cond_t gCtrlCV = PTHREAD_COND_INITIALIZER;
-std::atomic<bool> gStopAll(false);
-
 // Variable global para guardar el score final
 static int g_finalScore = 0;
 
-// Permite a los hilos esperar al siguiente frame para sincronizarse
-unsigned long waitNextFrame(GameConfig* cfg, unsigned long lastFrame) {
-    pthread_mutex_lock(&gMutex);
-    while (!gStopAll.load() &&
-           (cfg->frameCounter == lastFrame || !cfg->running)) {
-        pthread_cond_wait(&gTickCV, &gMutex);
+// Entrada grabada de la última partida
+static InputRecording g_lastRecording;
+
+// Contadores de despertares por etapa, y el segmento de la sesión donde se
+// publican (nullptr si no se exportan)
+static std::atomic<unsigned long> g_stageWakeups[STAGE_COUNT];
+static std::atomic<LiveExport*> g_wakeupExport{nullptr};
+static_assert(STAGE_COUNT == LIVE_WAKEUP_STAGES, "LIVE_WAKEUP_NAMES sigue al enum Stage");
+
+// Pipe para despertar al hilo de entrada cuando está bloqueado en poll()
+static int g_wakePipe[2] = {-1, -1};
+
+// Hilos del motor, compartidos por todas las sesiones
+static EngineThreads g_engine;
+
+// Sesión elegida en el menú y tiempos de la última
+static uint64_t g_sessionRequestNs = 0;
+static SessionTimes g_sessionTimes;
+
+// Hilos propios de la sesión cuando los del motor no alcanzan
+static pthread_t g_ownThreads[ENGINE_THREADS];
+static int g_ownCount = 0;
+
+void countStageWakeup(Stage stage) {
+    g_stageWakeups[stage].fetch_add(1, std::memory_order_relaxed);
+    if (LiveExport* live = g_wakeupExport.load(std::memory_order_acquire)) live->countWakeup(stage);
+}
+
+// Espera en cv (con board->mutex tomado) y contabiliza el despertar
+void stageWait(Board* board, Stage stage, pthread_cond_t* cv) {
+    pthread_cond_wait(cv, &board->mutex);
+    countStageWakeup(stage);
+}
+
+// Permite a los hilos esperar al siguiente frame para sincronizarse. Se usa
+// la secuencia del tick y no frameCounter, que vuelve a 0 con cada nivel
+unsigned long waitNextFrame(Board* board, unsigned long lastFrame, Stage stage) {
+    GameConfig* cfg = &board->cfg;
+    pthread_mutex_lock(&board->mutex);
+    while (!board->stopAll.load() &&
+           (board->frameSeq == lastFrame || !cfg->running)) {
+        stageWait(board, stage, &board->tickCV);
     }
-    unsigned long f = cfg->frameCounter;
-    pthread_mutex_unlock(&gMutex);
+    unsigned long f = board->frameSeq;
+    pthread_mutex_unlock(&board->mutex);
     return f;
 }
 
-/*
-HELPERS LOCALES DE ESTE MÓDULO
-*/
+// Espera a que el pipeline del frame `frame` llegue a `step`. Con subpasos las
+// etapas de la bola, las paredes y los ladrillos corren varias veces en el
+// mismo frame: la etapa vuelve a llamar aquí hasta que el frame se cierre.
+// Devuelve false si el frame ya se cerró o el tablero se detuvo
+bool waitStageStep(Board* board, unsigned long frame, int step, Stage stage) {
+    GameConfig* cfg = &board->cfg;
+    auto open = [&]() {
+        return !board->stopAll.load() && cfg->running && board->frameOpen && board->frameSeq == frame;
+    };
+    while (open() && cfg->step != step) stageWait(board, stage, &board->tickCV);
+    return open();
+}
+
+// En reposo no hay nada que simular: pausa, juego detenido o bola esperando
+// el lanzamiento sin que nadie mueva la paleta. Con autopiloto nunca hay
+// reposo: él mismo lanza la bola
+bool isIdle(const GameConfig* cfg) {
+    if (!cfg->running || cfg->paused) return true;
+    if (cfg->autoplay) return false;
+    return !cfg->ballLaunched && !anyPaddleMoving(*cfg);
+}
 
-// Construye el nivel 1 del juego
-static void buildLevel1(GameConfig& cfg) {
-    cfg.grid.assign(cfg.rows, std::vector<Brick>(cfg.cols));
+// Pide al tick al menos un frame más (para dibujar el cambio que hubo)
+void wakeFromIdle(Board* board) {
+    board->cfg.idleWake = true;
+    pthread_cond_signal(&board->idleCV);
+}
 
-    for (int r = 0; r < cfg.rows; ++r) {
-        for (int c = 0; c < cfg.cols; ++c) {
-            Brick b{};
-            b.hp = 1; b.ch = '#'; b.points = 10;
-            cfg.grid[r][c] = b;
+// Detiene el tablero y despierta a todos los que esperan en él
+void stopBoard(Board* board) {
+    board->cfg.running = false;
+    board->stopAll.store(true);
+    pthread_cond_signal(&board->ctrlCV);
+    pthread_cond_broadcast(&board->tickCV);
+    pthread_cond_broadcast(&board->idleCV);
+    board->bus.notifyAll();
+}
+
+// Cierra el frame: publica sus eventos a los suscriptores y, si la partida
+// cambió de nivel o terminó, avisa al bucle de control
+void publishEvents(Board* board) {
+    bool notifyControl = false;
+    for (const GameEvent& ev : board->cfg.events.list) {
+        if (ev.type == EV_LEVEL_CLEARED || (ev.type == EV_LIFE_LOST && ev.value == 0)) {
+            notifyControl = true;
         }
     }
+    board->bus.publish(board->cfg.events);
+    if (notifyControl) pthread_cond_signal(&board->ctrlCV);
 }
 
-// Construye el nivel 2 del juego
-static void buildLevel2(GameConfig& cfg) {
-    cfg.grid.assign(cfg.rows, std::vector<Brick>(cfg.cols));
-
-    for (int r = 0; r < cfg.rows; ++r) {
-        for (int c = 0; c < cfg.cols; ++c) {
-            Brick b{};
-            if (r == 0) {
-                b.hp = 3; b.ch = '@'; b.points = 50;
-            }
-            else if (r <= 2) {
-                b.hp = 2; b.ch = '%'; b.points = 30;
-            }
-            else {
-                b.hp = 1; b.ch = '#'; b.points = 10;
-            }
-            cfg.grid[r][c] = b;
-        }
+// Cierra el frame del pipeline: publica sus eventos, deja que el tick aplique
+// la entrada pendiente y exporta el estado a la memoria compartida
+void closeFrame(Board* board) {
+    publishEvents(board);
+    board->frameOpen = false;
+    if (board->live) {
+        board->timings.frameNs = monotonicNs() - board->frameStartNs;
+        board->live->publish(board->cfg, board->frameSeq, board->timings);
     }
+    if (board->spectate) board->spectate->publish(board->cfg, board->frameSeq);
 }
 
-// Construye el nivel 3 del juego
-static void buildLevel3(GameConfig& cfg) {
-    cfg.grid.assign(cfg.rows, std::vector<Brick>(cfg.cols));
+// Encola un comando de entrada: no se aplica hasta el próximo frame, así la
+// partida depende sólo del orden de los comandos y no del momento exacto en
+// que llegó la tecla
+void queueInput(Board* board, InputType type, int player, int value) {
+    board->pendingInput.push_back(InputCommand{0, (uint8_t)type, (int8_t)player, (int16_t)value});
+    wakeFromIdle(board);
+}
 
-    for (int r = 0; r < cfg.rows; ++r) {
-        for (int c = 0; c < cfg.cols; ++c) {
-            Brick b{};
-            b.hp = 3; b.ch = '@'; b.points = 50;
-            cfg.grid[r][c] = b;
+// Aplica la entrada encolada (entre frames) y la agrega a la grabación
+void applyPendingInput(Board* board) {
+    GameConfig* cfg = &board->cfg;
+    for (InputCommand cmd : board->pendingInput) {
+        cmd.frame = board->recording.frames;
+        board->recording.commands.push_back(cmd);
+        if (cmd.type == IN_QUIT) {
+            stopBoard(board);
+            break;
         }
+        // Tras un rebobinado la grilla cambió: el render la reconstruye
+        if (applyInput(*cfg, board->rewind, cmd)) publishEvents(board);
     }
+    board->pendingInput.clear();
 }
 
-// Calcula la geometría del área de juego
-static void computePlayArea(GameConfig& cfg) {
-    int rows, cols; 
-    getmaxyx(stdscr, rows, cols);
+// Avisa al compositor de versus que hubo entrada
+void wakeBoardSet(BoardSet* set) {
+    pthread_mutex_lock(&set->mutex);
+    set->wake = true;
+    pthread_cond_broadcast(&set->cv);
+    pthread_mutex_unlock(&set->mutex);
+}
 
-    cfg.top    = rows/2 - 12;
-    cfg.bottom = rows/2 + 12;
-    cfg.left   = cols/2 - 40;
-    cfg.right  = cols/2 + 40;
-
-    cfg.x0 = cfg.left + 1;  
-    cfg.y0 = cfg.top + 1;
-    cfg.x1 = cfg.right - 1; 
-    cfg.y1 = cfg.bottom - 1;
-    cfg.w  = cfg.x1 - cfg.x0 + 1;
-    cfg.h  = cfg.y1 - cfg.y0 + 1;
-
-    cfg.paddleY = cfg.y1 - 1;
-}
-
-// Permite reiniciar el nivel
-static void resetLevel(GameConfig& cfg) {
-    cfg.score = 0;
-    cfg.lives = 3;
-    cfg.paused = false;
-    cfg.running = true;
-    cfg.restartRequested = false;
-    cfg.won = false;
-    cfg.lost = false;
-
-    // Jugador 1
-    cfg.paddleW = 9;
-    cfg.paddleY = cfg.y1 - 2;                         // fila fija cerca del borde inferior
-    cfg.paddleX = cfg.x0 + (cfg.w * 1) / 4;           // a la izquierda (puedes dejar centro si prefieres)
-    cfg.desiredDir = 0;
-
-// Jugador 2 (solo si coop)
-    if (cfg.twoPlayers) {
-        cfg.paddle2W = cfg.paddleW;
-        cfg.paddle2Y = cfg.paddleY;                   // misma fila que P1
-        cfg.paddle2X = cfg.x0 + (cfg.w * 3) / 4;      // a la derecha
-        cfg.desiredDir2 = 0;
-    } else {
-        cfg.paddle2W = 0;                             // seguridad: no se dibuja nada
-        cfg.paddle2X = cfg.paddle2Y = 0;
-        cfg.desiredDir2 = 0;
+void wakeInputThread() {
+    if (g_wakePipe[1] >= 0) {
+        char b = 1;
+        ssize_t n = write(g_wakePipe[1], &b, 1);
+        (void)n;
     }
+}
 
-    cfg.ballLaunched = false;
-    cfg.ballJustReset = true;
-    cfg.ballSpeed = 1.0f;  // Velocidad inicial normal
-    cfg.ballVX = 0.0f; 
-    cfg.ballVY = 0.0f;
-    cfg.ballX = cfg.paddleX + cfg.paddleW / 2.0f;
-    cfg.ballY = cfg.paddleY - 1.0f;
-    cfg.gridDirty = true;
-    cfg.frameDrawn = false;
-    cfg.brickBufferReady = false;
-
-    if (cfg.level == 1) {
-        buildLevel1(cfg);
-    } else if (cfg.level == 2) {
-        buildLevel2(cfg);
+unsigned long getStageWakeups(Stage stage) {
+    return g_stageWakeups[stage].load(std::memory_order_relaxed);
+}
+
+void resetStageWakeups() {
+    for (auto& w : g_stageWakeups) w.store(0, std::memory_order_relaxed);
+}
+
+void exportStageWakeups(LiveExport* live) {
+    g_wakeupExport.store(live, std::memory_order_release);
+}
+
+// El hilo de entrada necesita el extremo de lectura del pipe
+int inputWakeFd() {
+    return g_wakePipe[0];
+}
+
+void initMonotonicCond(pthread_cond_t* cv) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cv, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+// Las señales que llegan antes del plazo (teclas que despiertan al tick en
+// reposo) sólo hacen volver a esperar lo que falta
+void tickSleep(pthread_cond_t* cv, pthread_mutex_t* mutex, int us, const std::atomic<bool>& stop) {
+    timespec until;
+    clock_gettime(CLOCK_MONOTONIC, &until);
+    until.tv_sec += us / 1000000;
+    until.tv_nsec += (long)(us % 1000000) * 1000;
+    if (until.tv_nsec >= 1000000000L) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000L;
+    }
+    while (!stop.load() && pthread_cond_timedwait(cv, mutex, &until) != ETIMEDOUT) { }
+}
+
+void noteFirstFrame(Board* board) {
+    pthread_mutex_lock(&board->mutex);
+    if (board->requestNs) {
+        uint64_t ns = monotonicNs() - board->requestNs;
+        board->requestNs = 0;
+        board->timings.startNs = ns;
+        g_sessionTimes.firstFrameNs = ns;
+    }
+    pthread_mutex_unlock(&board->mutex);
+}
+
+void markSessionRequest() {
+    g_sessionRequestNs = monotonicNs();
+}
+
+SessionTimes getSessionTimes() {
+    return g_sessionTimes;
+}
+
+/*
+HELPERS LOCALES DE ESTE MÓDULO
+*/
+
+// Configuración inicial común de un tablero
+static void initBoardConfig(GameConfig& cfg, int numPlayers, unsigned int seed) {
+    initGameConfig(cfg, numPlayers, g_launchBalls);
+    cfg.tick_ms = g_tick_ms;
+    seedRandom(cfg, seed);
+}
+
+// Arranca la grabación y la partida desde ella: semilla y geometría según el
+// tamaño de la terminal o, con `like`, el mismo nivel que esa grabación
+// (semilla, geometría, bolas, nivel y velocidad iniciales)
+static void startRecordedBoard(Board& board, int numPlayers, unsigned int seed,
+                               const InputRecording* like = nullptr) {
+    InputRecording& rec = board.recording;
+    rec.clear();
+    rec.seed = seed;
+    rec.numPlayers = numPlayers;
+    rec.launchBalls = g_launchBalls;
+    getmaxyx(stdscr, rec.screenRows, rec.screenCols);
+    if (like) {
+        rec.seed = like->seed;
+        rec.launchBalls = like->launchBalls;
+        rec.screenRows = like->screenRows;
+        rec.screenCols = like->screenCols;
+        rec.level = like->level;
+        rec.ballSpeed = like->ballSpeed;
+    }
+    setupRecordedGame(board.cfg, rec);
+    board.cfg.tick_ms = g_tick_ms;
+}
+
+// Archivo de telemetría de la sesión: telemetry/<semilla>-<pid>.bkt
+static bool openTelemetry(TelemetryWriter& out, const InputRecording& rec, int tickUs) {
+    mkdir("telemetry", 0755);
+    char path[96];
+    std::snprintf(path, sizeof(path), "telemetry/%u-%d.bkt", rec.seed, (int)getpid());
+    TelemetryHeader h{};
+    h.seed = rec.seed;
+    h.tickUs = (uint32_t)tickUs;
+    h.startUnix = (int64_t)std::time(nullptr);
+    return out.open(path, h);
+}
+
+// Pipe de despertar del hilo de entrada (hay una sola terminal por proceso).
+// Queda abierto entre sesiones: un byte que sobre sólo despierta una vez de más
+static void openWakePipe() {
+    if (g_wakePipe[0] >= 0) return;
+    if (pipe(g_wakePipe) == 0) {
+        fcntl(g_wakePipe[0], F_SETFL, O_NONBLOCK);
+        fcntl(g_wakePipe[1], F_SETFL, O_NONBLOCK);
+    }
+}
+
+static void closeWakePipe() {
+    if (g_wakePipe[0] >= 0) close(g_wakePipe[0]);
+    if (g_wakePipe[1] >= 0) close(g_wakePipe[1]);
+    g_wakePipe[0] = g_wakePipe[1] = -1;
+}
+
+// Toma el momento en que el menú eligió la sesión (o ahora, si no lo marcó)
+static uint64_t takeSessionRequest() {
+    uint64_t t = g_sessionRequestNs ? g_sessionRequestNs : monotonicNs();
+    g_sessionRequestNs = 0;
+    return t;
+}
+
+// Reparte los hilos de la sesión entre los del motor; si no alcanzan (no se
+// pudieron crear) cada uno va en un hilo propio
+static void attachSession(const EngineJob* jobs, int n) {
+    g_sessionTimes.firstFrameNs = 0;
+    uint64_t t0 = monotonicNs();
+    openWakePipe();
+    g_ownCount = 0;
+    if (!g_engine.attach(jobs, n)) {
+        for (int i = 0; i < n; ++i) pthread_create(&g_ownThreads[i], nullptr, jobs[i].fn, jobs[i].arg);
+        g_ownCount = n;
+    }
+    g_sessionTimes.attachNs = monotonicNs() - t0;
+}
+
+// Espera a que vuelvan todos los hilos de la sesión (ya avisados de parar)
+static void detachSession() {
+    uint64_t t0 = monotonicNs();
+    if (g_ownCount > 0) {
+        for (int i = 0; i < g_ownCount; ++i) pthread_join(g_ownThreads[i], nullptr);
+        g_ownCount = 0;
     } else {
-        buildLevel3(cfg);
+        g_engine.detach();
     }
-    cfg.frameCounter = 0;
-    cfg.step = 0;
+    g_sessionTimes.detachNs = monotonicNs() - t0;
 }
 
 // Muestra pantalla de fin de juego
-static void showEndScreenBlocking(bool won) {
+static void showEndScreenBlocking(const char* msg1) {
     clear();
     int rows, cols; 
     getmaxyx(stdscr, rows, cols);
-    const char* msg1 = won ? "¡GANASTE!" : "PERDISTE";
     const char* msg2 = "Presiona ENTER para continuar";
     mvprintw(rows/2 - 1, (cols - (int)strlen(msg1))/2, "%s", msg1);
     mvprintw(rows/2 + 1, (cols - (int)strlen(msg2))/2, "%s", msg2);
@@ -172,100 +343,335 @@ static void showEndScreenBlocking(bool won) {
 FUNCIÓN PRINCIPAL Y PUNTO DE ENTRADA DESDE EL MENÚ
 */
 
-void runGameplay(bool twoPlayers) {
-    std::srand((unsigned)std::time(nullptr));
+void startEngine() {
+    openWakePipe();
+    g_engine.start();
+}
+
+void stopEngine() {
+    g_engine.stop();
+    closeWakePipe();
+}
+
+void runGameplay(int numPlayers, bool demo, const InputRecording* ghostRun) {
+    uint64_t requestNs = takeSessionRequest();
 
     // 1) Config inicial
-    GameConfig cfg{};
-    cfg.tick_ms = g_tick_ms;
-    cfg.twoPlayers = twoPlayers;
-    cfg.rows = 4;
-    cfg.cols = 10;
-    cfg.gapX = 1;
-    cfg.gapY = 1;
-    cfg.brickH = 1;
-    cfg.desiredDir = 0;
-    cfg.level = 1;
-
-    computePlayArea(cfg);
-    resetLevel(cfg);
+    Board board;
+    BoardSet set;
+    set.boards[0] = &board;
+    set.count = 1;
+    board.set = &set;
+
+    GameConfig& cfg = board.cfg;
+    startRecordedBoard(board, numPlayers, (unsigned)std::time(nullptr), ghostRun);
+    cfg.autoplay = demo;
+
+    // Carrera: la grabación se repite en su propio hilo, a la par de la partida
+    GhostTrack ghost;
+    if (ghostRun) {
+        ghost.start(*ghostRun);
+        board.ghost = &ghost;
+    }
     
-    if (!cfg.winPlay) {
-        int playH = cfg.h;
-        int playW = cfg.w;
-        int playY = cfg.y0;
-        int playX = cfg.x0;
-        cfg.winPlay = newwin(playH, playW, playY, playX);
-    }   
-
-    // 2) Lanzar hilos
-    pthread_t tTick, tInput, tPaddle, tBall, tCollisionsWP, tCollisionsB, tRender, tState, tSpeed;
-    gStopAll.store(false);
-
-    pthread_create(&tTick, nullptr, tickThread, &cfg);
-    pthread_create(&tInput, nullptr, inputThread, &cfg);
-    pthread_create(&tPaddle, nullptr, paddleThread, &cfg);
-    pthread_create(&tBall, nullptr, ballThread, &cfg);
-    pthread_create(&tCollisionsWP, nullptr, collisionsWallsPaddleThread, &cfg);
-    pthread_create(&tCollisionsB, nullptr, collisionsBricksThread, &cfg);
-    pthread_create(&tRender, nullptr, renderThread, &cfg);
-    pthread_create(&tState, nullptr, stateThread, &cfg);
-    pthread_create(&tSpeed, nullptr, speedThread, &cfg);
+    // Ventanas del render: marco, HUD, área jugable y mensajes
+    BoardWindows windows;
+    if (openBoardWindows(windows, cfg)) board.windows = &windows;
+
+    // Estado para monitores externos, si se activó en Configuración (si no se
+    // puede crear, se juega igual)
+    LiveExport live;
+    if (g_liveExport && live.open()) board.live = &live;
+
+    // Telemetría para análisis posterior, si se activó en Configuración (sin
+    // archivo también se juega)
+    TelemetryWriter telemetry;
+    if (g_telemetry && openTelemetry(telemetry, board.recording, cfg.tick_ms)) board.telemetry = &telemetry;
+
+    // Espectadores locales por socket Unix, si se activó en Configuración (sin
+    // socket también se juega)
+    SpectateStream spectate;
+    if (g_spectate && spectate.open()) board.spectate = &spectate;
+
+    // 2) Asignar los hilos de la sesión
+    resetStageWakeups();
+    exportStageWakeups(board.live);
+    bool sound = hasSoundHook();
+    if (sound) board.bus.subscribe(&board.soundQueue, EV_ALL);
+    if (board.telemetry) {
+        board.bus.subscribe(&board.telemetryQueue,
+                            eventBit(EV_BRICK_DESTROYED) | eventBit(EV_LIFE_LOST) |
+                            eventBit(EV_LEVEL_CLEARED) | eventBit(EV_LEVEL_STARTED) |
+                            eventBit(EV_POWERUP_CAUGHT) | eventBit(EV_PADDLE_HIT));
+    }
+
+    EngineJob jobs[ENGINE_THREADS];
+    int numJobs = 0;
+    jobs[numJobs++] = EngineJob{tickThread, &board};
+    jobs[numJobs++] = EngineJob{inputThread, &set};
+    jobs[numJobs++] = EngineJob{paddleThread, &board};
+    jobs[numJobs++] = EngineJob{ballThread, &board};
+    jobs[numJobs++] = EngineJob{collisionsWallsPaddleThread, &board};
+    jobs[numJobs++] = EngineJob{collisionsBricksThread, &board};
+    jobs[numJobs++] = EngineJob{renderThread, &board};
+    jobs[numJobs++] = EngineJob{stateThread, &board};
+    if (sound) jobs[numJobs++] = EngineJob{soundThread, &board};
+    if (board.telemetry) jobs[numJobs++] = EngineJob{telemetryThread, &board};
+    if (board.spectate) jobs[numJobs++] = EngineJob{spectateThread, &board};
+    if (board.ghost) jobs[numJobs++] = EngineJob{ghostThread, &board};
+    board.requestNs = requestNs;
+    attachSession(jobs, numJobs);
 
     // 3) Bucle de control
-    pthread_mutex_lock(&gMutex);
+    pthread_mutex_lock(&board.mutex);
+    board.timings.attachNs = g_sessionTimes.attachNs;
     while (true) {
-        // Espera a que algo relevante ocurra
-        while (!cfg.restartRequested && cfg.running) {
-            pthread_cond_wait(&gCtrlCV, &gMutex);
+        // Espera a que la partida termine (los cambios de nivel y los
+        // reinicios los aplica el tick entre frames)
+        while (!board.stopAll.load() && !set.stopAll.load() && (cfg.running || cfg.restartRequested)) {
+            pthread_cond_wait(&board.ctrlCV, &board.mutex);
         }
 
-        if (cfg.restartRequested) {
-            resetLevel(cfg);
-            cfg.restartRequested = false;
-            pthread_cond_broadcast(&gTickCV);
+        // En demo la partida vuelve a empezar desde el nivel 1 hasta que
+        // se presione una tecla
+        if (demo && !board.stopAll.load() && !set.stopAll.load() && (cfg.won || cfg.lost)) {
+            cfg.level = 1;
+            cfg.restartRequested = true;
+            wakeFromIdle(&board);
             continue;
         }
 
         // Si no es restart, es porque terminó (won/lost)
         break;
     }
-    pthread_mutex_unlock(&gMutex);
-
-    // 4) Parar hilos y limpiar
-    gStopAll.store(true);
-    pthread_mutex_lock(&gMutex);
-    pthread_cond_broadcast(&gTickCV);
-    pthread_mutex_unlock(&gMutex);
-
-    pthread_join(tTick, nullptr);
-    pthread_join(tInput, nullptr);
-    pthread_join(tPaddle, nullptr);
-    pthread_join(tBall, nullptr);
-    pthread_join(tCollisionsWP, nullptr);
-    pthread_join(tCollisionsB, nullptr);
-    pthread_join(tRender, nullptr);
-    pthread_join(tState, nullptr);
-    pthread_join(tSpeed, nullptr);
+
+    // 4) Parar hilos y devolverlos al motor
+    stopBoard(&board);
+    pthread_mutex_unlock(&board.mutex);
+    set.stopAll.store(true);
+    wakeInputThread();
+    if (board.spectate) spectate.wake();
+    if (board.ghost) ghost.wake();
+
+    detachSession();
+    exportStageWakeups(nullptr);
 
     bool won, lost;
-    pthread_mutex_lock(&gMutex);
+    pthread_mutex_lock(&board.mutex);
     won = cfg.won;
     lost = cfg.lost;
-    g_finalScore = cfg.score; // Guardar score final
-    pthread_mutex_unlock(&gMutex);
+    g_finalScore = demo ? 0 : cfg.score; // Guardar score final (la demo no puntúa)
+    board.recording.finalScore = cfg.score;
+    g_lastRecording = board.recording;
+    pthread_mutex_unlock(&board.mutex);
+
+    if (!demo && (won || lost)) {
+        char msg[96];
+        if (ghostRun) {
+            // Contra el puntaje final del fantasma, no el del mismo frame
+            std::snprintf(msg, sizeof(msg), "%s - %d puntos, el fantasma %d (%+d)", won ? "¡GANASTE!" : "PERDISTE",
+                          g_finalScore, ghostRun->finalScore, g_finalScore - ghostRun->finalScore);
+        } else {
+            std::snprintf(msg, sizeof(msg), "%s", won ? "¡GANASTE!" : "PERDISTE");
+        }
+        showEndScreenBlocking(msg);
+    }
+
+    closeBoardWindows(windows);
+}
+
+void runVersus(int numBoards) {
+    uint64_t requestNs = takeSessionRequest();
+    numBoards = std::max(2, std::min(numBoards, MAX_BOARDS));
 
-    if (won || lost) {
-        showEndScreenBlocking(won);
+    // 1) Un tablero por jugador, lado a lado
+    int rows, cols;
+    getmaxyx(stdscr, rows, cols);
+    int boardW = std::min(81, cols / numBoards);
+    int boardH = std::min(25, rows - 2);
+    int top    = std::max(0, (rows - 1 - boardH) / 2);
+    int left0  = (cols - boardW * numBoards) / 2;
+
+    Board boards[MAX_BOARDS];
+    BoardSet set;
+    set.versus = true;
+    set.count = numBoards;
+    for (int i = 0; i < numBoards; ++i) {
+        Board& b = boards[i];
+        b.index = i;
+        b.set = &set;
+        set.boards[i] = &b;
+
+        initBoardConfig(b.cfg, 1, (unsigned)std::time(nullptr) * (i + 1));
+        int left = left0 + i * boardW;
+        setupPlayAreaRect(b.cfg, top, left, top + boardH - 1, left + boardW - 1);
+        resetLevel(b.cfg);
     }
-    
-    if (cfg.winPlay) { 
-        delwin(cfg.winPlay); 
-        cfg.winPlay = nullptr; 
+
+    // 2) Un hilo de simulación por tablero, más entrada y compositor
+    resetStageWakeups();
+    EngineJob jobs[MAX_BOARDS + 2];
+    int numJobs = 0;
+    for (int i = 0; i < numBoards; ++i) {
+        boards[i].requestNs = requestNs;
+        jobs[numJobs++] = EngineJob{boardThread, &boards[i]};
+    }
+    jobs[numJobs++] = EngineJob{inputThread, &set};
+    jobs[numJobs++] = EngineJob{versusRenderThread, &set};
+    attachSession(jobs, numJobs);
+
+    // 3) Esperar a que todos los tableros terminen o alguien salga
+    pthread_mutex_lock(&set.mutex);
+    while (!set.stopAll.load() && !set.finished) {
+        pthread_cond_wait(&set.cv, &set.mutex);
+    }
+    set.stopAll.store(true);
+    pthread_cond_broadcast(&set.cv);
+    pthread_mutex_unlock(&set.mutex);
+
+    // 4) Parar hilos
+    for (int i = 0; i < numBoards; ++i) {
+        pthread_mutex_lock(&boards[i].mutex);
+        stopBoard(&boards[i]);
+        pthread_mutex_unlock(&boards[i].mutex);
+    }
+    wakeInputThread();
+
+    detachSession();
+
+    // 5) Resultado: gana el mayor puntaje
+    bool finished = set.finished;
+    int best = 0;
+    bool tie = false;
+    for (int i = 1; i < numBoards; ++i) {
+        if (boards[i].cfg.score > boards[best].cfg.score) { best = i; tie = false; }
+        else if (boards[i].cfg.score == boards[best].cfg.score) tie = true;
+    }
+    if (finished) {
+        char msg[64];
+        if (tie) snprintf(msg, sizeof(msg), "EMPATE (%d puntos)", boards[best].cfg.score);
+        else snprintf(msg, sizeof(msg), "GANA EL JUGADOR %d (%d puntos)", best + 1, boards[best].cfg.score);
+        showEndScreenBlocking(msg);
     }
 }
+// Espera del handshake: ESC o Q cancela
+static bool keepWaitingForPeer(void*) {
+    int ch = getch();
+    return ch != 27 && ch != 'q' && ch != 'Q';
+}
+
+void runNetplay(bool host, const NetShim& shim) {
+    // 1) Conexión: quien crea propone la partida con su terminal y quien se
+    // une la recibe (la geometría es la de la terminal más chica)
+    NetSession net;
+    net.host = host;
+    int rows, cols;
+    getmaxyx(stdscr, rows, cols);
+    bool opened = host ? net.link.openHost(NET_DEFAULT_PORT) : net.link.openGuest(NET_DEFAULT_PORT);
+    if (!opened) {
+        showEndScreenBlocking("No se pudo abrir el puerto UDP (¿ya hay una partida creada?)");
+        return;
+    }
+    net.link.setShim(shim, (uint32_t)std::time(nullptr) ^ (uint32_t)getpid());
+
+    char wait[96];
+    std::snprintf(wait, sizeof(wait), host ? "Esperando al compañero en el puerto %d..." :
+                  "Buscando una partida en 127.0.0.1:%d...", NET_DEFAULT_PORT);
+    const char* cancel = "ESC para cancelar";
+    clear();
+    mvprintw(rows/2 - 1, (cols - (int)strlen(wait))/2, "%s", wait);
+    mvprintw(rows/2 + 1, (cols - (int)strlen(cancel))/2, "%s", cancel);
+    refresh();
+    nodelay(stdscr, TRUE);
+
+    bool connected;
+    if (host) {
+        net.setup.seed = (uint32_t)std::time(nullptr);
+        net.setup.launchBalls = g_launchBalls;
+        net.setup.screenRows = rows;
+        net.setup.screenCols = cols;
+        net.setup.tickUs = g_tick_ms;
+        connected = netHostHandshake(net.link, net.setup, keepWaitingForPeer, nullptr);
+    } else {
+        connected = netGuestHandshake(net.link, rows, cols, net.setup, keepWaitingForPeer, nullptr);
+    }
+    if (!connected) return;
+
+    // 2) La misma partida en los dos procesos
+    Board board;
+    BoardSet set;
+    set.boards[0] = &board;
+    set.count = 1;
+    board.set = &set;
+    board.net = &net;
+
+    GameConfig& cfg = board.cfg;
+    setupNetGame(cfg, net.setup);
+    net.rollback.start(cfg, host ? 0 : 1);
+
+    BoardWindows windows;
+    if (openBoardWindows(windows, cfg)) board.windows = &windows;
+    LiveExport live;
+    if (g_liveExport && live.open()) board.live = &live;
+    SpectateStream spectate;
+    if (g_spectate && spectate.open()) board.spectate = &spectate;
+
+    // 3) El hilo de red marca los frames; el render y los espectadores los
+    // siguen como en el juego normal
+    // (el primer frame se mide desde la conexión, no desde el menú)
+    resetStageWakeups();
+    exportStageWakeups(board.live);
+    EngineJob jobs[4];
+    int numJobs = 0;
+    jobs[numJobs++] = EngineJob{inputThread, &set};
+    jobs[numJobs++] = EngineJob{renderThread, &board};
+    jobs[numJobs++] = EngineJob{netThread, &board};
+    if (board.spectate) jobs[numJobs++] = EngineJob{spectateThread, &board};
+    board.requestNs = monotonicNs();
+    g_sessionRequestNs = 0;
+    attachSession(jobs, numJobs);
+
+    // 4) Espera a que termine la sesión (la partida, una salida o la conexión)
+    pthread_mutex_lock(&board.mutex);
+    board.timings.attachNs = g_sessionTimes.attachNs;
+    while (!board.stopAll.load()) {
+        pthread_cond_wait(&board.ctrlCV, &board.mutex);
+    }
+    pthread_mutex_unlock(&board.mutex);
+    set.stopAll.store(true);
+    wakeInputThread();
+    if (board.spectate) spectate.wake();
+
+    detachSession();
+    exportStageWakeups(nullptr);
+    closeBoardWindows(windows);
+
+    // 5) Resultado y cómo se comportó la red
+    const NetStats& st = net.rollback.stats;
+    char msg[160];
+    switch (net.end) {
+        case NET_FINISHED:
+            std::snprintf(msg, sizeof(msg), "%s (%d puntos) - rollbacks %lu, máx. %d frames, resim. prom. %.0f us",
+                          cfg.won ? "¡GANARON!" : cfg.lost ? "PERDIERON" : "FIN DE LA PARTIDA", cfg.score, st.rollbacks, st.maxDepth,
+                          st.rollbacks ? st.resimNs / 1e3 / st.rollbacks : 0.0);
+            break;
+        case NET_PEER_LEFT:
+            std::snprintf(msg, sizeof(msg), "El compañero salió de la partida");
+            break;
+        case NET_TIMEOUT:
+            std::snprintf(msg, sizeof(msg), "Se perdió la conexión con el compañero");
+            break;
+        default:
+            return;   // Salió el jugador local
+    }
+    showEndScreenBlocking(msg);
+}
 
 // Función para obtener el score final del último juego
 int getGameScore() {
     return g_finalScore;
+}
+
+const InputRecording& getGameRecording() {
+    return g_lastRecording;
 }
\ No newline at end of file
@@ -6,93 +6,291 @@ reutilizar código en varios módulos y mantener el programa organizado y más f
 #ifndef GAME_H
 #define GAME_H
 
+#include "sim.h"
+#include "snapshot.h"
+#include "autopilot.h"
+#include "replay.h"
+#include "live_export.h"
+#include "telemetry.h"
+#include "spectate.h"
+#include "netplay.h"
+#include "ghost.h"
+#include "engine.h"
 #include <vector>
 #include <pthread.h>
 #include <atomic>
 #include <ncurses.h>
 #include <string>
 
-// Estructura de un ladrillo
-struct Brick {
-    int hp;      // Puntos de vida
-    char ch;     // Carácter visual
-    int points;  // Puntos que otorga
+// Etapas del juego (índices de los contadores de despertares)
+enum Stage {
+    STAGE_TICK,
+    STAGE_INPUT,
+    STAGE_PADDLE,
+    STAGE_BALL,
+    STAGE_COLLISIONS_WP,
+    STAGE_COLLISIONS_B,
+    STAGE_RENDER,
+    STAGE_STATE,
+    STAGE_EVENTS,         // Suscriptores de eventos que duermen en su cola
+    STAGE_BOARD,          // Simulación completa de un tablero (versus)
+    STAGE_SPECTATE,       // Envío a espectadores
+    STAGE_NET,            // Frames del coop en red
+    STAGE_GHOST,          // Repetición del fantasma
+    STAGE_COUNT
 };
 
-// Estado general del juego
-struct GameConfig {
-    // Área jugable
-    WINDOW* winPlay = nullptr;   // ventana del área jugable
-    int top, left, bottom, right;
-    int x0, y0, x1, y1, w, h;
-
-    // Paleta
-    int paddleW;
-    int paddleX, paddleY;
-    int desiredDir;
-
-    // Paleta 2 
-    int paddle2W;
-    int paddle2X, paddle2Y;
-    int desiredDir2;
-
-    // Bola
-    float ballX, ballY;
-    float ballVX, ballVY;
-    float ballSpeed;      // Multiplicador de velocidad
-    bool ballLaunched;
-    bool ballJustReset;
-
-    // Ladrillos
-    int rows, cols, gapX, gapY, brickH;
-    std::vector<std::vector<Brick>> grid;
-    std::vector<std::string> brickBuffer; // Buffer "pre-renderizado" de ladrillos
-    bool brickBufferReady = false;  // Indica que brickBuffer ya está construido
-
-    // Estado general
-    int score;
-    int lives;
-    bool paused;
-    bool running;
-    bool restartRequested;
-    bool won;
-    bool lost;
-    bool gridDirty;
-    bool frameDrawn;
-    int level;
-    bool twoPlayers;
-
-    // Timing
-    int tick_ms;
-    int step;
-    unsigned long frameCounter;
+// Máximo de tableros simultáneos (modo versus)
+const int MAX_BOARDS = 4;
+
+struct BoardSet;
+struct BoardWindows;
+
+// Variable de condición que mide sus plazos con CLOCK_MONOTONIC (las que
+// usa tickSleep)
+void initMonotonicCond(pthread_cond_t* cv);
+
+// Tablero: una partida con su propio estado y su propia sincronización.
+// Cada tablero tiene su mutex, así varios tableros avanzan en paralelo.
+struct Board {
+    GameConfig cfg;             // Alineado a línea de caché: los tableros de versus no comparten líneas
+    pthread_mutex_t mutex;
+    pthread_cond_t tickCV;      // Avance de frames y de etapas del pipeline
+    pthread_cond_t ctrlCV;      // Avisos al bucle de control
+    pthread_cond_t idleCV;      // El tick duerme aquí mientras el juego está en reposo
+    std::atomic<bool> stopAll;
+    int index = 0;              // Posición del tablero en su BoardSet
+    BoardSet* set = nullptr;
+    RewindBuffer rewind;        // Snapshots de los últimos frames (tecla B)
+    EventBus bus;               // Eventos de la partida, publicados al cerrar cada frame
+    EventQueue renderQueue;     // Cambios en los ladrillos, para el render
+    EventQueue soundQueue;      // Todos los eventos, para el hook de sonido
+    EventQueue telemetryQueue{4096};  // Eventos que se guardan en el archivo de telemetría
+    Autopilot pilot;            // Jugador automático (modo demo)
+    std::vector<InputCommand> pendingInput;  // Entrada a aplicar antes del próximo frame
+    InputRecording recording;   // Entrada ya aplicada, con el frame en que se aplicó
+    bool frameOpen = false;     // El pipeline todavía no cerró el último frame
+    unsigned long frameSeq = 0; // Frames iniciados por el tick (no vuelve a 0 con cada nivel)
+    LiveExport* live = nullptr; // Estado publicado en memoria compartida (si se pudo abrir)
+    TelemetryWriter* telemetry = nullptr;  // Archivo de telemetría de la sesión (si se pudo abrir)
+    BoardWindows* windows = nullptr;       // Ventanas del render (juego normal)
+    SpectateStream* spectate = nullptr;    // Transmisión a espectadores (juego normal)
+    NetSession* net = nullptr;             // Conexión con el compañero (coop en red)
+    GhostTrack* ghost = nullptr;           // Mejor partida grabada del mismo nivel (carrera)
+    LiveTimings timings;        // Tiempos del último frame (stageNs indexado por step)
+    uint64_t frameStartNs = 0;  // Inicio del frame en curso
+    uint64_t requestNs = 0;     // Cuándo se eligió la sesión en el menú (0 = ya se dibujó un frame)
+
+    Board() : stopAll(false) {
+        pthread_mutex_init(&mutex, nullptr);
+        pthread_cond_init(&tickCV, nullptr);
+        pthread_cond_init(&ctrlCV, nullptr);
+        initMonotonicCond(&idleCV);
+        bus.subscribe(&renderQueue, eventBit(EV_BRICK_HIT) | eventBit(EV_BRICK_DESTROYED) |
+                                    eventBit(EV_LEVEL_STARTED), false);
+        pendingInput.reserve(64);
+    }
+    ~Board() {
+        pthread_cond_destroy(&idleCV);
+        pthread_cond_destroy(&ctrlCV);
+        pthread_cond_destroy(&tickCV);
+        pthread_mutex_destroy(&mutex);
+    }
+    Board(const Board&) = delete;
+    Board& operator=(const Board&) = delete;
 };
 
-// Variables globales compartidas
-extern pthread_mutex_t gMutex;
-extern pthread_cond_t gTickCV;
-extern pthread_cond_t gCtrlCV;
-extern std::atomic<bool> gStopAll;
+// Tableros que comparten la terminal: uno en el juego normal, 2 o 4 en versus.
+// El hilo de entrada atiende a todos. En versus el compositor marca el ritmo:
+// publica cada frame en `tick`, los hilos de los tableros lo simulan en
+// paralelo y avisan en `done`, y recién entonces se dibuja todo junto.
+struct BoardSet {
+    Board* boards[MAX_BOARDS];
+    int count = 0;
+    bool versus = false;
+    pthread_mutex_t mutex;
+    pthread_cond_t cv;
+    unsigned long tick = 0;     // Último frame publicado por el compositor
+    int done = 0;               // Tableros que ya simularon `tick`
+    bool wake = false;          // Hubo entrada: salir del reposo
+    bool finished = false;      // Todos los tableros terminaron
+    std::atomic<bool> stopAll;
+
+    BoardSet() : stopAll(false) {
+        pthread_mutex_init(&mutex, nullptr);
+        initMonotonicCond(&cv);
+    }
+    ~BoardSet() {
+        pthread_cond_destroy(&cv);
+        pthread_mutex_destroy(&mutex);
+    }
+    BoardSet(const BoardSet&) = delete;
+    BoardSet& operator=(const BoardSet&) = delete;
+};
+
+// Configuración elegida en el menú
 extern int g_tick_ms;
+extern int g_launchBalls;
+extern int g_coopPlayers;
+extern bool g_telemetry;   // Guardar la telemetría de la sesión (apagada por defecto)
+extern bool g_liveExport;  // Publicar el estado para bin/monitor (apagado por defecto)
+extern bool g_spectate;    // Aceptar espectadores por socket (apagado por defecto)
 
-// Declaraciones de hilos
+// Declaraciones de hilos (reciben Board*, salvo los indicados)
 void* tickThread(void* arg); // Coordinador de frames
-void* inputThread(void* arg); // Teclado
+void* inputThread(void* arg); // Teclado (recibe BoardSet*)
 void* paddleThread(void* arg); // Paleta
 void* ballThread(void* arg); // Pelota
 void* collisionsWallsPaddleThread(void* arg); // Colisiones con paredes y paleta
 void* collisionsBricksThread(void* arg); // Colisiones con ladrillos
 void* renderThread(void* arg); // Dibujo
 void* stateThread(void* arg); // Estado del juego
-void* speedThread(void* arg); // Control de velocidad
+void* soundThread(void* arg); // Hook de sonido (suscriptor de eventos)
+void* telemetryThread(void* arg); // Escritura de la telemetría (suscriptor de eventos)
+void* spectateThread(void* arg); // Envío de la partida a los espectadores
+void* netThread(void* arg); // Frames del coop en red (reemplaza al tick y al pipeline)
+void* ghostThread(void* arg); // Repetición del fantasma por delante del render
+void* boardThread(void* arg); // Simulación completa de un tablero (versus)
+void* versusRenderThread(void* arg); // Compositor de tableros (recibe BoardSet*)
+
+// Funciones auxiliares
+unsigned long waitNextFrame(Board* board, unsigned long lastFrame, Stage stage);
+void stageWait(Board* board, Stage stage, pthread_cond_t* cv); // Requiere board->mutex tomado
+bool waitStageStep(Board* board, unsigned long frame, int step, Stage stage); // Requiere board->mutex tomado
+void countStageWakeup(Stage stage);
+bool isIdle(const GameConfig* cfg);              // Requiere el mutex del tablero tomado
+void wakeFromIdle(Board* board);                 // Requiere board->mutex tomado
+void stopBoard(Board* board);                    // Requiere board->mutex tomado
+void publishEvents(Board* board);                // Requiere board->mutex tomado
+void closeFrame(Board* board);                   // Requiere board->mutex tomado
+void queueInput(Board* board, InputType type, int player = 0, int value = 0); // Requiere board->mutex tomado
+void applyPendingInput(Board* board);            // Entre frames; requiere board->mutex tomado
+void wakeBoardSet(BoardSet* set);                // Sin locks de tableros tomados
+void wakeInputThread();
+int inputWakeFd();
+
+// Duerme un tick de `us` microsegundos en cv (con mutex tomado) salvo que stop
+// se active antes: parar la sesión no espera a que termine el tick
+void tickSleep(pthread_cond_t* cv, pthread_mutex_t* mutex, int us, const std::atomic<bool>& stop);
+
+// Primer frame dibujado de la sesión: anota cuánto tardó desde el menú
+void noteFirstFrame(Board* board);
+
+// Ladrillos contiguos de una fila que se dibujan con el mismo atributo
+struct BrickRun {
+    int x, len;      // Columnas dentro del área jugable (incluye los huecos entre ellos)
+    attr_t attr;
+};
+
+// Ladrillos pre-renderizados: una línea por fila de la grilla con sus tramos
+// de atributos, que se reconstruye sólo cuando llegan eventos de esa fila o
+// empieza un nivel
+struct BrickRows {
+    std::vector<std::string> rows;
+    std::vector<std::vector<BrickRun>> runs;
+    std::vector<attr_t> attrs;   // Atributos distintos de todas las filas (uno por pasada)
+    std::vector<unsigned char> dirty;
+    bool valid = false;
+};
+
+// Ventanas del juego normal, de abajo hacia arriba: marco, HUD, área jugable
+// y mensaje. Cada una pasa a la pantalla virtual (wnoutrefresh) sólo cuando
+// cambió, y un único doupdate() por frame la manda a la terminal
+struct BoardWindows {
+    WINDOW* frame = nullptr;     // Marco, título y ayuda inferior (estáticos)
+    WINDOW* hud = nullptr;       // Score, vidas, nivel y estado
+    WINDOW* play = nullptr;      // Ladrillos, power-ups, paletas y bolas
+    WINDOW* overlay = nullptr;   // Mensaje centrado (sólo mientras hay uno)
+    std::string hudText;         // HUD dibujado por última vez
+    const char* message = nullptr;
+};
+
+// Crea las ventanas para la geometría del tablero; false si no entran en la
+// terminal (entonces se dibuja directamente en stdscr)
+bool openBoardWindows(BoardWindows& w, const GameConfig& cfg);
+void closeBoardWindows(BoardWindows& w);
+
+// Destino del dibujo: ventana y posición en pantalla de su esquina superior
+// izquierda (las coordenadas de GameConfig son de pantalla)
+struct DrawTarget {
+    WINDOW* win;
+    int y, x;
+};
+
+// Colores de ladrillos (por HP y tipo), bola y paletas; se llama después de
+// initscr. Sin colores en la terminal se usan negrita y video inverso
+void initRenderColors();
+
+// Dibujo de un tablero (draw.cpp); no refresca la pantalla.
+// drainBrickEvents se llama antes de copiar el estado del tablero, y
+// updateBrickRows con la copia ya tomada (sin tablero, noteBrickEvent marca
+// las filas con los eventos del frame). drawPlayfield y drawBoard (todo el
+// tablero sobre stdscr) devuelven los cambios de atributo que hicieron. Con
+// ghost, su paleta y sus bolas van tenues debajo de las de la partida y el
+// HUD muestra la diferencia de puntaje
+void drainBrickEvents(Board* board, BrickRows& cache);
+void noteBrickEvent(const GameEvent& ev, BrickRows& cache);
+void updateBrickRows(const GameConfig& local, BrickRows& cache);
+int drawPlayfield(const DrawTarget& t, const GameConfig& local, const BrickRows& cache,
+                  const GhostFrame* ghost = nullptr);
+int drawBoard(const GameConfig& local, const BrickRows& cache, const GhostFrame* ghost = nullptr);
+void drawBoardFrame(const DrawTarget& t, const GameConfig& local);
+void formatHud(const GameConfig& local, char* out, size_t size, const GhostFrame* ghost = nullptr);
+const char* boardMessage(const GameConfig& local);   // Mensaje centrado o nullptr
+
+// Un frame completo del juego normal, hasta la terminal: en sus ventanas
+// (doupdate) o, si no entraron, sobre stdscr (refresh). Con redrawAll se
+// vuelve a dibujar todo, marco incluido. Devuelven los cambios de atributo
+int renderWindows(BoardWindows& w, const GameConfig& local, const BrickRows& bricks, bool redrawAll,
+                  const GhostFrame* ghost = nullptr);
+int renderStdscr(const GameConfig& local, const BrickRows& bricks, bool redrawAll,
+                 const GhostFrame* ghost = nullptr);
+
+// Hook de sonido: si se registra antes de empezar la partida, un hilo lo
+// llama con cada evento (fuera del mutex del tablero)
+void setSoundHook(EventHook hook, void* user);
+bool hasSoundHook();
 
-// Función auxiliar
-unsigned long waitNextFrame(GameConfig* cfg, unsigned long lastFrame);
+// Despertares por etapa (en reposo deben quedarse quietos)
+unsigned long getStageWakeups(Stage stage);
+void resetStageWakeups();
+// Suma también los despertares en el segmento de la sesión (nullptr deja de
+// hacerlo; se llama con los hilos de la sesión detenidos)
+void exportStageWakeups(LiveExport* live);
 
-// Función principal del juego
-void runGameplay(bool twoPlayers = false);
+// Hilos del motor (src/engine.h): se crean una vez en main, antes del menú, y
+// cada sesión los toma y los devuelve. Sin ellos las sesiones crean sus hilos
+void startEngine();
+void stopEngine();
+
+// Tiempos de la última sesión: del menú a su primer frame dibujado y lo que
+// costó asignarle los hilos y recuperarlos (0 = todavía no hubo)
+struct SessionTimes {
+    uint64_t firstFrameNs = 0;
+    uint64_t attachNs = 0;
+    uint64_t detachNs = 0;
+};
+
+// El menú eligió una sesión: desde aquí se mide su primer frame
+void markSessionRequest();
+SessionTimes getSessionTimes();
+
+// Función principal del juego. Con demo = true juega el autopiloto, la
+// partida vuelve a empezar al terminar y cualquier tecla vuelve al menú.
+// Con ghost se juega el nivel de esa grabación contra su repetición
+void runGameplay(int numPlayers = 1, bool demo = false, const InputRecording* ghost = nullptr);
+
+// Modo versus: 2 o 4 jugadores, cada uno con su propio tablero
+void runVersus(int numBoards);
+
+// Coop en red con otro proceso en la misma máquina: host = true crea la
+// partida y espera; si no, se une. El shim simula latencia y pérdida
+void runNetplay(bool host, const NetShim& shim);
 
 // Función para obtener el score final del juego
 int getGameScore();
 
-#endif // GAME_H
\ No newline at end of file
+// Entrada grabada de la última partida (para enviarla con el puntaje)
+const InputRecording& getGameRecording();
+
+#endif // GAME_H
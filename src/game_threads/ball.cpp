@@ -1,33 +1,32 @@
 #include "../game.h"
+#include "../sim.h"
 #include <pthread.h>
 #include <atomic>
 
 void* ballThread(void* arg) {
-    auto* cfg = (GameConfig*)arg;
+    auto* board = (Board*)arg;
+    GameConfig* cfg = &board->cfg;
     unsigned long lastFrame = 0;
 
-    while (!gStopAll.load()) {
-        lastFrame = waitNextFrame(cfg, lastFrame);
+    while (!board->stopAll.load()) {
+        lastFrame = waitNextFrame(board, lastFrame, STAGE_BALL);
 
-        pthread_mutex_lock(&gMutex);
+        pthread_mutex_lock(&board->mutex);
 
-        while (!gStopAll.load() && cfg->running && cfg->step != 1) {
-            pthread_cond_wait(&gTickCV, &gMutex);
-        }
-
-        if (cfg->running && !cfg->paused && cfg->ballLaunched) {
-            // Aplicar el multiplicador de velocidad
-            cfg->ballX += cfg->ballVX * cfg->ballSpeed;
-            cfg->ballY += cfg->ballVY * cfg->ballSpeed;
-        }
+        // Con subpasos esta etapa corre varias veces en el frame: los
+        // ladrillos devuelven el pipeline a step 1 hasta el último
+        while (waitStageStep(board, lastFrame, 1, STAGE_BALL)) {
+            uint64_t t0 = monotonicNs();
+            if (cfg->substep == 0) board->timings.stageNs[1] = 0;
+            simBalls(*cfg);
+            board->timings.stageNs[1] += monotonicNs() - t0;
 
-        if (cfg->running) {
             cfg->step = 2;
-            pthread_cond_broadcast(&gTickCV);
+            pthread_cond_broadcast(&board->tickCV);
         }
 
-        pthread_mutex_unlock(&gMutex);
+        pthread_mutex_unlock(&board->mutex);
     }
 
     return nullptr;
-}
\ No newline at end of file
+}
@@ -0,0 +1,60 @@
+#include "../game.h"
+#include "../sim.h"
+#include <pthread.h>
+#include <atomic>
+#include <unistd.h>
+#include <sched.h>
+
+// Fija el hilo a un núcleo para que cada tablero corra en el suyo
+static void pinToCore(int index) {
+#ifdef __linux__
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores <= 1) return;
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET((int)(index % cores), &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+#else
+    (void)index;
+#endif
+}
+
+// Simulación completa de un tablero en versus: espera el frame que publica el
+// compositor, ejecuta todas las etapas con el lock de su propio tablero (sin
+// competir con los demás) y avisa que terminó
+void* boardThread(void* arg) {
+    auto* board = (Board*)arg;
+    GameConfig* cfg = &board->cfg;
+    BoardSet* set = board->set;
+    unsigned long lastTick = 0;
+
+    pinToCore(board->index);
+
+    while (!board->stopAll.load()) {
+        pthread_mutex_lock(&set->mutex);
+        while (!set->stopAll.load() && set->tick == lastTick) {
+            pthread_cond_wait(&set->cv, &set->mutex);
+            countStageWakeup(STAGE_BOARD);
+        }
+        lastTick = set->tick;
+        pthread_mutex_unlock(&set->mutex);
+        if (set->stopAll.load()) break;
+
+        pthread_mutex_lock(&board->mutex);
+        applyPendingInput(board);
+        if (cfg->restartRequested) {
+            resetLevel(*cfg);   // reinicio o cambio de nivel
+        } else if (cfg->running) {
+            simFrame(*cfg);
+            board->rewind.record(*cfg);
+        }
+        publishEvents(board);
+        pthread_mutex_unlock(&board->mutex);
+
+        pthread_mutex_lock(&set->mutex);
+        set->done++;
+        pthread_cond_broadcast(&set->cv);
+        pthread_mutex_unlock(&set->mutex);
+    }
+    return nullptr;
+}
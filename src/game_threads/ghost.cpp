@@ -0,0 +1,21 @@
+#include "../game.h"
+#include <pthread.h>
+
+// Frames del fantasma por vuelta: así el hilo revisa stopAll seguido aunque
+// tenga que ponerse al día
+static const int GHOST_BATCH = 32;
+
+// Repite la grabación del fantasma por delante del render. No toma el mutex
+// del tablero: su estado es sólo suyo y el render lo lee del buffer circular
+void* ghostThread(void* arg) {
+    auto* board = (Board*)arg;
+    GhostTrack* ghost = board->ghost;
+
+    while (!board->stopAll.load()) {
+        if (!ghost->produce(GHOST_BATCH)) {
+            ghost->wait();
+            countStageWakeup(STAGE_GHOST);
+        }
+    }
+    return nullptr;
+}
@@ -1,108 +1,186 @@
 #include "../game.h"
+#include "../sim.h"
 #include <ncurses.h>
 #include <pthread.h>
 #include <atomic>
 #include <unistd.h>
 #include <chrono>
 #include <cstdlib>
+#include <poll.h>
+#include <algorithm>
+
+// Teclas izquierda/derecha de cada jugador en el mismo teclado
+static const int PLAYER_KEYS[MAX_PLAYERS][2] = {
+    {'a', 'd'},             // P1
+    {KEY_LEFT, KEY_RIGHT},  // P2
+    {'j', 'l'},             // P3
+    {'4', '6'},             // P4
+    {'z', 'c'},             // P5
+    {'f', 'h'},             // P6
+    {'u', 'o'},             // P7
+    {'7', '9'}              // P8
+};
+
+// Busca a qué jugador pertenece la tecla. En un jugador las flechas también
+// mueven a P1
+static bool findPlayerKey(int ch, int numPlayers, int& player, int& dir) {
+    if (ch >= 'A' && ch <= 'Z') ch = ch - 'A' + 'a';
+    if (numPlayers == 1 && (ch == KEY_LEFT || ch == KEY_RIGHT)) {
+        player = 0;
+        dir = (ch == KEY_LEFT) ? -1 : 1;
+        return true;
+    }
+    for (int i = 0; i < numPlayers; ++i) {
+        if (ch == PLAYER_KEYS[i][0]) { player = i; dir = -1; return true; }
+        if (ch == PLAYER_KEYS[i][1]) { player = i; dir = 1;  return true; }
+    }
+    return false;
+}
+
+// Cuánto retrocede la tecla B
+static const int REWIND_MS = 3000;
+
+// Teclas que afectan a la partida completa (pausa, lanzar, reiniciar, rebobinar,
+// salir). Se encolan y el tick las aplica antes del próximo frame.
+// Requiere board->mutex tomado
+static void queueGlobalKey(Board* board, int ch) {
+    switch (ch) {
+        case 'p': case 'P':
+            queueInput(board, IN_PAUSE);
+            break;
+
+        case ' ':
+            // Lanza la bola; ya en juego, dispara el láser si está activo
+            queueInput(board, IN_ACTION);
+            break;
+
+        case 'r': case 'R':
+            queueInput(board, IN_RESTART);
+            break;
+
+        case 'b': case 'B': {
+            // tick_ms guarda la pausa del tick en microsegundos
+            int tick = board->cfg.tick_ms > 0 ? board->cfg.tick_ms : 1;
+            queueInput(board, IN_REWIND, 0, std::min(REWIND_MS * 1000 / tick, 32767));
+            break;
+        }
+
+        case 'q': case 'Q': case 27: // ESC
+            queueInput(board, IN_QUIT);
+            break;
+    }
+}
+
+// Indica si las paletas del tablero se mueven por teclado, contando lo que
+// todavía está encolado (las del autopiloto no necesitan que se las suelte).
+// Requiere board->mutex tomado
+static bool boardMoving(Board* board) {
+    if (board->cfg.autoplay) return false;
+    for (auto it = board->pendingInput.rbegin(); it != board->pendingInput.rend(); ++it) {
+        if (it->type == IN_RELEASE) return false;
+        if (it->type == IN_MOVE) return true;
+    }
+    return anyPaddleMoving(board->cfg);
+}
+
+// Indica si alguna paleta de algún tablero se está moviendo
+static bool anyBoardMoving(BoardSet* set) {
+    bool moving = false;
+    for (int b = 0; b < set->count && !moving; ++b) {
+        Board* board = set->boards[b];
+        pthread_mutex_lock(&board->mutex);
+        moving = boardMoving(board);
+        pthread_mutex_unlock(&board->mutex);
+    }
+    return moving;
+}
 
 void* inputThread(void* arg) {
-    auto* cfg = (GameConfig*)arg;
+    auto* set = (BoardSet*)arg;
     nodelay(stdscr, TRUE);
     keypad(stdscr, TRUE);
 
     using clock = std::chrono::steady_clock;
     auto lastInput = clock::now();
 
-    while (!gStopAll.load()) {
-        int ch = getch();
-        
-
-        if (ch != ERR) {
-            pthread_mutex_lock(&gMutex);
-
-            switch (ch) {
-                case 'a':
-                case 'A':
-                    cfg->desiredDir = -1;             // mover paleta 1 a la izquierda
-                    lastInput = clock::now();
-                    break;
-
-                case 'd':
-                case 'D':
-                    cfg->desiredDir = 1;              // mover paleta 1 a la derecha
-                    lastInput = clock::now();
-                    break;
-
-                // --- Movimiento P2 con flechas ---
-                case KEY_LEFT:
-                    if (cfg->twoPlayers) {
-                        cfg->desiredDir2 = -1;        // mover paleta 2 a la izquierda
-                        lastInput = clock::now();
-                    } else {
-                        cfg->desiredDir = -1;         // en single player, flechas también mueven P1
-                        lastInput = clock::now();
-                    }
-                    break;
-
-                case KEY_RIGHT:
-                    if (cfg->twoPlayers) {
-                        cfg->desiredDir2 = 1;         // mover paleta 2 a la derecha
-                        lastInput = clock::now();
-                    } else {
-                        cfg->desiredDir = 1;          // en single player, flechas también mueven P1
-                        lastInput = clock::now();
-                    }
-                    break;
-
-                case 'p': case 'P':
-                    cfg->paused = !cfg->paused;
-                    pthread_cond_broadcast(&gTickCV);
-                    lastInput = clock::now();
-                    break;
-
-                case ' ':
-                    if (!cfg->ballLaunched && cfg->running) {
-                        cfg->ballLaunched = true;
-                        cfg->ballJustReset = false;
-                        cfg->ballVX = (std::rand() % 2 == 0 ? -0.25f : 0.25f);
-                        cfg->ballVY = -0.5f;
-                    }
-                    lastInput = clock::now();
-                    break;
-
-                case 'r': case 'R':
-                    if (cfg->running || cfg->won || cfg->lost) {
-                        cfg->restartRequested = true;
-                        cfg->running = true; // Reactivar si estaba terminado
-                        pthread_cond_signal(&gCtrlCV); // Notificar al control
-                        pthread_cond_broadcast(&gTickCV);
-                    }
-                    lastInput = clock::now();
-                    break;
-
-                case 'q': case 'Q': case 27: // ESC
-                    cfg->running = false;
-                    gStopAll.store(true);
-                    pthread_cond_signal(&gCtrlCV);
-                    pthread_cond_broadcast(&gTickCV);
-                    lastInput = clock::now();
-                    break;
+    // En versus cada jugador maneja la paleta de su propio tablero; si no, todos
+    // los jugadores comparten el único tablero
+    const int numPlayers = set->versus ? set->count : set->boards[0]->cfg.numPlayers;
+
+    pthread_mutex_lock(&set->boards[0]->mutex);
+    const bool demo = set->boards[0]->cfg.autoplay;
+    pthread_mutex_unlock(&set->boards[0]->mutex);
+
+    // Se espera en poll() sobre la terminal y el pipe de despertar en lugar de
+    // muestrear cada 50 ms; sólo hay timeout mientras alguna paleta se mueve
+    struct pollfd fds[2];
+    fds[0].fd = STDIN_FILENO;
+    fds[0].events = POLLIN;
+    fds[1].fd = inputWakeFd();
+    fds[1].events = POLLIN;
+
+    while (!set->stopAll.load()) {
+        int timeout = -1;
+        if (anyBoardMoving(set)) {
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                clock::now() - lastInput).count();
+            timeout = elapsed >= 50 ? 0 : (int)(50 - elapsed);
+        }
+
+        int ready = poll(fds, 2, timeout);
+        if (ready < 0) continue;  // EINTR
+        countStageWakeup(STAGE_INPUT);
+        if (set->stopAll.load()) break;
+
+        if (fds[1].revents & POLLIN) {
+            char buf[16];
+            while (read(fds[1].fd, buf, sizeof(buf)) > 0) { }
+        }
+
+        int ch;
+        while ((ch = getch()) != ERR) {
+            lastInput = clock::now();
+            if (demo) ch = 'q';   // Cualquier tecla sale de la demo
+
+            // Movimiento de paletas según la tabla de teclas
+            int player = -1, dir = 0;
+            if (findPlayerKey(ch, numPlayers, player, dir)) {
+                Board* board = set->boards[set->versus ? player : 0];
+                pthread_mutex_lock(&board->mutex);
+                queueInput(board, IN_MOVE, set->versus ? 0 : player, dir);
+                pthread_mutex_unlock(&board->mutex);
+            } else {
+                // Cualquier otra tecla aplica a todos los tableros y los saca
+                // del reposo para dibujar su efecto. La salida además avisa
+                // directo a los bucles de control: no depende de que el tick
+                // llegue a aplicarla
+                bool quit = ch == 'q' || ch == 'Q' || ch == 27;
+                if (quit) set->stopAll.store(true);
+                for (int b = 0; b < set->count; ++b) {
+                    Board* board = set->boards[b];
+                    pthread_mutex_lock(&board->mutex);
+                    queueGlobalKey(board, ch);
+                    wakeFromIdle(board);
+                    if (quit) pthread_cond_signal(&board->ctrlCV);
+                    pthread_mutex_unlock(&board->mutex);
+                }
             }
+            wakeBoardSet(set);
+        }
 
-            pthread_mutex_unlock(&gMutex);
-        } else {
-            // No hay tecla presionada
+        if (ready == 0) {
+            // No hay tecla presionada: soltar las paletas
             auto now = clock::now();
-            if (now - lastInput > std::chrono::milliseconds(50)) {
-                pthread_mutex_lock(&gMutex);
-                cfg->desiredDir = 0;
-                if (cfg->twoPlayers) cfg->desiredDir2 = 0;
-                pthread_mutex_unlock(&gMutex);
+            if (now - lastInput >= std::chrono::milliseconds(50)) {
+                for (int b = 0; b < set->count; ++b) {
+                    Board* board = set->boards[b];
+                    pthread_mutex_lock(&board->mutex);
+                    if (boardMoving(board)) queueInput(board, IN_RELEASE);
+                    pthread_mutex_unlock(&board->mutex);
+                }
             }
-            usleep(50000); // 3ms
         }
     }
 
     return nullptr;
-}
\ No newline at end of file
+}
@@ -0,0 +1,120 @@
+#include "../game.h"
+#include "../netplay.h"
+#include <pthread.h>
+#include <algorithm>
+#include <poll.h>
+
+// Convierte la entrada encolada por el hilo de teclado en la entrada de red
+// del jugador local: actualiza la dirección que mantiene y devuelve los
+// botones presionados. Rebobinar no existe en red (el estado es de los dos).
+// Requiere board->mutex tomado
+static uint8_t takeLocalInput(Board* board, uint8_t& dir, NetEnd& end) {
+    uint8_t buttons = 0;
+    for (const InputCommand& cmd : board->pendingInput) {
+        switch (cmd.type) {
+            case IN_MOVE:    dir = cmd.value < 0 ? NI_LEFT : cmd.value > 0 ? NI_RIGHT : 0; break;
+            case IN_RELEASE: dir = 0; break;
+            case IN_ACTION:  buttons |= NI_ACTION; break;
+            case IN_PAUSE:   buttons |= NI_PAUSE; break;
+            case IN_RESTART: buttons |= NI_RESTART; break;
+            case IN_QUIT:    end = NET_QUIT; break;
+            default: break;
+        }
+    }
+    board->pendingInput.clear();
+    return buttons;
+}
+
+// Coop en red: reemplaza al tick y a las etapas del pipeline. A cada tick
+// lee los paquetes del compañero, avanza un frame (con rollback si la
+// predicción falló), lo cierra para el render y envía la entrada local.
+// Se atrasa un poco si va adelante del compañero, así ninguno llega al
+// límite de rollback y se queda esperando
+void* netThread(void* arg) {
+    auto* board = (Board*)arg;
+    GameConfig* cfg = &board->cfg;
+    NetSession* net = board->net;
+    NetLink& link = net->link;
+    NetRollback& rb = net->rollback;
+
+    const uint64_t tickNs = (uint64_t)std::max(cfg->tick_ms, 1000) * 1000;
+    uint64_t next = monotonicNs() + tickNs;
+    uint64_t lastHeard = monotonicNs();
+    uint8_t dir = 0, buttons = 0;   // Los botones esperan al próximo frame que avance
+    uint8_t buf[NET_MAX_PACKET];
+
+    while (!board->stopAll.load() && net->end == NET_PLAYING) {
+        // Paquetes hasta el próximo tick (el shim también necesita enviar los
+        // que demoró)
+        uint64_t now = monotonicNs();
+        while (now < next) {
+            int ms = (int)((next - now + 999999) / 1000000);
+            pollfd pfd{link.socketFd(), POLLIN, 0};
+            poll(&pfd, 1, link.pollTimeoutMs(now, ms));
+            now = monotonicNs();
+            link.flush(now);
+            int n;
+            while ((n = link.recv(buf, sizeof(buf))) >= 0) {
+                if (n == 0) continue;
+                NetEnd bye = readByePacket(buf, n);
+                if (bye != NET_PLAYING) net->end = bye;
+                else if (!(net->host && netAnswerHello(link, net->setup, buf, n))) rb.readPacket(buf, n, now);
+                lastHeard = now;
+            }
+        }
+        countStageWakeup(STAGE_NET);
+        if (net->end != NET_PLAYING) break;
+        if (now - lastHeard > (uint64_t)NET_TIMEOUT_MS * 1000000) {
+            net->end = NET_TIMEOUT;
+            break;
+        }
+
+        // Ritmo: quien va adelante alarga un poco su tick; si este lado se
+        // atrasó (terminal lenta, proceso suspendido) no intenta recuperar
+        // todos los frames de golpe
+        next += tickNs;
+        if (rb.frameAdvantage(tickNs) >= 2) next += tickNs / 4;
+        if (next + tickNs < now) next = now + tickNs;
+
+        pthread_mutex_lock(&board->mutex);
+        buttons |= takeLocalInput(board, dir, net->end);
+        if (net->end == NET_PLAYING && rb.canAdvance()) {
+            uint64_t start = monotonicNs();
+            board->timings.tickNs = board->frameStartNs ? start - board->frameStartNs : 0;
+            board->frameStartNs = start;
+            int depth = rb.advance(dir | buttons, start);
+            buttons = 0;
+
+            // Tras un rollback la grilla puede haber cambiado sin eventos (los
+            // de los frames repetidos se descartan): el render la reconstruye
+            if (depth > 0) {
+                board->renderQueue.push(GameEvent{EV_LEVEL_STARTED, 0, 0, cfg->level, (uint32_t)cfg->frameCounter});
+            }
+            board->timings.rollbackDepth = depth;
+            board->timings.resimNs = rb.stats.lastResimNs;
+            board->frameSeq++;
+            board->recording.frames++;
+            closeFrame(board);
+            pthread_cond_broadcast(&board->tickCV);
+
+            if (rb.confirmed() && !cfg->running && !cfg->restartRequested) net->end = NET_FINISHED;
+        } else if (net->end == NET_PLAYING) {
+            rb.stats.stalls++;   // Demasiado adelante del compañero
+        }
+        pthread_mutex_unlock(&board->mutex);
+
+        size_t len = rb.buildPacket(buf, sizeof(buf));
+        if (len) link.send(buf, len);
+    }
+
+    // Aviso de fin (varias veces: puede perderse) y cierre del tablero
+    if (net->end != NET_PEER_LEFT && net->end != NET_TIMEOUT) {
+        size_t len = buildByePacket(buf, sizeof(buf), net->end == NET_PLAYING ? NET_QUIT : net->end);
+        for (int i = 0; i < 3; ++i) link.send(buf, len);
+        link.drain();
+    }
+    pthread_mutex_lock(&board->mutex);
+    stopBoard(board);
+    pthread_mutex_unlock(&board->mutex);
+    return nullptr;
+}
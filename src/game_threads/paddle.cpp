@@ -1,56 +1,41 @@
 #include "../game.h"
+#include "../sim.h"
 #include <pthread.h>
 #include <atomic>
 #include <unistd.h>
 
 void* paddleThread(void* arg) {
-    auto* cfg = (GameConfig*)arg;
+    auto* board = (Board*)arg;
+    GameConfig* cfg = &board->cfg;
     unsigned long lastFrame = 0;
 
-    while (!gStopAll.load()) {
-        lastFrame = waitNextFrame(cfg, lastFrame);
-        if (gStopAll.load()) break;
+    while (!board->stopAll.load()) {
+        lastFrame = waitNextFrame(board, lastFrame, STAGE_PADDLE);
+        if (board->stopAll.load()) break;
 
-        pthread_mutex_lock(&gMutex);
+        pthread_mutex_lock(&board->mutex);
 
         // Espera a step 0
-        while (!gStopAll.load() && cfg->running && cfg->step != 0) {
-            pthread_cond_wait(&gTickCV, &gMutex);
+        while (!board->stopAll.load() && cfg->running && cfg->step != 0) {
+            stageWait(board, STAGE_PADDLE, &board->tickCV);
         }
 
         if (cfg->running) {
-            // Mover paleta si no está pausado
-            if (!cfg->paused) {
-                const int PADDLE_SPEED = 2;
-                int newX = cfg->paddleX + cfg->desiredDir * PADDLE_SPEED;
-                int minX = cfg->x0 + 1;
-                int maxX = cfg->x1 - cfg->paddleW;
-                
-                if (newX < minX) newX = minX;
-                if (newX > maxX) newX = maxX;
-                cfg->paddleX = newX;
-
-                // Si la bola no ha sido lanzada, mantenerla sobre la paleta
-                if (!cfg->ballLaunched && cfg->ballJustReset) {
-                    cfg->ballX = cfg->paddleX + (cfg->paddleW / 2.0f);
-                    cfg->ballY = cfg->paddleY - 1.0f;
-                }
-                
-                if (cfg->twoPlayers) {
-                    int newX2 = cfg->paddle2X + (cfg->desiredDir2 * PADDLE_SPEED);
-                    int minX2 = cfg->x0;
-                    int maxX2 = cfg->x1 - cfg->paddle2W + 1;
-                    if (newX2 < minX2) newX2 = minX2;
-                    else if (newX2 > maxX2) newX2 = maxX2;
-                    cfg->paddle2X = newX2;
-                }
-            }
+            uint64_t t0 = monotonicNs();
+
+            // En demo el autopiloto elige la dirección antes de mover
+            if (cfg->autoplay) autopilotStep(board->pilot, *cfg);
+
+            // Mover paletas si no está pausado
+            simPaddles(*cfg);
+            simBeginSubsteps(*cfg);
+            board->timings.stageNs[0] = monotonicNs() - t0;
 
             cfg->step = 1;
-            pthread_cond_broadcast(&gTickCV);
+            pthread_cond_broadcast(&board->tickCV);
         }
 
-        pthread_mutex_unlock(&gMutex);
+        pthread_mutex_unlock(&board->mutex);
     }
 
     return nullptr;
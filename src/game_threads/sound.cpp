@@ -0,0 +1,32 @@
+#include "../game.h"
+#include <pthread.h>
+#include <atomic>
+
+// Hook registrado (se fija antes de empezar la partida)
+static EventHook g_soundHook = nullptr;
+static void* g_soundUser = nullptr;
+
+void setSoundHook(EventHook hook, void* user) {
+    g_soundHook = hook;
+    g_soundUser = user;
+}
+
+bool hasSoundHook() {
+    return g_soundHook != nullptr;
+}
+
+// Suscriptor de todos los eventos del tablero: duerme en su cola hasta que se
+// publica algo y llama al hook sin tomar el mutex del tablero
+void* soundThread(void* arg) {
+    auto* board = (Board*)arg;
+    GameEvent ev;
+
+    while (!board->stopAll.load()) {
+        board->soundQueue.wait();
+        countStageWakeup(STAGE_EVENTS);
+        while (board->soundQueue.pop(ev)) {
+            if (g_soundHook) g_soundHook(ev, g_soundUser);
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,24 @@
+#include "../game.h"
+#include <pthread.h>
+
+// Reparte la transmisión a los espectadores. No toma el mutex del tablero para
+// enviar: los frames los codifica closeFrame y aquí sólo se copian bytes del
+// buffer circular. Duerme en poll mientras no haya nada nuevo
+void* spectateThread(void* arg) {
+    auto* board = (Board*)arg;
+    SpectateStream* out = board->spectate;
+
+    while (!board->stopAll.load()) {
+        out->serve(-1);
+        countStageWakeup(STAGE_SPECTATE);
+
+        // Alguien se conectó con el juego en reposo: no hay frame que cierre
+        // y le mande el keyframe, así que se publica desde aquí
+        if (out->wantsKeyframe()) {
+            pthread_mutex_lock(&board->mutex);
+            if (!board->frameOpen) out->publish(board->cfg, board->frameSeq);
+            pthread_mutex_unlock(&board->mutex);
+        }
+    }
+    return nullptr;
+}
@@ -1,63 +1,46 @@
 #include "../game.h"
+#include "../sim.h"
 #include <pthread.h>
 #include <atomic>
 
 void* stateThread(void* arg) {
-    auto* cfg = (GameConfig*)arg;
+    auto* board = (Board*)arg;
+    GameConfig* cfg = &board->cfg;
     unsigned long lastFrame = 0;
 
-    while (!gStopAll.load()) {
-        lastFrame = waitNextFrame(cfg, lastFrame);
-        pthread_mutex_lock(&gMutex);
+    while (!board->stopAll.load()) {
+        lastFrame = waitNextFrame(board, lastFrame, STAGE_STATE);
+        pthread_mutex_lock(&board->mutex);
 
-        while (!gStopAll.load() && cfg->running && cfg->step != 4) {
-            pthread_cond_wait(&gTickCV, &gMutex);
+        while (!board->stopAll.load() && cfg->running && cfg->step != 4) {
+            stageWait(board, STAGE_STATE, &board->tickCV);
         }
 
         if (cfg->running) {
-            // Verificar victoria
-            bool anyAlive = false;
-            for (auto &row : cfg->grid) {
-                for (auto &b : row) { 
-                    if (b.hp > 0) { 
-                        anyAlive = true; 
-                        break; 
-                    } 
-                }
-                if (anyAlive) break;
-            }
-            
-            if (!anyAlive) { 
-                if (cfg->level = 1) {
-                    cfg->restartRequested = true;
-                    cfg->level = 2;
-                    pthread_cond_signal(&gCtrlCV);
-                }
-                else if(cfg->level = 2) {
-                    cfg->restartRequested = true;
-                    cfg->level = 3;
-                    pthread_cond_signal(&gCtrlCV);
-                }
-                else {
-                    cfg->won = true; 
-                    cfg->running = false;
-                    // Notificar al hilo de control
-                    pthread_cond_signal(&gCtrlCV);
-                }
-            }
-            
-            // Si se perdió (detectado en collisionsWallsPaddle)
-            if (cfg->lost) {
-                pthread_cond_signal(&gCtrlCV);
-            }
+            uint64_t t0 = monotonicNs();
+
+            // Verificar victoria / cambio de nivel
+            simState(*cfg);
+
+            // Control de velocidad cada ~6 frames (el objetivo ya se
+            // actualizó con cada cambio de score)
+            if (cfg->frameCounter % 6 == 0) simSpeed(*cfg);
+
+            // Fin del frame: guardarlo para poder rebobinar
+            board->rewind.record(*cfg);
+            board->timings.stageNs[4] = monotonicNs() - t0;
         }
 
+        // Publicar los eventos del frame (avisa al control si el nivel
+        // terminó o se perdió la partida)
+        closeFrame(board);
+
         if (cfg->running) {
             cfg->step = 0; // Completar el ciclo
-            pthread_cond_broadcast(&gTickCV);
+            pthread_cond_broadcast(&board->tickCV);
         }
 
-        pthread_mutex_unlock(&gMutex);
+        pthread_mutex_unlock(&board->mutex);
     }
     return nullptr;
 }
\ No newline at end of file
@@ -0,0 +1,37 @@
+#include "../game.h"
+#include <pthread.h>
+#include <algorithm>
+
+// Suscriptor de los eventos que se analizan después: los pasa al archivo de
+// telemetría sin tomar el mutex del tablero, así el disco nunca frena un frame.
+// El frame de los eventos vuelve a 0 con cada nivel; aquí se convierte en
+// frames desde el inicio de la sesión
+void* telemetryThread(void* arg) {
+    auto* board = (Board*)arg;
+    TelemetryWriter* out = board->telemetry;
+    uint32_t levelBase = 0;   // Frames de los niveles anteriores
+    uint32_t levelLast = 0;   // Último frame visto en el nivel en curso
+    uint32_t last = 0;        // Último frame escrito (el rebobinado no lo hace retroceder)
+    GameEvent ev;
+
+    auto drain = [&]() {
+        while (board->telemetryQueue.pop(ev)) {
+            if (ev.type == EV_LEVEL_STARTED) {
+                levelBase += levelLast;
+                levelLast = 0;
+            }
+            levelLast = std::max(levelLast, ev.frame);
+            last = std::max(last, levelBase + ev.frame);
+            out->add(ev.type, last, ev.a, ev.b, ev.value);
+        }
+    };
+
+    while (!board->stopAll.load()) {
+        board->telemetryQueue.wait();
+        countStageWakeup(STAGE_EVENTS);
+        drain();
+    }
+    drain();
+    out->flush();
+    return nullptr;
+}
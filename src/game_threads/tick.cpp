@@ -1,24 +1,56 @@
 #include "../game.h"
 #include <pthread.h>
 #include <atomic>
-#include <unistd.h>
 #include <cstddef>
 
 void* tickThread(void* arg) {
-    auto* cfg = (GameConfig*)arg;
+    auto* board = (Board*)arg;
+    GameConfig* cfg = &board->cfg;
 
-    while (!gStopAll.load()) {
-        usleep(cfg->tick_ms);
+    bool first = true;
+    while (!board->stopAll.load()) {
+        // En reposo (pausa o bola sin lanzar) el tick se detiene por completo:
+        // sin frames nuevos todas las etapas quedan dormidas en waitNextFrame
+        pthread_mutex_lock(&board->mutex);
+        while (!board->stopAll.load() && isIdle(cfg) && !cfg->idleWake) {
+            stageWait(board, STAGE_TICK, &board->idleCV);
+        }
+        cfg->idleWake = false;
+
+        // El primer frame de la sesión sale sin esperar un tick; stopBoard
+        // corta la espera
+        if (!first) tickSleep(&board->idleCV, &board->mutex, cfg->tick_ms, board->stopAll);
+        first = false;
+        if (board->stopAll.load()) {
+            pthread_mutex_unlock(&board->mutex);
+            break;
+        }
+        countStageWakeup(STAGE_TICK);
 
-        pthread_mutex_lock(&gMutex);
+        // La entrada y los cambios de nivel se aplican entre frames: primero
+        // el pipeline tiene que cerrar el anterior
+        while (!board->stopAll.load() && board->frameOpen && cfg->running) {
+            stageWait(board, STAGE_TICK, &board->tickCV);
+        }
+        applyPendingInput(board);
+        if (cfg->restartRequested) {
+            resetLevel(*cfg);
+            publishEvents(board);   // nivel nuevo: el render reconstruye la grilla
+        }
 
-        if (cfg->running) {
+        if (cfg->running && !board->stopAll.load()) {
             cfg->frameCounter++;
             cfg->step = 0;  // Arranca pipeline del frame
+            uint64_t now = monotonicNs();
+            board->timings.tickNs = board->frameStartNs ? now - board->frameStartNs : 0;
+            board->frameStartNs = now;
+            board->frameOpen = true;
+            board->frameSeq++;
+            board->recording.frames++;
         }
 
-        pthread_cond_broadcast(&gTickCV);
-        pthread_mutex_unlock(&gMutex);
+        pthread_cond_broadcast(&board->tickCV);
+        pthread_mutex_unlock(&board->mutex);
     }
     return nullptr;
 }
@@ -0,0 +1,103 @@
+#include "../game.h"
+#include <pthread.h>
+#include <atomic>
+#include <ncurses.h>
+#include <unistd.h>
+
+// Indica si todos los tableros están en reposo; consume los pedidos de frame
+// pendientes (idleWake) para dibujar una vez su efecto
+static bool allBoardsIdle(BoardSet* set) {
+    bool idle = true;
+    for (int b = 0; b < set->count; ++b) {
+        Board* board = set->boards[b];
+        pthread_mutex_lock(&board->mutex);
+        if (!isIdle(&board->cfg) || board->cfg.idleWake || board->cfg.restartRequested) {
+            idle = false;
+        }
+        board->cfg.idleWake = false;
+        pthread_mutex_unlock(&board->mutex);
+    }
+    return idle;
+}
+
+// Compositor del modo versus. Marca el ritmo de los frames: publica un tick,
+// espera a que todos los tableros lo simulen (cada uno en su núcleo) y dibuja
+// los tableros lado a lado con un único refresh
+void* versusRenderThread(void* arg) {
+    auto* set = (BoardSet*)arg;
+    GameConfig locals[MAX_BOARDS];
+    BrickRows bricks[MAX_BOARDS];
+    bool needFrame = true;
+    bool first = true;   // El primer frame sale sin esperar un tick
+
+    while (!set->stopAll.load()) {
+        // En reposo no se publican frames hasta que llegue una tecla
+        if (allBoardsIdle(set)) {
+            pthread_mutex_lock(&set->mutex);
+            while (!set->stopAll.load() && !set->wake) {
+                pthread_cond_wait(&set->cv, &set->mutex);
+                countStageWakeup(STAGE_RENDER);
+            }
+            set->wake = false;
+            pthread_mutex_unlock(&set->mutex);
+            continue;
+        }
+
+        // Publicar el frame y esperar a que todos los tableros lo terminen
+        pthread_mutex_lock(&set->mutex);
+        if (!first) tickSleep(&set->cv, &set->mutex, g_tick_ms, set->stopAll);
+        countStageWakeup(STAGE_RENDER);
+        set->tick++;
+        set->done = 0;
+        pthread_cond_broadcast(&set->cv);
+        while (!set->stopAll.load() && set->done < set->count) {
+            pthread_cond_wait(&set->cv, &set->mutex);
+            countStageWakeup(STAGE_RENDER);
+        }
+        pthread_mutex_unlock(&set->mutex);
+        if (set->stopAll.load()) break;
+
+        // Snapshot de todos los tableros
+        bool allEnded = true;
+        for (int b = 0; b < set->count; ++b) {
+            Board* board = set->boards[b];
+            drainBrickEvents(board, bricks[b]);
+            pthread_mutex_lock(&board->mutex);
+            locals[b] = board->cfg;
+            board->cfg.frameDrawn = true;
+            pthread_mutex_unlock(&board->mutex);
+            updateBrickRows(locals[b], bricks[b]);
+
+            if (!locals[b].frameDrawn) needFrame = true;
+            if (locals[b].running || locals[b].restartRequested) allEnded = false;
+        }
+
+        // Componer: marcos sólo si algún tablero se reinició
+        if (needFrame) {
+            erase();
+            for (int b = 0; b < set->count; ++b) {
+                drawBoardFrame(DrawTarget{stdscr, 0, 0}, locals[b]);
+                mvprintw(locals[b].top, locals[b].left + 2, "P%d", b + 1);
+            }
+            mvprintw(LINES - 1, 1,
+                "P1 A/D  P2 Flechas  P3 J/L  P4 4/6 | SPACE: Lanzar | P: Pausa | R: Reiniciar | Q/ESC: Salir");
+            needFrame = false;
+        }
+        for (int b = 0; b < set->count; ++b) {
+            drawBoard(locals[b], bricks[b]);
+        }
+        refresh();
+        if (first) {
+            for (int b = 0; b < set->count; ++b) noteFirstFrame(set->boards[b]);
+            first = false;
+        }
+
+        if (allEnded) {
+            pthread_mutex_lock(&set->mutex);
+            set->finished = true;
+            pthread_cond_broadcast(&set->cv);
+            pthread_mutex_unlock(&set->mutex);
+        }
+    }
+    return nullptr;
+}
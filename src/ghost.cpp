@@ -0,0 +1,89 @@
+#include "ghost.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+
+GhostTrack::GhostTrack() : ring(GHOST_RING) {
+    sem_init(&ready, 0, 0);
+}
+
+GhostTrack::~GhostTrack() {
+    sem_destroy(&ready);
+}
+
+void GhostTrack::capture(GhostFrame& out) const {
+    const Paddle& pad = cfg.paddles[0];
+    out.frame = cursor.frame;
+    out.score = cfg.score;
+    out.lives = cfg.lives;
+    out.padX = (int16_t)pad.x;
+    out.padY = (int16_t)pad.y;
+    out.padW = (int16_t)pad.w;
+    out.ended = cursor.ended;
+    out.balls = (uint8_t)std::min(cfg.balls.count, GHOST_MAX_BALLS);
+    for (int i = 0; i < out.balls; ++i) {
+        out.ballX[i] = (int16_t)std::lround(cfg.balls.x[i]);
+        out.ballY[i] = (int16_t)std::lround(cfg.balls.y[i]);
+    }
+}
+
+void GhostTrack::start(const InputRecording& recording) {
+    rec = recording;
+    startReplay(cursor, rec, cfg, rewind);
+    capture(ring[0]);
+    produced.store(1);
+    reading.store(0);
+    finished.store(false);
+}
+
+bool GhostTrack::produce(int maxFrames) {
+    int made = 0;
+    uint32_t p = produced.load(std::memory_order_relaxed);
+    while (made < maxFrames && !finished.load(std::memory_order_relaxed) &&
+           p < reading.load(std::memory_order_acquire) + GHOST_AHEAD) {
+        // El render nunca lee más atrás de `reading`, y p queda a menos de
+        // GHOST_RING frames de él: no se pisa lo que puede estar leyendo
+        bool more = stepReplay(cursor, cfg, rewind);
+        if (!more) {
+            finished.store(true, std::memory_order_release);
+            break;
+        }
+        capture(ring[p % GHOST_RING]);
+        produced.store(++p, std::memory_order_release);
+        ++made;
+    }
+    return made > 0;
+}
+
+// Se marca dormido antes de volver a mirar si hay trabajo: si el render
+// avanzó entretanto, o lo ve aquí o ve el flag y despierta al hilo
+void GhostTrack::wait() {
+    sleeping.store(true);
+    if (finished.load() || produced.load() >= reading.load() + GHOST_AHEAD) {
+        while (sem_wait(&ready) != 0 && errno == EINTR) { }
+    }
+    sleeping.store(false);
+}
+
+void GhostTrack::wake() {
+    sem_post(&ready);
+}
+
+bool GhostTrack::frameAt(uint32_t frame, GhostFrame& out) {
+    if (frame > reading.load(std::memory_order_relaxed)) reading.store(frame, std::memory_order_release);
+    uint32_t p = produced.load(std::memory_order_acquire);
+    bool done = finished.load(std::memory_order_acquire);
+
+    // Despierta al hilo recién cuando se consumió la mitad de lo adelantado
+    if (!done && p < reading.load() + GHOST_AHEAD / 2 && sleeping.exchange(false)) sem_post(&ready);
+
+    // Terminada la grabación, queda su último frame
+    if (done && frame + 1 >= p) {
+        out = ring[(p - 1) % GHOST_RING];
+        out.ended = true;
+        return true;
+    }
+    if (frame >= p || frame + GHOST_RING <= p) return false;
+    out = ring[frame % GHOST_RING];
+    return true;
+}
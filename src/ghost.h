@@ -0,0 +1,82 @@
+/*
+ghost.h - Fantasma: la mejor partida grabada del mismo nivel, repetida a la
+par de la partida en vivo.
+
+La grabación (src/replay.h) se repite frame a frame en un hilo propio, por
+delante de la partida en vivo: GhostTrack guarda en un buffer circular lo que
+hace falta dibujar de cada frame (paleta, bolas, puntaje y vidas) hasta
+GHOST_AHEAD frames más allá del que está mostrando el render. El render sólo
+copia la entrada del frame que dibuja, sin esperar ni tomar locks, y el hilo
+del fantasma duerme hasta que el render consume la mitad de lo adelantado.
+Como el fantasma no depende de la entrada en vivo, nunca hay que rehacer lo
+simulado.
+
+Los dos avanzan por frames simulados (no por tiempo): mientras la partida en
+vivo está en pausa o con la bola sin lanzar, el fantasma también espera.
+
+No depende de ncurses.
+*/
+#ifndef GHOST_H
+#define GHOST_H
+
+#include "replay.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <semaphore.h>
+
+const int GHOST_MAX_BALLS = 8;          // Bolas del fantasma que se dibujan
+const uint32_t GHOST_RING = 256;        // Frames guardados (potencia de 2)
+const uint32_t GHOST_AHEAD = 128;       // Frames simulados por delante del render
+
+// Lo que se dibuja del fantasma tras `frame` frames simulados
+struct GhostFrame {
+    uint32_t frame;
+    int32_t score;
+    int32_t lives;
+    int16_t padX, padY, padW;
+    uint8_t balls;
+    bool ended;                          // La partida grabada ya terminó
+    int16_t ballX[GHOST_MAX_BALLS], ballY[GHOST_MAX_BALLS];
+};
+
+class GhostTrack {
+private:
+    InputRecording rec;
+    GameConfig cfg{};
+    RewindBuffer rewind;
+    ReplayCursor cursor;
+
+    std::vector<GhostFrame> ring;
+    std::atomic<uint32_t> produced{0};   // Frames escritos en el buffer
+    std::atomic<uint32_t> reading{0};    // Frame que está dibujando el render
+    std::atomic<bool> finished{false};   // La grabación terminó: no se escribe más
+    std::atomic<bool> sleeping{false};   // El hilo del fantasma duerme en `ready`
+    sem_t ready;
+
+    void capture(GhostFrame& out) const;
+
+public:
+    GhostTrack();
+    ~GhostTrack();
+    GhostTrack(const GhostTrack&) = delete;
+    GhostTrack& operator=(const GhostTrack&) = delete;
+
+    // Copia la grabación y deja el fantasma en el frame 0
+    void start(const InputRecording& recording);
+    const InputRecording& recording() const { return rec; }
+
+    // Lado del hilo del fantasma: simula hasta llegar a GHOST_AHEAD frames
+    // por delante del render (como mucho maxFrames); false si no había nada
+    // que hacer. wait() duerme hasta que haga falta seguir o hasta wake()
+    bool produce(int maxFrames);
+    void wait();
+    void wake();
+
+    // Lado del render: estado del fantasma tras `frame` frames (el último si
+    // la grabación ya terminó). false si todavía no se simuló: ese frame se
+    // dibuja sin fantasma
+    bool frameAt(uint32_t frame, GhostFrame& out);
+};
+
+#endif // GHOST_H
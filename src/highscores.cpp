@@ -1,9 +1,12 @@
 #include "highscores.h"
+#include "replay.h"
+#include <cstdio>
 #include <fstream>
 #include <algorithm>
 #include <ctime>
 #include <iomanip>
 #include <sstream>
+#include <sys/stat.h>
 
 HighscoreManager::HighscoreManager(const std::string& file) : filename(file) {
     loadScores();
@@ -44,11 +47,15 @@ bool HighscoreManager::loadScores() {
         return true;
     }
     
-    int score;
-    std::string date, name;
-    
-    while (file >> score >> date >> name) {
-        scores.push_back(HighscoreEntry(score, date, name));
+    // Una entrada por línea: score fecha nombre [grabación]
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream in(line);
+        int score;
+        std::string date, name, replay;
+        if (!(in >> score >> date >> name)) continue;
+        in >> replay;
+        scores.push_back(HighscoreEntry(score, date, name, replay));
     }
     
     file.close();
@@ -64,7 +71,9 @@ bool HighscoreManager::saveScores() {
     }
     
     for (const auto& entry : scores) {
-        file << entry.score << " " << entry.date << " " << entry.name << "\n";
+        file << entry.score << " " << entry.date << " " << entry.name;
+        if (!entry.replay.empty()) file << " " << entry.replay;
+        file << "\n";
     }
     
     file.close();
@@ -79,24 +88,48 @@ bool HighscoreManager::isHighscore(int score) {
     return score > scores.back().score;
 }
 
-bool HighscoreManager::addScore(int score, const std::string& name) {
+// Las grabaciones se guardan en replays/, en el mismo directorio que el archivo
+std::string HighscoreManager::replayPath(const HighscoreEntry& entry) const {
+    size_t slash = filename.find_last_of('/');
+    std::string dir = (slash == std::string::npos) ? "" : filename.substr(0, slash + 1);
+    return dir + entry.replay;
+}
+
+bool HighscoreManager::addScore(int score, const std::string& name, const InputRecording* recording) {
     if (!isHighscore(score)) {
         return false;
     }
     
     std::string date = getCurrentDate();
-    scores.push_back(HighscoreEntry(score, date, name));
+    HighscoreEntry entry(score, date, name);
+    if (recording) {
+        std::ostringstream oss;
+        oss << "replays/" << date << "-" << name << "-" << score << "-" << recording->seed << ".bkr";
+        entry.replay = oss.str();
+        std::string path = replayPath(entry);
+        mkdir(path.substr(0, path.find_last_of('/')).c_str(), 0755);
+        if (!saveRecording(*recording, path.c_str())) entry.replay.clear();
+    }
+    scores.push_back(entry);
     
     sortScores();
     
-    // Mantener solo los mejores MAX_SCORES
-    if (scores.size() > MAX_SCORES) {
-        scores.resize(MAX_SCORES);
+    // Mantener solo los mejores MAX_SCORES (las grabaciones que salen de la
+    // tabla se borran)
+    while (scores.size() > MAX_SCORES) {
+        if (!scores.back().replay.empty()) std::remove(replayPath(scores.back()).c_str());
+        scores.pop_back();
     }
     
     return saveScores();
 }
 
+bool HighscoreManager::setScores(const std::vector<HighscoreEntry>& entries) {
+    scores = entries;
+    sortScores();
+    return saveScores();
+}
+
 void HighscoreManager::clear() {
     scores.clear();
     saveScores();
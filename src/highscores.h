@@ -4,13 +4,17 @@
 #include <string>
 #include <vector>
 
+struct InputRecording;
+
 struct HighscoreEntry {
     int score;
     std::string date;
     std::string name;
+    std::string replay;   // Grabación de la partida (relativa al archivo); vacía si no hay
     
-    HighscoreEntry(int s = 0, const std::string& d = "", const std::string& n = "")
-        : score(s), date(d), name(n) {}
+    HighscoreEntry(int s = 0, const std::string& d = "", const std::string& n = "",
+                   const std::string& r = "")
+        : score(s), date(d), name(n), replay(r) {}
 };
 
 class HighscoreManager {
@@ -27,9 +31,13 @@ public:
     
     bool loadScores();
     bool saveScores();
-    bool addScore(int score, const std::string& name);
+    // Con grabación, se guarda en replays/ junto al archivo para poder
+    // validar el puntaje después (tools/validate.cpp)
+    bool addScore(int score, const std::string& name, const InputRecording* recording = nullptr);
     bool isHighscore(int score);
     const std::vector<HighscoreEntry>& getScores() const { return scores; }
+    bool setScores(const std::vector<HighscoreEntry>& entries);
+    std::string replayPath(const HighscoreEntry& entry) const;
     void clear();
 };
 
@@ -0,0 +1,118 @@
+#include "live_export.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+const char* const LIVE_STAGE_NAMES[LIVE_STAGES] = {
+    "paleta", "bola", "paredes", "ladrillos", "estado"
+};
+
+const char* const LIVE_WAKEUP_NAMES[LIVE_WAKEUP_STAGES] = {
+    "tick", "entrada", "paleta", "bola", "paredes", "ladrillos", "render",
+    "estado", "eventos", "tablero", "espect", "red", "fantasma"
+};
+
+uint64_t monotonicNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+bool LiveExport::open() {
+    close();
+    std::snprintf(name, sizeof(name), "/%s%d", LIVE_PREFIX, (int)getpid());
+    int fd = shm_open(name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0) {
+        name[0] = 0;
+        return false;
+    }
+    void* p = MAP_FAILED;
+    if (ftruncate(fd, sizeof(LiveState)) == 0) {
+        p = mmap(nullptr, sizeof(LiveState), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        shm_unlink(name);
+        name[0] = 0;
+        return false;
+    }
+
+    // El segmento nuevo está en cero; la cabecera se escribe una sola vez
+    state = new (p) LiveState();
+    state->magic = LIVE_MAGIC;
+    state->version = LIVE_VERSION;
+    state->pid = (int32_t)getpid();
+    state->seq.store(0, std::memory_order_release);
+    return true;
+}
+
+void LiveExport::close() {
+    if (state) {
+        munmap(state, sizeof(LiveState));
+        state = nullptr;
+    }
+    if (name[0]) {
+        shm_unlink(name);
+        name[0] = 0;
+    }
+}
+
+void LiveExport::publish(const GameConfig& cfg, uint64_t frame, const LiveTimings& t) {
+    if (!state) return;
+
+    uint32_t s = state->seq.load(std::memory_order_relaxed);
+    state->seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    LiveData& d = state->data;
+    d.frame = frame;
+    d.updatedNs = monotonicNs();
+    d.score = cfg.score;
+    d.lives = cfg.lives;
+    d.level = cfg.level;
+    d.running = cfg.running;
+    d.paused = cfg.paused;
+    d.won = cfg.won;
+    d.lost = cfg.lost;
+    d.numPlayers = cfg.numPlayers;
+    d.ballCount = cfg.balls.count;
+    int n = std::min(cfg.balls.count, LIVE_MAX_BALLS);
+    for (int i = 0; i < n; ++i) {
+        d.ballX[i] = cfg.balls.x[i];
+        d.ballY[i] = cfg.balls.y[i];
+    }
+    for (int p = 0; p < cfg.numPlayers; ++p) {
+        d.paddleX[p] = (int16_t)cfg.paddles[p].x;
+        d.paddleY[p] = (int16_t)cfg.paddles[p].y;
+        d.paddleW[p] = (int16_t)cfg.paddles[p].w;
+    }
+    d.tickNs = (uint32_t)std::min<uint64_t>(t.tickNs, UINT32_MAX);
+    d.frameNs = (uint32_t)std::min<uint64_t>(t.frameNs, UINT32_MAX);
+    for (int k = 0; k < LIVE_STAGES; ++k) {
+        d.stageNs[k] = (uint32_t)std::min<uint64_t>(t.stageNs[k], UINT32_MAX);
+    }
+    d.attrSwitches = t.attrSwitches;
+    d.substeps = cfg.substeps;
+    d.rollbackDepth = t.rollbackDepth;
+    d.resimNs = (uint32_t)std::min<uint64_t>(t.resimNs, UINT32_MAX);
+    d.startNs = (uint32_t)std::min<uint64_t>(t.startNs, UINT32_MAX);
+    d.attachNs = (uint32_t)std::min<uint64_t>(t.attachNs, UINT32_MAX);
+
+    state->seq.store(s + 2, std::memory_order_release);
+}
+
+bool readLiveState(const LiveState* st, LiveData& out, int tries) {
+    for (int i = 0; i < tries; ++i) {
+        uint32_t s1 = st->seq.load(std::memory_order_acquire);
+        if (s1 & 1) continue;
+        std::memcpy(&out, (const void*)&st->data, sizeof(LiveData));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (st->seq.load(std::memory_order_relaxed) == s1) return true;
+    }
+    return false;
+}
@@ -0,0 +1,115 @@
+/*
+live_export.h - Estado de la partida publicado en memoria compartida POSIX
+("/breakout-<pid>") para herramientas externas (tools/monitor.cpp).
+
+La publicación usa un seqlock: el juego incrementa `seq` (queda impar),
+escribe los datos y vuelve a incrementarlo (queda par). Un lector copia los
+datos y los descarta si `seq` era impar o cambió mientras copiaba. El juego
+nunca espera a los lectores ni hace llamadas al sistema al publicar: sólo
+escribe en la memoria ya mapeada.
+
+No depende de ncurses.
+*/
+#ifndef LIVE_EXPORT_H
+#define LIVE_EXPORT_H
+
+#include "sim.h"
+#include <atomic>
+#include <cstdint>
+
+const uint32_t LIVE_MAGIC = 0x564C4B42;   // "BKLV"
+const uint32_t LIVE_VERSION = 6;
+const char* const LIVE_PREFIX = "breakout-";
+const int LIVE_MAX_BALLS = 16;   // Bolas que se exportan (las primeras)
+const int LIVE_STAGES = 5;       // Paleta, bola, paredes/paleta, ladrillos, estado
+
+const int LIVE_WAKEUP_STAGES = 13;   // Hilos que cuentan despertares (enum Stage de game.h)
+
+// Etapas del pipeline en el orden de LiveState::stageNs
+extern const char* const LIVE_STAGE_NAMES[LIVE_STAGES];
+
+// Hilos en el orden de LiveState::wakeups
+extern const char* const LIVE_WAKEUP_NAMES[LIVE_WAKEUP_STAGES];
+
+// Datos de un frame (se copian completos bajo el seqlock)
+struct LiveData {
+    uint64_t frame;           // Frames simulados desde el inicio de la sesión
+    uint64_t updatedNs;       // Reloj monotónico al publicar
+    int32_t score, lives, level;
+    uint8_t running, paused, won, lost;
+    int32_t numPlayers;
+    int32_t ballCount;        // Bolas en juego (se exportan hasta LIVE_MAX_BALLS)
+    float ballX[LIVE_MAX_BALLS], ballY[LIVE_MAX_BALLS];
+    int16_t paddleX[MAX_PLAYERS], paddleY[MAX_PLAYERS], paddleW[MAX_PLAYERS];
+    uint32_t tickNs;          // Intervalo entre el inicio de este frame y el anterior
+    uint32_t frameNs;         // Del inicio del frame a su cierre (pipeline completo)
+    uint32_t stageNs[LIVE_STAGES];
+    uint32_t attrSwitches;    // Cambios de atributo del último frame dibujado
+    int32_t substeps;         // Subpasos de física del último frame
+    int32_t rollbackDepth;    // Coop en red: frames vueltos a simular en el último frame
+    uint32_t resimNs;         // Coop en red: lo que tardó ese rollback
+    uint32_t startNs;         // Del menú al primer frame dibujado de la sesión (0 = todavía no)
+    uint32_t attachNs;        // Lo que costó asignarle los hilos del motor a la sesión
+};
+
+// Contenido del segmento
+struct LiveState {
+    uint32_t magic;
+    uint32_t version;
+    int32_t pid;
+    std::atomic<uint32_t> seq;   // Impar mientras se escribe
+    LiveData data;
+    // Despertares por hilo desde el inicio de la sesión. Van fuera del
+    // seqlock y se suman al despertar, no al cerrar el frame: así se ven
+    // también en reposo, cuando no hay frames (y deberían quedarse quietos)
+    std::atomic<uint64_t> wakeups[LIVE_WAKEUP_STAGES];
+};
+
+// Tiempos de un frame medidos por el pipeline
+struct LiveTimings {
+    uint64_t tickNs = 0;
+    uint64_t frameNs = 0;
+    uint64_t stageNs[LIVE_STAGES] = {};
+    uint32_t attrSwitches = 0;   // Lo anota el render
+    int32_t rollbackDepth = 0;   // Sólo en coop en red
+    uint64_t resimNs = 0;
+    uint64_t startNs = 0;        // Los anota la sesión al arrancar
+    uint64_t attachNs = 0;
+};
+
+// Reloj monotónico en ns (clock_gettime no entra al kernel en Linux)
+uint64_t monotonicNs();
+
+// Segmento del lado del juego
+class LiveExport {
+private:
+    LiveState* state = nullptr;
+    char name[64] = {0};
+
+public:
+    LiveExport() = default;
+    ~LiveExport() { close(); }
+    LiveExport(const LiveExport&) = delete;
+    LiveExport& operator=(const LiveExport&) = delete;
+
+    // Crea y mapea el segmento (fuera del frame); false si no se pudo
+    bool open();
+    void close();
+    bool isOpen() const { return state != nullptr; }
+
+    // Publica el estado al cerrar un frame (con el mutex del tablero tomado)
+    void publish(const GameConfig& cfg, uint64_t frame, const LiveTimings& t);
+
+    // Suma un despertar del hilo (desde cualquier hilo, sin locks)
+    void countWakeup(int stage) {
+        if (state && stage >= 0 && stage < LIVE_WAKEUP_STAGES) {
+            state->wakeups[stage].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+// Lectura del lado del monitor: copia consistente de los datos; false si no
+// se obtuvo en `tries` intentos (el juego está escribiendo muy seguido)
+bool readLiveState(const LiveState* st, LiveData& out, int tries = 100);
+
+#endif // LIVE_EXPORT_H
@@ -1,18 +1,23 @@
 #include "game.h"
 #include "highscores.h"
+#include "replay.h"
 #include <ncurses.h>
 #include <string>
 #include <vector>
 #include <ctime>
+#include <cstdio>
 #include <cstdlib>
 #include <cctype>
 
 // Estados
-enum class Screen { MAIN_MENU, INSTRUCTIONS, HIGHSCORES, GAMEPLAY, EXIT };
+enum class Screen { MAIN_MENU, INSTRUCTIONS, HIGHSCORES, GAMEPLAY, GHOST_RACE, EXIT };
 
 // Manager global de highscores
 HighscoreManager g_highscores;
 
+// Grabación del fantasma de la próxima carrera
+static InputRecording g_ghostRun;
+
 // Utilidades de dibujo
 void drawFrame(int top, int left, int bottom, int right, const std::string& title = "") { 
     // Marco rectangular
@@ -91,9 +96,12 @@ std::string inputPlayerName(int finalScore) {
 Screen showMainMenu();
 void showInstructions();
 void showHighscores();
-void runGameplay(bool twoPlayers);
+void runGameplay(int numPlayers, bool demo, const InputRecording* ghost);
 int getGameScore(); // Declaración para obtener score del juego
 void showConfig();
+void showNetMenu();
+bool loadGhostRun(InputRecording& out);
+void showNotice(const std::string& msg);
 
 // Programa principal
 int main() {
@@ -102,6 +110,8 @@ int main() {
     noecho();
     keypad(stdscr, TRUE);
     curs_set(0);
+    initRenderColors();
+    startEngine();   // Los hilos del juego quedan esperando la primera partida
 
     Screen screen = Screen::MAIN_MENU;
 
@@ -122,10 +132,11 @@ int main() {
                 break;
                 
             case Screen::GAMEPLAY:
+            case Screen::GHOST_RACE:
                 {
                     clear();
                     refresh();
-                    runGameplay();
+                    runGameplay(1, false, screen == Screen::GHOST_RACE ? &g_ghostRun : nullptr);
                     
                     // Obtener score final del juego
                     int finalScore = getGameScore();
@@ -133,7 +144,8 @@ int main() {
                     // Verificar si es highscore
                     if (finalScore > 0 && g_highscores.isHighscore(finalScore)) {
                         std::string playerName = inputPlayerName(finalScore);
-                        g_highscores.addScore(finalScore, playerName);
+                        // El puntaje se envía con la entrada grabada de la partida
+                        g_highscores.addScore(finalScore, playerName, &getGameRecording());
                     }
                     
                     clear();
@@ -147,6 +159,7 @@ int main() {
         }
     }
 
+    stopEngine();
     endwin();
     return 0;
 }
@@ -159,18 +172,24 @@ Screen showMainMenu() {
         "Iniciar partida",
         "Instrucciones",
         "Puntajes destacados",
-        "Dos jugadores (coop)",
+        "Coop local",
         "Configuración",
+        "Versus (2 jugadores)",
+        "Versus (4 jugadores)",
+        "Demo (autopiloto)",
+        "Coop en red",
+        "Carrera contra el fantasma",
         "Salir"
     };
     int selected = 0;
+    items[3] = "Coop local (" + std::to_string(g_coopPlayers) + " jugadores)";
 
     while (true) {
         erase();
         int rows, cols; 
         getmaxyx(stdscr, rows, cols);
 
-        int top = rows/2 - 10, left = cols/2 - 30, bottom = rows/2 + 10, right = cols/2 + 30;
+        int top = rows/2 - 14, left = cols/2 - 30, bottom = rows/2 + 14, right = cols/2 + 30;
 
         drawFrame(top, left, bottom, right, " BREAKOUT ");
         centerPrint(top + 2, "MENU PRINCIPAL");
@@ -185,6 +204,17 @@ Screen showMainMenu() {
         }
         centerPrint(bottom - 2, "Usa Flechas (W/S)  Enter = Seleccionar  Esc = Salir");
 
+        // Cuánto tardó la última sesión en mostrar su primer frame
+        SessionTimes times = getSessionTimes();
+        if (times.firstFrameNs) {
+            char line[96];
+            std::snprintf(line, sizeof(line), "Último inicio: %.1f ms (hilos: %.0f / %.0f us)",
+                          times.firstFrameNs / 1e6, times.attachNs / 1e3, times.detachNs / 1e3);
+            attron(A_DIM);
+            centerPrint(bottom - 1, line);
+            attroff(A_DIM);
+        }
+
         refresh();
 
         int ch = getch();
@@ -195,59 +225,109 @@ Screen showMainMenu() {
         } else if (ch == 27) {
             return Screen::EXIT;
         } else if (ch == '\n' || ch == KEY_ENTER) {
+            markSessionRequest();
             switch (selected) {
-                case 0: // Un jugador
-                    clear(); refresh();
-                    runGameplay(false);                  
-                    clear(); refresh();
-                    return Screen::MAIN_MENU;
+                case 0: // Un jugador (al terminar puede entrar en la tabla)
+                    return Screen::GAMEPLAY;
 
                 case 1:
                     return Screen::INSTRUCTIONS;
 
                 case 2:
                     return Screen::HIGHSCORES;
-                case 3: // Dos jugadores (coop)
+                case 3: // Coop local (2 a 8 jugadores)
                     clear(); refresh();
-                    runGameplay(true);                  
+                    runGameplay(g_coopPlayers, false);                  
                     clear(); refresh();
                     return Screen::MAIN_MENU;
                 case 4: 
                     showConfig(); 
+                    items[3] = "Coop local (" + std::to_string(g_coopPlayers) + " jugadores)";
+                    break;
+                case 5: // Versus: un tablero por jugador
+                case 6:
+                    clear(); refresh();
+                    runVersus(selected == 5 ? 2 : 4);
+                    clear(); refresh();
+                    return Screen::MAIN_MENU;
+                case 7: // Demo: juega el autopiloto hasta que se presione una tecla
+                    clear(); refresh();
+                    runGameplay(1, true);
+                    clear(); refresh();
+                    return Screen::MAIN_MENU;
+                case 8: // Coop en red con otro proceso (crear o unirse)
+                    showNetMenu();
+                    clear(); refresh();
+                    return Screen::MAIN_MENU;
+                case 9: // Carrera contra la mejor partida grabada que entre en la terminal
+                    if (loadGhostRun(g_ghostRun)) return Screen::GHOST_RACE;
+                    showNotice("No hay partidas grabadas que entren en esta terminal");
                     break;
-                case 5:
+                case 10:
                     return Screen::EXIT;
                 }
         }
     }
 }
 
+// Mejor puntaje con grabación de un jugador cuya geometría entra en la
+// terminal (el nivel se arma igual que en esa partida)
+bool loadGhostRun(InputRecording& out) {
+    int rows, cols;
+    getmaxyx(stdscr, rows, cols);
+    for (const HighscoreEntry& e : g_highscores.getScores()) {   // Ordenados de mayor a menor
+        if (e.replay.empty()) continue;
+        InputRecording rec;
+        if (!loadRecording(rec, g_highscores.replayPath(e).c_str())) continue;
+        if (rec.numPlayers != 1 || rec.screenRows > rows || rec.screenCols > cols) continue;
+        out = rec;
+        return true;
+    }
+    return false;
+}
+
+// Mensaje centrado hasta que se presione una tecla
+void showNotice(const std::string& msg) {
+    clear();
+    int rows, cols;
+    getmaxyx(stdscr, rows, cols);
+    centerPrint(rows/2 - 1, msg);
+    centerPrint(rows/2 + 1, "[ Presiona una tecla ]");
+    refresh();
+    getch();
+}
+
 // Pantalla de instrucciones
 void showInstructions() {
     clear();
     int rows, cols; 
     getmaxyx(stdscr, rows, cols);
 
-    int top = rows/2 - 10, left = cols/2 - 35, bottom = rows/2 + 10, right = cols/2 + 35;
+    int top = rows/2 - 12, left = cols/2 - 35, bottom = rows/2 + 12, right = cols/2 + 35;
 
     drawFrame(top, left, bottom, right, " INSTRUCCIONES ");
     int y = top + 2;
     
-    centerPrint(y++, "Objetivo: Romper todos los ladrillos con la pelota,");
+    centerPrint(y++, "Objetivo: Romper los ladrillos de los 5 niveles con la pelota,");
     centerPrint(y++, "sin dejar que esta caiga al fondo, para sumar puntos.");
     y++;
 
     centerPrint(y++, "Mover paleta: ← / →  (A / D)");
+    centerPrint(y++, "Coop: P1 A/D  P2 ←/→  P3 J/L  P4 4/6  P5 Z/C  P6 F/H  P7 U/O  P8 7/9");
     centerPrint(y++, "Lanzar pelota: Espacio");
     centerPrint(y++, "Pausa: P");
     centerPrint(y++, "Reiniciar nivel: R");
+    centerPrint(y++, "Rebobinar unos segundos: B");
     centerPrint(y++, "Salir: Esc / Q");
+    centerPrint(y++, "Coop en red: cada jugador usa A/D o ←/→ en su terminal (sin rebobinar)");
+    centerPrint(y++, "Carrera: el fantasma (-, o tenues) es la mejor partida grabada");
     y++;
 
     centerPrint(y++, "Elementos del juego:");
     centerPrint(y++, "Paleta (=) controlada por el jugador");
     centerPrint(y++, "Pelota (o) que rebota y destruye ladrillos");
     centerPrint(y++, "Ladrillos (#, %, @) con diferentes resistencias");
+    centerPrint(y++, "Power-ups: W paleta ancha, M multibola, L laser (Espacio dispara)");
     centerPrint(y++, "Bordes (| - +) que delimitan el area de juego");
     y++;
     
@@ -301,27 +381,54 @@ void showHighscores() {
 // Variable global para la velocidad seleccionada
 int g_tick_ms = 60000; // valor por defecto
 
+// Variable global para las bolas por lanzamiento (más de 1 = modo estrés)
+int g_launchBalls = 1;
+
+// Variable global para la cantidad de jugadores en coop local
+int g_coopPlayers = 2;
+
+// Variable global para guardar la telemetría de cada sesión (apagada: no
+// deja archivos salvo que se pida)
+bool g_telemetry = false;
+
+// Variable global para publicar el estado a bin/monitor (apagada: no crea el
+// segmento de memoria compartida salvo que se pida)
+bool g_liveExport = false;
+
+// Variable global para aceptar espectadores por socket (apagada: no crea el
+// socket salvo que se pida)
+bool g_spectate = false;
+
 void showConfig() {
-    std::vector<std::string> options = {
-        "Velocidad 1 (lenta)",   // tick_ms = 60000
-        "Velocidad 2 (media)",   // tick_ms = 50000
-        "Velocidad 3 (rápida)"   // tick_ms = 40000
-    };
     int selected = 0;
 
     while (true) {
+        std::vector<std::string> options = {
+            "Velocidad 1 (lenta)",   // tick_ms = 60000
+            "Velocidad 2 (media)",   // tick_ms = 50000
+            "Velocidad 3 (rápida)",  // tick_ms = 40000
+            "Bolas: 1 (normal)",
+            "Bolas: 256 (estrés)",
+            "Bolas: 2048 (estrés extremo)",
+            "Jugadores coop: 2",
+            "Jugadores coop: 4",
+            "Jugadores coop: 8",
+            std::string("Telemetría: ") + (g_telemetry ? "sí" : "no"),
+            std::string("Monitor externo: ") + (g_liveExport ? "sí" : "no"),
+            std::string("Espectadores: ") + (g_spectate ? "sí" : "no")
+        };
         erase();
         int rows, cols;
         getmaxyx(stdscr, rows, cols);
 
-        int top = rows/2 - 6, left = cols/2 - 25, bottom = rows/2 + 6, right = cols/2 + 25;
+        int top = rows/2 - 12, left = cols/2 - 25, bottom = rows/2 + 12, right = cols/2 + 25;
         drawFrame(top, left, bottom, right, " CONFIGURACION ");
 
-        centerPrint(top + 2, "Selecciona velocidad de la pelota:");
+        centerPrint(top + 2, "Velocidad, bolas, jugadores y registros:");
 
         for (int i = 0; i < (int)options.size(); ++i) {
             std::string line = (i == selected ? ">> " : "") + options[i] + (i == selected ? " <<" : "");
-            int y = top + 4 + i*2;
+            int y = top + 4 + i;
 
             if (i == selected) attron(A_REVERSE);
             centerPrint(y, line);
@@ -344,8 +451,81 @@ void showConfig() {
                 case 0: g_tick_ms = 65000; break;
                 case 1: g_tick_ms = 55000; break;
                 case 2: g_tick_ms = 45000; break;
+                case 3: g_launchBalls = 1; break;
+                case 4: g_launchBalls = 256; break;
+                case 5: g_launchBalls = 2048; break;
+                case 6: g_coopPlayers = 2; break;
+                case 7: g_coopPlayers = 4; break;
+                case 8: g_coopPlayers = 8; break;
+                case 9: g_telemetry = !g_telemetry; break;
+                case 10: g_liveExport = !g_liveExport; break;
+                case 11: g_spectate = !g_spectate; break;
             }
             break;
         }
     }
 }
+
+// Coop en red: crear la partida o unirse, con latencia y pérdida simuladas
+// para probar en una sola máquina
+void showNetMenu() {
+    static const int LAG_MS[] = {0, 40, 80, 150};
+    static const int LOSS_PCT[] = {0, 5, 15, 30};
+    static int lag = 0, loss = 0;   // Se recuerdan entre partidas
+    int selected = 0;
+
+    while (true) {
+        std::vector<std::string> options = {
+            "Crear partida (puerto " + std::to_string(NET_DEFAULT_PORT) + ")",
+            "Unirse a 127.0.0.1:" + std::to_string(NET_DEFAULT_PORT),
+            "Latencia simulada: " + std::to_string(LAG_MS[lag]) + " ms",
+            "Pérdida simulada: " + std::to_string(LOSS_PCT[loss]) + "%"
+        };
+
+        erase();
+        int rows, cols;
+        getmaxyx(stdscr, rows, cols);
+
+        int top = rows/2 - 8, left = cols/2 - 30, bottom = rows/2 + 8, right = cols/2 + 30;
+        drawFrame(top, left, bottom, right, " COOP EN RED ");
+
+        centerPrint(top + 2, "Dos terminales en esta máquina, una paleta cada una");
+
+        for (int i = 0; i < (int)options.size(); ++i) {
+            std::string line = (i == selected ? ">> " : "") + options[i] + (i == selected ? " <<" : "");
+            int y = top + 4 + i*2;
+
+            if (i == selected) attron(A_REVERSE);
+            centerPrint(y, line);
+            if (i == selected) attroff(A_REVERSE);
+        }
+
+        centerPrint(bottom - 2, "[ Enter para seleccionar | Esc para volver ]");
+
+        refresh();
+
+        int ch = getch();
+        if (ch == KEY_UP || ch == 'w' || ch == 'W') {
+            selected = (selected - 1 + (int)options.size()) % (int)options.size();
+        } else if (ch == KEY_DOWN || ch == 's' || ch == 'S') {
+            selected = (selected + 1) % (int)options.size();
+        } else if (ch == 27) {
+            break; // volver al menú
+        } else if (ch == '\n' || ch == KEY_ENTER) {
+            if (selected == 2) {
+                lag = (lag + 1) % 4;
+            } else if (selected == 3) {
+                loss = (loss + 1) % 4;
+            } else {
+                // La latencia lleva un jitter de un cuarto (desordena paquetes)
+                NetShim shim;
+                shim.lagMs = LAG_MS[lag];
+                shim.jitterMs = LAG_MS[lag] / 4;
+                shim.lossPct = LOSS_PCT[loss];
+                clear(); refresh();
+                runNetplay(selected == 0, shim);
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,487 @@
+#include "netplay.h"
+#include "live_export.h"
+#include "replay.h"
+#include "snapshot.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/*
+HELPERS LOCALES DE ESTE MÓDULO
+*/
+
+// Paquetes: "BN" | u8 tipo | contenido (little-endian)
+enum NetPacket : uint8_t {
+    NP_HELLO = 1,     // u16 filas, u16 columnas de quien se une
+    NP_WELCOME = 2,   // u32 semilla, i32 bolas, u16 filas, u16 columnas, i32 tick
+    NP_INPUT = 3,     // u32 frame, u32 ack, u32 primero, u8 n, n entradas, u32 frame del hash, u32 hash
+    NP_BYE = 4        // u8 motivo (1 = la partida terminó)
+};
+
+struct PacketWriter {
+    uint8_t* p;
+    uint8_t* end;
+    bool ok = true;
+
+    void put8(uint32_t v) {
+        if (p >= end) { ok = false; return; }
+        *p++ = (uint8_t)v;
+    }
+    void put16(uint32_t v) { put8(v); put8(v >> 8); }
+    void put32(uint32_t v) { put16(v); put16(v >> 16); }
+};
+
+struct PacketReader {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok = true;
+
+    uint32_t get8() {
+        if (p >= end) { ok = false; return 0; }
+        return *p++;
+    }
+    uint32_t get16() { uint32_t v = get8(); return v | (get8() << 8); }
+    uint32_t get32() { uint32_t v = get16(); return v | (get16() << 16); }
+};
+
+static PacketWriter beginPacket(uint8_t* buf, size_t cap, NetPacket type) {
+    PacketWriter w{buf, buf + cap};
+    w.put8('B');
+    w.put8('N');
+    w.put8(type);
+    return w;
+}
+
+// Tipo del paquete (0 si no es de este protocolo)
+static int packetType(const uint8_t* buf, size_t len) {
+    if (len < 3 || buf[0] != 'B' || buf[1] != 'N') return 0;
+    return buf[2];
+}
+
+static uint32_t nextRandom(uint32_t& s) {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+}
+
+// FNV-1a de los bytes de un snapshot
+static uint32_t hashBytes(const uint8_t* p, size_t n) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; ++i) h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+static sockaddr_in loopback(int port) {
+    sockaddr_in a{};
+    a.sin_family = AF_INET;
+    a.sin_port = htons((uint16_t)port);
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return a;
+}
+
+/*
+SOCKET Y SHIM
+*/
+
+static int openUdp(int port) {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    sockaddr_in a = loopback(port);
+    if (bind(fd, (sockaddr*)&a, sizeof(a)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool NetLink::openHost(int port) {
+    close();
+    fd = openUdp(port);
+    havePeer = false;
+    return fd >= 0;
+}
+
+bool NetLink::openGuest(int port) {
+    close();
+    fd = openUdp(0);   // Puerto libre cualquiera
+    peer = loopback(port);
+    havePeer = true;
+    return fd >= 0;
+}
+
+void NetLink::close() {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+    havePeer = false;
+    delayed.clear();
+}
+
+void NetLink::setShim(const NetShim& s, uint32_t seed) {
+    shim = s;
+    rng = seed ? seed : 1;
+    delayed.reserve(256);
+}
+
+void NetLink::sendNow(const uint8_t* data, size_t len) {
+    if (fd < 0 || !havePeer) return;
+    sendto(fd, data, len, 0, (const sockaddr*)&peer, sizeof(peer));
+}
+
+void NetLink::send(const uint8_t* data, size_t len) {
+    if (len > NET_MAX_PACKET) return;
+    ++sent;
+    if (shim.lossPct > 0 && (int)(nextRandom(rng) % 100) < shim.lossPct) {
+        ++lost;
+        return;
+    }
+    if (shim.lagMs <= 0 && shim.jitterMs <= 0) {
+        sendNow(data, len);
+        return;
+    }
+    int ms = shim.lagMs + (shim.jitterMs > 0 ? (int)(nextRandom(rng) % (shim.jitterMs + 1)) : 0);
+    Delayed d;
+    d.dueNs = monotonicNs() + (uint64_t)ms * 1000000;
+    d.len = len;
+    std::memcpy(d.data, data, len);
+    delayed.push_back(d);
+}
+
+void NetLink::flush(uint64_t nowNs) {
+    for (size_t i = 0; i < delayed.size();) {
+        if (delayed[i].dueNs <= nowNs) {
+            sendNow(delayed[i].data, delayed[i].len);
+            delayed[i] = delayed.back();
+            delayed.pop_back();
+        } else {
+            ++i;
+        }
+    }
+}
+
+int NetLink::recv(uint8_t* buf, size_t cap) {
+    if (fd < 0) return -1;
+    sockaddr_in from{};
+    socklen_t fromLen = sizeof(from);
+    ssize_t n = recvfrom(fd, buf, cap, 0, (sockaddr*)&from, &fromLen);
+    if (n < 0) return -1;
+    // Quien crea adopta como compañero al primero que le escribe
+    if (!havePeer) {
+        peer = from;
+        havePeer = true;
+    } else if (from.sin_port != peer.sin_port || from.sin_addr.s_addr != peer.sin_addr.s_addr) {
+        return 0;   // De otro proceso: se ignora
+    }
+    ++received;
+    return (int)n;
+}
+
+void NetLink::drain() {
+    while (!delayed.empty()) {
+        uint64_t now = monotonicNs();
+        flush(now);
+        if (!delayed.empty()) usleep(pollTimeoutMs(now, 10) * 1000 + 100);
+    }
+}
+
+int NetLink::pollTimeoutMs(uint64_t nowNs, int limitMs) const {
+    int ms = limitMs;
+    for (const Delayed& d : delayed) {
+        int due = d.dueNs > nowNs ? (int)((d.dueNs - nowNs + 999999) / 1000000) : 0;
+        ms = std::min(ms, due);
+    }
+    return std::max(ms, 0);
+}
+
+/*
+CONEXIÓN
+*/
+
+static size_t buildWelcome(uint8_t* buf, size_t cap, const NetSetup& s) {
+    PacketWriter w = beginPacket(buf, cap, NP_WELCOME);
+    w.put32(s.seed);
+    w.put32((uint32_t)s.launchBalls);
+    w.put16((uint32_t)s.screenRows);
+    w.put16((uint32_t)s.screenCols);
+    w.put32((uint32_t)s.tickUs);
+    return w.ok ? (size_t)(w.p - buf) : 0;
+}
+
+// Espera hasta 100 ms un paquete; devuelve su largo o -1
+static int waitPacket(NetLink& link, uint8_t* buf, size_t cap) {
+    pollfd pfd{link.socketFd(), POLLIN, 0};
+    poll(&pfd, 1, link.pollTimeoutMs(monotonicNs(), 100));
+    link.flush(monotonicNs());
+    return link.recv(buf, cap);
+}
+
+bool netHostHandshake(NetLink& link, NetSetup& setup, bool (*keepWaiting)(void*), void* user) {
+    uint8_t buf[NET_MAX_PACKET];
+    while (keepWaiting(user)) {
+        int n = waitPacket(link, buf, sizeof(buf));
+        if (n <= 0 || packetType(buf, n) != NP_HELLO) continue;
+        PacketReader rd{buf + 3, buf + n};
+        int rows = (int)rd.get16(), cols = (int)rd.get16();
+        if (!rd.ok) continue;
+        setup.screenRows = std::min(setup.screenRows, rows);
+        setup.screenCols = std::min(setup.screenCols, cols);
+        size_t len = buildWelcome(buf, sizeof(buf), setup);
+        link.send(buf, len);
+        return true;
+    }
+    return false;
+}
+
+bool netGuestHandshake(NetLink& link, int rows, int cols, NetSetup& setup,
+                       bool (*keepWaiting)(void*), void* user) {
+    uint8_t buf[NET_MAX_PACKET];
+    while (keepWaiting(user)) {
+        PacketWriter w = beginPacket(buf, sizeof(buf), NP_HELLO);
+        w.put16((uint32_t)rows);
+        w.put16((uint32_t)cols);
+        link.send(buf, (size_t)(w.p - buf));
+
+        int n = waitPacket(link, buf, sizeof(buf));
+        if (n <= 0 || packetType(buf, n) != NP_WELCOME) continue;
+        PacketReader rd{buf + 3, buf + n};
+        setup.seed = rd.get32();
+        setup.launchBalls = (int32_t)rd.get32();
+        setup.screenRows = (int32_t)rd.get16();
+        setup.screenCols = (int32_t)rd.get16();
+        setup.tickUs = (int32_t)rd.get32();
+        if (rd.ok) return true;
+    }
+    return false;
+}
+
+bool netAnswerHello(NetLink& link, const NetSetup& setup, const uint8_t* buf, size_t len) {
+    if (packetType(buf, len) != NP_HELLO) return false;
+    uint8_t out[NET_MAX_PACKET];
+    link.send(out, buildWelcome(out, sizeof(out), setup));
+    return true;
+}
+
+void setupNetGame(GameConfig& cfg, const NetSetup& setup) {
+    InputRecording rec;
+    rec.seed = setup.seed;
+    rec.numPlayers = 2;
+    rec.launchBalls = std::max(1, setup.launchBalls);
+    rec.screenRows = setup.screenRows;
+    rec.screenCols = setup.screenCols;
+    setupRecordedGame(cfg, rec);
+    cfg.tick_ms = setup.tickUs;
+}
+
+size_t buildByePacket(uint8_t* buf, size_t cap, NetEnd reason) {
+    PacketWriter w = beginPacket(buf, cap, NP_BYE);
+    w.put8(reason == NET_FINISHED ? 1 : 0);
+    return w.ok ? (size_t)(w.p - buf) : 0;
+}
+
+// El compañero terminó la partida confirmada: aquí es la misma partida, así
+// que también terminó (aunque el último frame local todavía sea predicho)
+NetEnd readByePacket(const uint8_t* buf, size_t len) {
+    if (packetType(buf, len) != NP_BYE) return NET_PLAYING;
+    return (len > 3 && buf[3] == 1) ? NET_FINISHED : NET_PEER_LEFT;
+}
+
+/*
+LOCKSTEP CON ROLLBACK
+*/
+
+void NetRollback::start(GameConfig& c, int localPlayer) {
+    cfg = &c;
+    local = localPlayer;
+    frame = 0;
+    std::memset(input, 0, sizeof(input));
+    std::memset(used, 0, sizeof(used));
+    std::memset(sentNs, 0, sizeof(sentNs));
+    // Los primeros NET_INPUT_DELAY frames no tienen entrada en ningún lado
+    known[0] = known[1] = NET_INPUT_DELAY;
+    remoteAck = 0;
+    remoteFrame = 0;
+    rollbackFrom = UINT32_MAX;
+    for (int i = 0; i < SNAPS; ++i) {
+        snapFrame[i] = UINT32_MAX;
+        snaps[i].reserve(snapshotMaxSize(c) * 2);
+    }
+    hashedUpTo = 0;
+    peerHashFrame = 0;
+    peerHash = 0;
+    comparedUpTo = 0;
+    stats = NetStats();
+
+    saveSnapshot(0);
+    hashes[0] = hashBytes(snaps[0].data(), snapLen[0]);
+}
+
+// Entrada conocida o, para el compañero, la predicción: mantiene la última
+// dirección conocida y no repite botones
+uint8_t NetRollback::inputFor(int player, uint32_t f) const {
+    if (f < known[player]) return input[player][f % NET_HISTORY];
+    return known[player] > 0 ? (input[player][(known[player] - 1) % NET_HISTORY] & NI_DIR) : 0;
+}
+
+void NetRollback::saveSnapshot(uint32_t f) {
+    int i = f % SNAPS;
+    std::vector<uint8_t>& s = snaps[i];
+    size_t need = snapshotMaxSize(*cfg);
+    if (s.size() < need) s.resize(need);
+    snapLen[i] = serializeState(*cfg, s.data(), s.size());
+    snapFrame[i] = f;
+}
+
+// Un frame con la entrada de los dos jugadores (igual que el tick: entrada,
+// cambio de nivel y simulación). El frame en que se arma un nivel nuevo sólo
+// hace eso
+void NetRollback::step(uint32_t f) {
+    GameConfig& g = *cfg;
+    saveSnapshot(f);
+    for (int p = 0; p < 2; ++p) {
+        uint8_t in = inputFor(p, f);
+        if (p != local) used[f % NET_HISTORY] = in;
+        g.paddles[p].desiredDir = (in & NI_LEFT) ? -1 : (in & NI_RIGHT) ? 1 : 0;
+        if (in & NI_PAUSE) g.paused = !g.paused;
+        if ((in & NI_RESTART) && (g.running || g.won || g.lost)) {
+            g.restartRequested = true;
+            g.running = true;
+        }
+        if (in & NI_ACTION) {
+            if (!g.ballLaunched) simLaunch(g);
+            else simFire(g);
+        }
+    }
+    if (g.restartRequested) {
+        g.events.clear();
+        resetLevel(g);
+    } else if (g.running && !g.paused) {
+        simFrame(g);
+    } else {
+        g.events.clear();
+    }
+}
+
+void NetRollback::addRemote(uint32_t f, uint8_t in) {
+    const int remote = 1 - local;
+    if (f != known[remote]) return;   // Repetida o fuera de orden (llegará de nuevo)
+    input[remote][f % NET_HISTORY] = in;
+    known[remote] = f + 1;
+    if (f < frame && used[f % NET_HISTORY] != in) rollbackFrom = std::min(rollbackFrom, f);
+}
+
+int NetRollback::advance(uint8_t in, uint64_t nowNs) {
+    uint32_t f = frame + NET_INPUT_DELAY;
+    input[local][f % NET_HISTORY] = in;
+    sentNs[f % NET_HISTORY] = nowNs;
+    known[local] = f + 1;
+
+    int depth = 0;
+    if (rollbackFrom < frame) {
+        uint64_t t0 = monotonicNs();
+        int i = rollbackFrom % SNAPS;
+        if (snapFrame[i] == rollbackFrom && deserializeState(*cfg, snaps[i].data(), snapLen[i])) {
+            depth = (int)(frame - rollbackFrom);
+            for (uint32_t k = rollbackFrom; k < frame; ++k) {
+                step(k);
+                cfg->events.clear();   // Ya se publicaron los de la predicción
+            }
+            uint64_t ns = monotonicNs() - t0;
+            stats.rollbacks++;
+            stats.resimFrames += depth;
+            stats.lastResimNs = ns;
+            stats.resimNs += ns;
+            stats.maxResimNs = std::max(stats.maxResimNs, ns);
+            stats.maxDepth = std::max(stats.maxDepth, depth);
+            stats.depthHist[std::min(depth, NET_MAX_ROLLBACK)]++;
+        }
+        rollbackFrom = UINT32_MAX;
+    }
+    stats.lastDepth = depth;
+    if (depth == 0) stats.lastResimNs = 0;
+
+    step(frame);
+    frame++;
+    stats.frames++;
+    hashConfirmed();
+    return depth;
+}
+
+// Hashea los snapshots que ya no dependen de ninguna predicción (la entrada
+// de todos los frames anteriores es conocida)
+void NetRollback::hashConfirmed() {
+    uint32_t upTo = std::min(known[1 - local], frame);
+    while (hashedUpTo + 1 <= upTo) {
+        uint32_t f = hashedUpTo + 1;
+        int i = f % SNAPS;
+        if (snapFrame[i] != f) break;   // Todavía no se simuló el frame f
+        hashes[f % NET_HISTORY] = hashBytes(snaps[i].data(), snapLen[i]);
+        hashedUpTo = f;
+    }
+    checkPeerHash();
+}
+
+void NetRollback::checkPeerHash() {
+    if (peerHashFrame <= comparedUpTo || peerHashFrame > hashedUpTo) return;
+    if (hashedUpTo - peerHashFrame < NET_HISTORY && hashes[peerHashFrame % NET_HISTORY] != peerHash) {
+        stats.desyncs++;
+    }
+    comparedUpTo = peerHashFrame;
+}
+
+int NetRollback::frameAdvantage(uint64_t tickNs) const {
+    double half = tickNs ? stats.rttMs * 1e6 / 2.0 / (double)tickNs : 0.0;
+    return (int)frame - (int)remoteFrame - (int)(half + 0.5);
+}
+
+size_t NetRollback::buildPacket(uint8_t* buf, size_t cap) const {
+    const int remote = 1 - local;
+    uint32_t last = known[local];
+    uint32_t first = std::max(remoteAck, last > NET_HISTORY ? last - NET_HISTORY : 0u);
+    first = std::max(first, last > 255 ? last - 255 : 0u);
+    PacketWriter w = beginPacket(buf, cap, NP_INPUT);
+    w.put32(frame);
+    w.put32(known[remote]);
+    w.put32(first);
+    w.put8(last - first);
+    for (uint32_t f = first; f < last; ++f) w.put8(input[local][f % NET_HISTORY]);
+    w.put32(hashedUpTo);
+    w.put32(hashes[hashedUpTo % NET_HISTORY]);
+    return w.ok ? (size_t)(w.p - buf) : 0;
+}
+
+bool NetRollback::readPacket(const uint8_t* buf, size_t len, uint64_t nowNs) {
+    if (packetType(buf, len) != NP_INPUT) return false;
+    PacketReader rd{buf + 3, buf + len};
+    uint32_t peerFrame = rd.get32();
+    uint32_t ack = rd.get32();
+    uint32_t first = rd.get32();
+    uint32_t n = rd.get8();
+    const uint8_t* inputs = rd.p;
+    rd.p += std::min<size_t>(n, rd.end - rd.p);
+    uint32_t hashFrame = rd.get32();
+    uint32_t hash = rd.get32();
+    if (!rd.ok) return false;
+
+    remoteFrame = std::max(remoteFrame, peerFrame);
+    if (ack > remoteAck && ack <= known[local]) {
+        // RTT: desde que se generó la última entrada confirmada
+        uint64_t t = sentNs[(ack - 1) % NET_HISTORY];
+        if (t && nowNs > t) {
+            float ms = (nowNs - t) / 1e6f;
+            stats.rttMs = stats.rttMs > 0.0f ? stats.rttMs + 0.125f * (ms - stats.rttMs) : ms;
+        }
+        remoteAck = ack;
+    }
+    for (uint32_t k = 0; k < n; ++k) addRemote(first + k, inputs[k]);
+    if (hashFrame > peerHashFrame) {
+        peerHashFrame = hashFrame;
+        peerHash = hash;
+    }
+    checkPeerHash();
+    return true;
+}
@@ -0,0 +1,220 @@
+/*
+netplay.h - Coop de dos procesos, cada uno en su terminal, por UDP en la misma
+máquina (127.0.0.1).
+
+Los dos procesos arman la misma partida (semilla, geometría y velocidad las
+elige quien la crea) y la simulan en lockstep: cada frame depende sólo del
+estado anterior y de la entrada de los dos jugadores en ese frame. La entrada
+local se aplica NET_INPUT_DELAY frames más tarde y se envía enseguida; la del
+compañero, mientras no llega, se predice repitiendo su última dirección. Cuando
+llega distinta de lo predicho se restaura el snapshot del primer frame
+equivocado y se vuelven a simular los frames hasta el actual (rollback), así
+ningún lado espera al otro salvo que se adelante más de NET_MAX_ROLLBACK frames.
+
+Cada paquete repite toda la entrada local que el compañero todavía no confirmó
+(tolera pérdidas sin retransmisiones) y el hash del último frame confirmado,
+para detectar una desincronización. Para probar en una sola máquina, NetLink
+puede demorar y descartar los paquetes que envía (NetShim).
+
+No depende de ncurses.
+*/
+#ifndef NETPLAY_H
+#define NETPLAY_H
+
+#include "sim.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <netinet/in.h>
+
+const int NET_DEFAULT_PORT = 47800;
+const int NET_INPUT_DELAY = 1;     // Frames de retardo de la entrada local
+const int NET_MAX_ROLLBACK = 12;   // Frames que se puede adelantar a la entrada del compañero
+const int NET_HISTORY = 64;        // Frames de entrada guardados (potencia de 2)
+const int NET_TIMEOUT_MS = 5000;   // Sin paquetes del compañero se da por perdida la conexión
+const size_t NET_MAX_PACKET = 512;
+
+// Entrada de un jugador en un frame: dirección que mantiene y botones
+// presionados desde el frame anterior
+enum NetInputBits : uint8_t {
+    NI_LEFT = 1,
+    NI_RIGHT = 2,
+    NI_ACTION = 4,
+    NI_PAUSE = 8,
+    NI_RESTART = 16
+};
+const uint8_t NI_DIR = NI_LEFT | NI_RIGHT;
+
+// Partida que propone quien la crea
+struct NetSetup {
+    uint32_t seed = 0;
+    int32_t launchBalls = 1;
+    int32_t screenRows = 0, screenCols = 0;   // La terminal más chica de las dos
+    int32_t tickUs = 0;
+};
+
+// Red simulada en el envío: demora (más un jitter al azar, que puede
+// desordenar paquetes) y pérdida
+struct NetShim {
+    int lagMs = 0;
+    int jitterMs = 0;
+    int lossPct = 0;
+};
+
+// Socket UDP en loopback hacia el compañero
+class NetLink {
+private:
+    struct Delayed {
+        uint64_t dueNs;
+        size_t len;
+        uint8_t data[NET_MAX_PACKET];
+    };
+
+    int fd = -1;
+    sockaddr_in peer{};
+    bool havePeer = false;
+    NetShim shim;
+    uint32_t rng = 1;
+    std::vector<Delayed> delayed;
+
+    void sendNow(const uint8_t* data, size_t len);
+
+public:
+    unsigned long sent = 0, received = 0, lost = 0;
+
+    NetLink() = default;
+    ~NetLink() { close(); }
+    NetLink(const NetLink&) = delete;
+    NetLink& operator=(const NetLink&) = delete;
+
+    // Quien crea escucha en `port`; quien se une envía a ese puerto
+    bool openHost(int port);
+    bool openGuest(int port);
+    void close();
+    int socketFd() const { return fd; }
+
+    void setShim(const NetShim& s, uint32_t seed);
+    void send(const uint8_t* data, size_t len);   // Pasa por el shim
+    void flush(uint64_t nowNs);                   // Envía los demorados que vencieron
+    int recv(uint8_t* buf, size_t cap);           // Bytes del próximo paquete; -1 si no hay
+    int pollTimeoutMs(uint64_t nowNs, int limitMs) const;
+    void drain();                                 // Espera a enviar los demorados (antes de cerrar)
+};
+
+// Espera al compañero. Quien crea propone `setup` (con su terminal) y lo deja
+// ajustado a la terminal más chica; quien se une lo recibe. keepWaiting se
+// consulta cada ~100 ms: false cancela
+bool netHostHandshake(NetLink& link, NetSetup& setup, bool (*keepWaiting)(void*), void* user);
+bool netGuestHandshake(NetLink& link, int rows, int cols, NetSetup& setup,
+                       bool (*keepWaiting)(void*), void* user);
+
+// Ya en juego, quien crea vuelve a responder el saludo si su respuesta se
+// perdió; false si el paquete no era un saludo
+bool netAnswerHello(NetLink& link, const NetSetup& setup, const uint8_t* buf, size_t len);
+
+// Partida de dos jugadores a partir de la propuesta
+void setupNetGame(GameConfig& cfg, const NetSetup& setup);
+
+struct NetStats {
+    unsigned long frames = 0;        // Frames avanzados (sin contar los repetidos)
+    unsigned long rollbacks = 0;
+    unsigned long resimFrames = 0;   // Frames vueltos a simular
+    unsigned long stalls = 0;        // Ticks sin avanzar: demasiado adelante del compañero
+    unsigned long desyncs = 0;       // Hashes de frames confirmados que no coinciden
+    int lastDepth = 0, maxDepth = 0;
+    uint64_t lastResimNs = 0, resimNs = 0, maxResimNs = 0;
+    unsigned long depthHist[NET_MAX_ROLLBACK + 1] = {};
+    float rttMs = 0.0f;
+};
+
+// Simulación en lockstep con predicción y rollback sobre cfg (ya preparado
+// con setupNetGame). El jugador local es la paleta `local` (0 quien crea, 1
+// quien se une)
+class NetRollback {
+private:
+    GameConfig* cfg = nullptr;
+    int local = 0;
+    uint32_t frame = 0;                      // Frames simulados
+    uint8_t input[2][NET_HISTORY];
+    uint8_t used[NET_HISTORY];               // Entrada del compañero con que se simuló cada frame
+    uint32_t known[2] = {0, 0};              // Frames con entrada conocida (contiguos desde 0)
+    uint32_t remoteAck = 0;                  // Entrada local que el compañero ya tiene
+    uint32_t remoteFrame = 0;                // Último frame que informó el compañero
+    uint32_t rollbackFrom = UINT32_MAX;      // Primer frame simulado con una predicción errada
+    uint64_t sentNs[NET_HISTORY];            // Cuándo se generó cada entrada local (para el RTT)
+
+    // Snapshot del estado antes de simular cada uno de los últimos frames
+    static const int SNAPS = NET_MAX_ROLLBACK + 2;
+    std::vector<uint8_t> snaps[SNAPS];
+    size_t snapLen[SNAPS] = {};
+    uint32_t snapFrame[SNAPS];
+
+    // Hashes de los frames confirmados (estado antes de simularlos)
+    uint32_t hashes[NET_HISTORY];
+    uint32_t hashedUpTo = 0;                 // Frames confirmados ya hasheados
+    uint32_t peerHashFrame = 0, peerHash = 0;   // Último hash que informó el compañero
+    uint32_t comparedUpTo = 0;
+
+    uint8_t inputFor(int player, uint32_t f) const;
+    void saveSnapshot(uint32_t f);
+    void step(uint32_t f);
+    void addRemote(uint32_t f, uint8_t in);
+    void hashConfirmed();
+    void checkPeerHash();
+
+public:
+    NetStats stats;
+
+    void start(GameConfig& cfg, int localPlayer);
+
+    // Se puede simular otro frame sin pasarse de NET_MAX_ROLLBACK
+    bool canAdvance() const { return frame < known[1 - local] + NET_MAX_ROLLBACK; }
+
+    // Corrige la predicción si hace falta y simula el frame siguiente con la
+    // entrada local `in` (que se aplica NET_INPUT_DELAY frames después).
+    // Devuelve los frames que se volvieron a simular (0 = sin rollback); los
+    // eventos de esos frames se descartan, los del frame nuevo quedan en cfg
+    int advance(uint8_t in, uint64_t nowNs);
+
+    // El estado actual ya no depende de ninguna predicción
+    bool confirmed() const { return frame <= known[1 - local] && rollbackFrom == UINT32_MAX; }
+    uint32_t currentFrame() const { return frame; }
+    uint32_t confirmedFrames() const { return hashedUpTo; }
+    uint32_t peerConfirmedFrames() const { return peerHashFrame; }
+    // Hash del estado tras `f` frames confirmados (de los últimos NET_HISTORY);
+    // 0 si todavía no se confirmó o ya se descartó
+    uint32_t confirmedHash(uint32_t f) const {
+        return (f <= hashedUpTo && hashedUpTo - f < NET_HISTORY) ? hashes[f % NET_HISTORY] : 0;
+    }
+
+    // Frames que este lado va adelante del compañero (con la mitad del RTT
+    // descontada); el que va adelante espera un poco para emparejar
+    int frameAdvantage(uint64_t tickNs) const;
+
+    size_t buildPacket(uint8_t* buf, size_t cap) const;
+    // Lee un paquete de entrada; false si no es uno (bye, handshake, basura)
+    bool readPacket(const uint8_t* buf, size_t len, uint64_t nowNs);
+};
+
+// Aviso de fin de la sesión (se envía varias veces: UDP puede perderlo)
+enum NetEnd {
+    NET_PLAYING,
+    NET_FINISHED,    // La partida terminó (ganaron o perdieron)
+    NET_QUIT,        // El jugador local salió
+    NET_PEER_LEFT,   // El compañero salió
+    NET_TIMEOUT      // No llegan paquetes del compañero
+};
+size_t buildByePacket(uint8_t* buf, size_t cap, NetEnd reason);
+// NET_PLAYING si el paquete no es un aviso de fin; si no, cómo termina aquí
+NetEnd readByePacket(const uint8_t* buf, size_t len);
+
+// Sesión de red de una partida del juego (la atiende su hilo de red)
+struct NetSession {
+    NetLink link;
+    NetRollback rollback;
+    NetSetup setup;
+    bool host = false;
+    NetEnd end = NET_PLAYING;
+};
+
+#endif // NETPLAY_H
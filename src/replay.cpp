@@ -0,0 +1,222 @@
+#include "replay.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <pthread.h>
+#include <unistd.h>
+
+/*
+FORMATO DEL ARCHIVO (.bkr)
+
+    u32 magic | u32 seed | i32 numPlayers, launchBalls, screenRows, screenCols
+    i32 level | f32 ballSpeed                      (sólo desde BKR2)
+    u32 frames | i32 finalScore | u32 comandos
+    comandos x (u32 frame | u8 tipo | i8 jugador | i16 valor)
+
+Las grabaciones BKR1 (anteriores al nivel y la velocidad iniciales) se siguen
+leyendo: empiezan en el nivel 1 con la velocidad normal.
+*/
+
+static const uint32_t REPLAY_MAGIC_V1 = 0x31524B42;   // "BKR1"
+static const uint32_t REPLAY_MAGIC = 0x32524B42;      // "BKR2"
+
+void setupRecordedGame(GameConfig& cfg, const InputRecording& rec) {
+    initGameConfig(cfg, rec.numPlayers, rec.launchBalls);
+    seedRandom(cfg, rec.seed);
+    setupPlayArea(cfg, rec.screenRows, rec.screenCols);
+    cfg.level = std::max(1, rec.level);
+    resetLevel(cfg);
+    if (rec.ballSpeed > 0.0f) cfg.ballSpeed = std::max(0.5f, std::min(2.0f, rec.ballSpeed));
+}
+
+bool applyInput(GameConfig& cfg, RewindBuffer& rewind, const InputCommand& cmd) {
+    switch (cmd.type) {
+        case IN_MOVE:
+            if (cmd.player >= 0 && cmd.player < cfg.numPlayers) {
+                cfg.paddles[cmd.player].desiredDir = cmd.value;
+            }
+            break;
+
+        case IN_RELEASE:
+            for (int i = 0; i < cfg.numPlayers; ++i) cfg.paddles[i].desiredDir = 0;
+            break;
+
+        case IN_PAUSE:
+            cfg.paused = !cfg.paused;
+            break;
+
+        case IN_ACTION:
+            if (!cfg.ballLaunched) simLaunch(cfg);
+            else simFire(cfg);
+            break;
+
+        case IN_RESTART:
+            if (cfg.running || cfg.won || cfg.lost) {
+                cfg.restartRequested = true;
+                cfg.running = true;   // Reactivar si estaba terminado
+            }
+            break;
+
+        case IN_REWIND: {
+            // El contador de frames no retrocede: sigue contando los frames
+            // jugados en el nivel
+            unsigned long frame = cfg.frameCounter;
+            if (rewind.rewind(cfg, cmd.value) > 0) {
+                cfg.frameCounter = frame;
+                return true;
+            }
+            break;
+        }
+    }
+    return false;
+}
+
+bool saveRecording(const InputRecording& rec, const char* path) {
+    FILE* f = std::fopen(path, "wb");
+    if (!f) return false;
+
+    uint32_t count = (uint32_t)rec.commands.size();
+    bool ok = std::fwrite(&REPLAY_MAGIC, 4, 1, f) == 1 &&
+              std::fwrite(&rec.seed, 4, 1, f) == 1 &&
+              std::fwrite(&rec.numPlayers, 4, 1, f) == 1 &&
+              std::fwrite(&rec.launchBalls, 4, 1, f) == 1 &&
+              std::fwrite(&rec.screenRows, 4, 1, f) == 1 &&
+              std::fwrite(&rec.screenCols, 4, 1, f) == 1 &&
+              std::fwrite(&rec.level, 4, 1, f) == 1 &&
+              std::fwrite(&rec.ballSpeed, 4, 1, f) == 1 &&
+              std::fwrite(&rec.frames, 4, 1, f) == 1 &&
+              std::fwrite(&rec.finalScore, 4, 1, f) == 1 &&
+              std::fwrite(&count, 4, 1, f) == 1;
+    for (uint32_t i = 0; ok && i < count; ++i) {
+        const InputCommand& c = rec.commands[i];
+        ok = std::fwrite(&c.frame, 4, 1, f) == 1 && std::fwrite(&c.type, 1, 1, f) == 1 &&
+             std::fwrite(&c.player, 1, 1, f) == 1 && std::fwrite(&c.value, 2, 1, f) == 1;
+    }
+    return std::fclose(f) == 0 && ok;
+}
+
+bool loadRecording(InputRecording& rec, const char* path) {
+    FILE* f = std::fopen(path, "rb");
+    if (!f) return false;
+
+    uint32_t magic = 0, count = 0;
+    bool ok = std::fread(&magic, 4, 1, f) == 1 &&
+              (magic == REPLAY_MAGIC || magic == REPLAY_MAGIC_V1) &&
+              std::fread(&rec.seed, 4, 1, f) == 1 &&
+              std::fread(&rec.numPlayers, 4, 1, f) == 1 &&
+              std::fread(&rec.launchBalls, 4, 1, f) == 1 &&
+              std::fread(&rec.screenRows, 4, 1, f) == 1 &&
+              std::fread(&rec.screenCols, 4, 1, f) == 1;
+    rec.level = 1;
+    rec.ballSpeed = 0.0f;
+    if (ok && magic == REPLAY_MAGIC) {
+        ok = std::fread(&rec.level, 4, 1, f) == 1 && std::fread(&rec.ballSpeed, 4, 1, f) == 1;
+    }
+    ok = ok && std::fread(&rec.frames, 4, 1, f) == 1 &&
+         std::fread(&rec.finalScore, 4, 1, f) == 1 &&
+         std::fread(&count, 4, 1, f) == 1;
+    rec.commands.clear();
+    if (ok) rec.commands.reserve(count);
+    for (uint32_t i = 0; ok && i < count; ++i) {
+        InputCommand c{};
+        ok = std::fread(&c.frame, 4, 1, f) == 1 && std::fread(&c.type, 1, 1, f) == 1 &&
+             std::fread(&c.player, 1, 1, f) == 1 && std::fread(&c.value, 2, 1, f) == 1;
+        if (ok) rec.commands.push_back(c);
+    }
+    std::fclose(f);
+    return ok;
+}
+
+void startReplay(ReplayCursor& cur, const InputRecording& rec, GameConfig& cfg, RewindBuffer& rewind) {
+    setupRecordedGame(cfg, rec);
+    rewind.clear();
+    cur = ReplayCursor();
+    cur.rec = &rec;
+
+    // Los snapshots de rebobinado no cambian la partida: sólo se graban si
+    // la grabación usa la tecla B
+    for (const InputCommand& c : rec.commands) cur.usesRewind |= (c.type == IN_REWIND);
+}
+
+// Cada paso reproduce lo que hace el tick del juego: comandos encolados,
+// cambio de nivel pendiente y, si la partida sigue, un frame completo
+bool stepReplay(ReplayCursor& cur, GameConfig& cfg, RewindBuffer& rewind) {
+    if (cur.ended) return false;
+    const InputRecording& rec = *cur.rec;
+    const size_t n = rec.commands.size();
+    bool quit = false;
+    while (cur.next < n && rec.commands[cur.next].frame == cur.frame) {
+        const InputCommand& c = rec.commands[cur.next++];
+        if (c.type == IN_QUIT) {
+            quit = true;
+            cfg.running = false;   // Como stopBoard en el juego
+        } else if (!quit) {
+            applyInput(cfg, rewind, c);
+        }
+    }
+    if (quit || cur.frame >= rec.frames) {
+        cur.ended = true;
+        return false;
+    }
+
+    if (cfg.restartRequested) resetLevel(cfg);
+    if (!cfg.running) {
+        cur.ended = true;   // La partida grabada no pudo seguir aquí
+        return false;
+    }
+
+    simFrame(cfg);
+    ++cur.frame;
+    // El hilo de estado graba el frame salvo que se haya perdido la
+    // última vida (en ese caso el pipeline se corta antes)
+    if (cur.usesRewind && !cfg.lost) rewind.record(cfg);
+    return true;
+}
+
+int replayRecording(const InputRecording& rec, GameConfig& cfg, RewindBuffer& rewind,
+                    unsigned long& frames) {
+    ReplayCursor cur;
+    startReplay(cur, rec, cfg, rewind);
+    while (stepReplay(cur, cfg, rewind)) ++frames;
+    return cfg.score;
+}
+
+/*
+REPETICIÓN EN PARALELO
+*/
+
+struct ReplayJob {
+    const std::vector<InputRecording>* recs;
+    std::vector<int>* scores;
+    std::atomic<size_t> next{0};
+    std::atomic<unsigned long> frames{0};
+};
+
+// Cada hilo toma la siguiente grabación libre hasta que no quedan (las
+// partidas tienen largos muy distintos, así se reparten solas)
+static void* replayWorker(void* arg) {
+    auto* job = (ReplayJob*)arg;
+    GameConfig cfg{};
+    RewindBuffer rewind;
+    unsigned long frames = 0;
+    for (size_t i = job->next.fetch_add(1); i < job->recs->size(); i = job->next.fetch_add(1)) {
+        (*job->scores)[i] = replayRecording((*job->recs)[i], cfg, rewind, frames);
+    }
+    job->frames.fetch_add(frames);
+    return nullptr;
+}
+
+unsigned long replayParallel(const std::vector<InputRecording>& recs, std::vector<int>& scores,
+                             int threads) {
+    scores.assign(recs.size(), 0);
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    threads = std::max(1, std::min(threads, (int)recs.size()));
+
+    ReplayJob job;
+    job.recs = &recs;
+    job.scores = &scores;
+    std::vector<pthread_t> workers(threads);
+    for (auto& t : workers) pthread_create(&t, nullptr, replayWorker, &job);
+    for (auto& t : workers) pthread_join(t, nullptr);
+    return job.frames.load();
+}
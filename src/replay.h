@@ -0,0 +1,94 @@
+/*
+replay.h - Grabación de la entrada de una partida para repetirla sin terminal.
+
+El hilo de entrada no modifica la partida directamente: encola comandos que el
+tick aplica entre frames, igual que los cambios de nivel. Así la partida queda
+determinada por la semilla, la geometría y la lista de comandos con el frame
+en que se aplicaron, y la repetición llega exactamente al mismo puntaje. Con
+eso se validan los puntajes enviados (ver tools/validate.cpp).
+
+No depende de ncurses.
+*/
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "sim.h"
+#include "snapshot.h"
+#include <cstdint>
+#include <vector>
+
+enum InputType : uint8_t {
+    IN_MOVE,      // player = jugador; value = dirección (-1 o 1)
+    IN_RELEASE,   // Soltar todas las paletas
+    IN_PAUSE,
+    IN_ACTION,    // Lanzar la bola o, ya en juego, disparar el láser
+    IN_RESTART,
+    IN_REWIND,    // value = frames a rebobinar
+    IN_QUIT
+};
+
+struct InputCommand {
+    uint32_t frame;   // Frames simulados antes de aplicarlo
+    uint8_t type;
+    int8_t player;
+    int16_t value;
+};
+
+struct InputRecording {
+    uint32_t seed = 0;
+    int32_t numPlayers = 1;
+    int32_t launchBalls = 1;
+    int32_t screenRows = 0, screenCols = 0;
+    int32_t level = 1;           // Nivel inicial
+    float ballSpeed = 0.0f;      // Velocidad inicial de la bola (0 = la normal)
+    uint32_t frames = 0;         // Frames simulados en total
+    int32_t finalScore = 0;      // Puntaje que informó el juego
+    std::vector<InputCommand> commands;
+
+    // Vacía la lista de comandos conservando la capacidad
+    void clear() { frames = 0; finalScore = 0; commands.clear(); }
+};
+
+// Deja cfg como al comienzo de la partida grabada (pools, semilla, geometría,
+// nivel y velocidad iniciales)
+void setupRecordedGame(GameConfig& cfg, const InputRecording& rec);
+
+// Aplica un comando entre frames (en el juego, con el mutex del tablero).
+// IN_QUIT no se aplica aquí: lo resuelve quien maneja los hilos. Devuelve
+// true si el estado se reemplazó (rebobinado) y hay que avisar al render
+bool applyInput(GameConfig& cfg, RewindBuffer& rewind, const InputCommand& cmd);
+
+// Archivo binario (.bkr); devuelven false si no se pudo leer o escribir
+bool saveRecording(const InputRecording& rec, const char* path);
+bool loadRecording(InputRecording& rec, const char* path);
+
+// Repetición de a un frame, en el mismo orden que el tick: comandos de ese
+// frame, cambio de nivel pendiente y simulación
+struct ReplayCursor {
+    const InputRecording* rec = nullptr;
+    size_t next = 0;           // Próximo comando a aplicar
+    uint32_t frame = 0;        // Frames simulados
+    bool usesRewind = false;   // Sólo entonces se graban snapshots de rebobinado
+    bool ended = false;
+};
+
+// Deja cfg al comienzo de la partida grabada y el cursor en el frame 0. La
+// grabación tiene que seguir viva mientras se use el cursor
+void startReplay(ReplayCursor& cur, const InputRecording& rec, GameConfig& cfg, RewindBuffer& rewind);
+
+// Simula el frame siguiente; false (y ended) si la partida grabada terminó
+bool stepReplay(ReplayCursor& cur, GameConfig& cfg, RewindBuffer& rewind);
+
+// Repite la partida sin terminal y devuelve el puntaje final. cfg y rewind son
+// del llamador para reutilizarlos entre repeticiones; frames acumula los
+// frames simulados
+int replayRecording(const InputRecording& rec, GameConfig& cfg, RewindBuffer& rewind,
+                    unsigned long& frames);
+
+// Repite todas las grabaciones repartidas entre `threads` hilos (0 = uno por
+// núcleo), cada hilo con su propio estado. Deja el puntaje final de cada una
+// en scores y devuelve los frames simulados en total
+unsigned long replayParallel(const std::vector<InputRecording>& recs, std::vector<int>& scores,
+                             int threads = 0);
+
+#endif // REPLAY_H
@@ -0,0 +1,178 @@
+#include "rl_env.h"
+#include <algorithm>
+
+// Penalización por perder una vida
+static const float LIFE_PENALTY = 10.0f;
+
+BreakoutVecEnv::BreakoutVecEnv(int n, int numThreads, int maxStepsPerEpisode)
+    : numEnvs(n), maxSteps(maxStepsPerEpisode), envs(n) {
+    pthread_mutex_init(&poolMutex, nullptr);
+    pthread_cond_init(&poolStartCV, nullptr);
+    pthread_cond_init(&poolDoneCV, nullptr);
+
+    // Observación: ocupación de la grilla + bola 0 (x, y, vx, vy) +
+    // paleta 0 (x) + bola lanzada
+    for (auto& cfg : envs) {
+        initGameConfig(cfg, 1, 1);
+        cfg.tick_ms = 0;
+        setupPlayArea(cfg, 40, 120);
+    }
+    obsSize = envs.empty() ? 0 : envs[0].rows * envs[0].cols + 6;
+    obs.assign((size_t)numEnvs * obsSize, 0.0f);
+    rewards.assign(numEnvs, 0.0f);
+    dones.assign(numEnvs, 0);
+    steps.assign(numEnvs, 0);
+
+    int extra = std::max(0, std::min(numThreads, numEnvs) - 1);
+    workers.resize(extra);
+    workerArgs.resize(extra);
+    for (int t = 0; t < extra; ++t) {
+        workerArgs[t].env = this;
+        workerArgs[t].shard = t + 1;   // el bloque 0 lo atiende quien llama
+        pthread_create(&workers[t], nullptr, workerMain, &workerArgs[t]);
+    }
+}
+
+BreakoutVecEnv::~BreakoutVecEnv() {
+    pthread_mutex_lock(&poolMutex);
+    stopping = true;
+    pthread_cond_broadcast(&poolStartCV);
+    pthread_mutex_unlock(&poolMutex);
+    for (auto& t : workers) pthread_join(t, nullptr);
+
+    pthread_cond_destroy(&poolDoneCV);
+    pthread_cond_destroy(&poolStartCV);
+    pthread_mutex_destroy(&poolMutex);
+}
+
+void BreakoutVecEnv::shardRange(int shard, int& begin, int& end) const {
+    int shards = (int)workers.size() + 1;
+    begin = (int)((long)numEnvs * shard / shards);
+    end   = (int)((long)numEnvs * (shard + 1) / shards);
+}
+
+void* BreakoutVecEnv::workerMain(void* arg) {
+    auto* wa = (WorkerArg*)arg;
+    BreakoutVecEnv* self = wa->env;
+    unsigned long seen = 0;
+
+    while (true) {
+        pthread_mutex_lock(&self->poolMutex);
+        while (!self->stopping && self->generation == seen) {
+            pthread_cond_wait(&self->poolStartCV, &self->poolMutex);
+        }
+        if (self->stopping) {
+            pthread_mutex_unlock(&self->poolMutex);
+            break;
+        }
+        seen = self->generation;
+        const int* actions = self->curActions;
+        pthread_mutex_unlock(&self->poolMutex);
+
+        int begin, end;
+        self->shardRange(wa->shard, begin, end);
+        self->stepRange(begin, end, actions);
+
+        pthread_mutex_lock(&self->poolMutex);
+        if (--self->pending == 0) pthread_cond_signal(&self->poolDoneCV);
+        pthread_mutex_unlock(&self->poolMutex);
+    }
+    return nullptr;
+}
+
+void BreakoutVecEnv::resetEnv(int i, unsigned int seed) {
+    GameConfig& cfg = envs[i];
+    cfg.level = 1;
+    seedRandom(cfg, seed);
+    resetLevel(cfg);
+    steps[i] = 0;
+}
+
+void BreakoutVecEnv::writeObs(int i) {
+    const GameConfig& cfg = envs[i];
+    float* o = &obs[(size_t)i * obsSize];
+
+    for (int r = 0; r < cfg.rows; ++r) {
+        for (int c = 0; c < cfg.cols; ++c) {
+            *o++ = cfg.grid[r][c].hp > 0 ? 1.0f : 0.0f;
+        }
+    }
+
+    // Posiciones normalizadas al área jugable
+    const float invW = 1.0f / cfg.w, invH = 1.0f / cfg.h;
+    if (cfg.balls.count > 0) {
+        *o++ = (cfg.balls.x[0] - cfg.x0) * invW;
+        *o++ = (cfg.balls.y[0] - cfg.y0) * invH;
+        *o++ = cfg.balls.vx[0];
+        *o++ = cfg.balls.vy[0];
+    } else {
+        *o++ = 0.0f; *o++ = 0.0f; *o++ = 0.0f; *o++ = 0.0f;
+    }
+    const Paddle& p = cfg.paddles[0];
+    *o++ = (p.x + p.w / 2.0f - cfg.x0) * invW;
+    *o++ = cfg.ballLaunched ? 1.0f : 0.0f;
+}
+
+void BreakoutVecEnv::stepRange(int begin, int end, const int* actions) {
+    for (int i = begin; i < end; ++i) {
+        GameConfig& cfg = envs[i];
+        int prevScore = cfg.score;
+        int prevLives = cfg.lives;
+
+        int a = actions[i];
+        cfg.paddles[0].desiredDir = (a == ACTION_LEFT) ? -1 : (a == ACTION_RIGHT) ? 1 : 0;
+        if (a == ACTION_LAUNCH) simLaunch(cfg);
+
+        simFrame(cfg);
+        steps[i]++;
+
+        float r = (float)(cfg.score - prevScore);
+        if (cfg.lives < prevLives) r -= LIFE_PENALTY;
+        rewards[i] = r;
+
+        // Cambio de nivel: se arma el siguiente conservando el puntaje
+        if (cfg.restartRequested) {
+            int score = cfg.score;
+            resetLevel(cfg);
+            cfg.score = score;
+        }
+
+        bool done = cfg.won || cfg.lost || steps[i] >= maxSteps;
+        dones[i] = done ? 1 : 0;
+        if (done) resetEnv(i, simRandom(cfg));
+        writeObs(i);
+    }
+}
+
+void BreakoutVecEnv::reset(const uint32_t* seeds) {
+    for (int i = 0; i < numEnvs; ++i) {
+        resetEnv(i, seeds[i]);
+        rewards[i] = 0.0f;
+        dones[i] = 0;
+        writeObs(i);
+    }
+}
+
+void BreakoutVecEnv::step(const int* actions) {
+    if (workers.empty()) {
+        stepRange(0, numEnvs, actions);
+        return;
+    }
+
+    pthread_mutex_lock(&poolMutex);
+    curActions = actions;
+    pending = (int)workers.size();
+    generation++;
+    pthread_cond_broadcast(&poolStartCV);
+    pthread_mutex_unlock(&poolMutex);
+
+    int begin, end;
+    shardRange(0, begin, end);
+    stepRange(begin, end, actions);
+
+    pthread_mutex_lock(&poolMutex);
+    while (pending > 0) {
+        pthread_cond_wait(&poolDoneCV, &poolMutex);
+    }
+    pthread_mutex_unlock(&poolMutex);
+}
@@ -0,0 +1,75 @@
+/*
+rl_env.h - Entorno vectorizado para aprendizaje por refuerzo. Ejecuta N partidas
+sin terminal con la misma simulación del juego (sim.h) y escribe las
+observaciones de todas en un único buffer contiguo reservado al construirlo.
+No depende de ncurses.
+*/
+#ifndef RL_ENV_H
+#define RL_ENV_H
+
+#include "../sim.h"
+#include <pthread.h>
+#include <vector>
+#include <cstdint>
+
+// Acciones por entorno
+enum RLAction {
+    ACTION_NOOP = 0,
+    ACTION_LEFT = 1,
+    ACTION_RIGHT = 2,
+    ACTION_LAUNCH = 3
+};
+
+class BreakoutVecEnv {
+private:
+    int numEnvs;
+    int obsSize;
+    int maxSteps;                       // Truncado de episodios
+    std::vector<GameConfig> envs;
+    std::vector<float> obs;             // numEnvs * obsSize
+    std::vector<float> rewards;
+    std::vector<uint8_t> dones;
+    std::vector<int> steps;             // Pasos del episodio actual
+
+    // Pool de hilos opcional: cada hilo atiende un bloque contiguo de entornos
+    std::vector<pthread_t> workers;
+    pthread_mutex_t poolMutex;
+    pthread_cond_t poolStartCV;
+    pthread_cond_t poolDoneCV;
+    unsigned long generation = 0;
+    int pending = 0;
+    bool stopping = false;
+    const int* curActions = nullptr;
+
+    struct WorkerArg { BreakoutVecEnv* env; int shard; };
+    std::vector<WorkerArg> workerArgs;
+
+    void resetEnv(int i, unsigned int seed);
+    void stepRange(int begin, int end, const int* actions);
+    void writeObs(int i);
+    void shardRange(int shard, int& begin, int& end) const;
+    static void* workerMain(void* arg);
+
+public:
+    // numThreads <= 1 ejecuta todo en el hilo que llama
+    BreakoutVecEnv(int numEnvs, int numThreads = 1, int maxSteps = 10000);
+    ~BreakoutVecEnv();
+    BreakoutVecEnv(const BreakoutVecEnv&) = delete;
+    BreakoutVecEnv& operator=(const BreakoutVecEnv&) = delete;
+
+    // Reinicia todos los entornos (seeds: numEnvs semillas)
+    void reset(const uint32_t* seeds);
+
+    // Avanza un frame en cada entorno (actions: numEnvs RLAction). Los
+    // entornos terminados se reinician solos; su done queda en 1 ese paso
+    void step(const int* actions);
+
+    int getNumEnvs() const { return numEnvs; }
+    int getObsSize() const { return obsSize; }
+    const float* getObservations() const { return obs.data(); }
+    const float* getRewards() const { return rewards.data(); }
+    const uint8_t* getDones() const { return dones.data(); }
+    const GameConfig& getEnv(int i) const { return envs[i]; }
+};
+
+#endif // RL_ENV_H
@@ -0,0 +1,1061 @@
+#include "sim.h"
+#include <algorithm>
+#include <cmath>
+
+/*
+HELPERS LOCALES DE ESTE MÓDULO
+*/
+
+// Anota un evento del frame en curso
+static void emit(GameConfig& cfg, EventType type, int a, int b, int value) {
+    cfg.events.push(type, a, b, value, cfg.frameCounter);
+}
+
+// Velocidad objetivo según el score (sube por escalones)
+static float speedTargetFor(int score) {
+    if (score >= 400) return 1.6f;
+    if (score >= 200) return 1.4f;
+    if (score >= 100) return 1.2f;
+    return 1.0f;
+}
+
+static void normalizeAngle(float& vx, float& vy) {
+    if (std::fabs(vx) < BALL_MIN_VX) vx = (vx >= 0 ? BALL_MIN_VX : -BALL_MIN_VX);
+    if (std::fabs(vy) < BALL_MIN_VY) vy = (vy >= 0 ? BALL_MIN_VY : -BALL_MIN_VY);
+}
+
+// Dimensiona la grilla de ladrillos. Sólo reserva memoria si cambian las
+// dimensiones (al iniciar la partida): reinicios y cambios de nivel reutilizan
+// las mismas filas
+static void sizeGrid(GameConfig& cfg) {
+    bool fits = (int)cfg.grid.size() == cfg.rows;
+    for (int r = 0; fits && r < cfg.rows; ++r) {
+        fits = (int)cfg.grid[r].size() == cfg.cols;
+    }
+    if (!fits) cfg.grid.assign(cfg.rows, std::vector<Brick>(cfg.cols));
+}
+
+// Tipos de ladrillo
+constexpr Brick BRICK_NONE{0, ' ', 0};
+constexpr Brick BRICK_NORMAL{1, '#', 10};
+constexpr Brick BRICK_STRONG{2, '%', 30};
+constexpr Brick BRICK_HARD{3, '@', 50};
+
+// Nivel 4: ladrillos de distinto ancho en posiciones libres, sin grilla
+constexpr FreeBrickDef FREE_SCATTER[] = {
+    {4, 0, 12, BRICK_HARD}, {33, 0, 12, BRICK_HARD}, {62, 0, 12, BRICK_HARD},
+    {0, 2, 5, BRICK_NORMAL}, {9, 2, 7, BRICK_STRONG}, {20, 2, 3, BRICK_NORMAL},
+    {27, 2, 9, BRICK_STRONG}, {40, 2, 3, BRICK_NORMAL}, {47, 2, 9, BRICK_STRONG},
+    {60, 2, 3, BRICK_NORMAL}, {67, 2, 7, BRICK_STRONG}, {75, 2, 3, BRICK_NORMAL},
+    {14, 4, 18, BRICK_STRONG}, {46, 4, 18, BRICK_STRONG},
+    {2, 5, 4, BRICK_NORMAL}, {36, 5, 6, BRICK_HARD}, {72, 5, 4, BRICK_NORMAL},
+    {6, 7, 6, BRICK_NORMAL}, {18, 8, 6, BRICK_NORMAL}, {30, 7, 6, BRICK_NORMAL},
+    {42, 8, 6, BRICK_NORMAL}, {54, 7, 6, BRICK_NORMAL}, {66, 8, 6, BRICK_NORMAL},
+};
+
+// Nivel 5: filas que van y vienen en sentidos opuestos, dos ladrillos que
+// giran y dos que suben y bajan por los costados
+constexpr FreeBrickDef FREE_MOVING[] = {
+    {10, 0, 8, BRICK_HARD}, {35, 0, 8, BRICK_HARD}, {60, 0, 8, BRICK_HARD},
+    {0, 2, 6, BRICK_STRONG, PATH_LINE, 12, 0, 240, 0},
+    {13, 2, 6, BRICK_NORMAL, PATH_LINE, 12, 0, 240, 0},
+    {26, 2, 6, BRICK_STRONG, PATH_LINE, 12, 0, 240, 0},
+    {39, 2, 6, BRICK_NORMAL, PATH_LINE, 12, 0, 240, 0},
+    {52, 2, 6, BRICK_STRONG, PATH_LINE, 12, 0, 240, 0},
+    {18, 4, 6, BRICK_NORMAL, PATH_LINE, -12, 0, 200, 0},
+    {31, 4, 6, BRICK_STRONG, PATH_LINE, -12, 0, 200, 0},
+    {44, 4, 6, BRICK_NORMAL, PATH_LINE, -12, 0, 200, 0},
+    {57, 4, 6, BRICK_STRONG, PATH_LINE, -12, 0, 200, 0},
+    {70, 4, 6, BRICK_NORMAL, PATH_LINE, -12, 0, 200, 0},
+    {20, 8, 5, BRICK_HARD, PATH_ORBIT, 8, 2, 180, 0},
+    {53, 8, 5, BRICK_HARD, PATH_ORBIT, 8, 2, 180, 90},
+    {1, 5, 4, BRICK_NORMAL, PATH_LINE, 0, 4, 160, 0},
+    {73, 5, 4, BRICK_NORMAL, PATH_LINE, 0, 4, 160, 80},
+};
+
+// Niveles incluidos: el ladrillo de cada fila de la grilla (las filas que no
+// están en la tabla repiten la última; sin filas, la grilla queda vacía) y
+// los ladrillos libres
+struct LevelDef {
+    int numRows;
+    Brick rows[8];
+    const FreeBrickDef* free = nullptr;
+    int numFree = 0;
+};
+
+#define FREE_LIST(a) a, (int)(sizeof(a) / sizeof(a[0]))
+
+constexpr LevelDef LEVELS[] = {
+    {1, {BRICK_NORMAL}},
+    {4, {BRICK_HARD, BRICK_STRONG, BRICK_STRONG, BRICK_NORMAL}},
+    {1, {BRICK_HARD}},
+    {0, {}, FREE_LIST(FREE_SCATTER)},
+    {0, {}, FREE_LIST(FREE_MOVING)},
+};
+constexpr int NUM_LEVELS = (int)(sizeof(LEVELS) / sizeof(LEVELS[0]));
+
+#undef FREE_LIST
+
+constexpr const Brick& levelBrick(const LevelDef& L, int r) {
+    return L.numRows <= 0 ? BRICK_NONE : L.rows[r < L.numRows ? r : L.numRows - 1];
+}
+
+constexpr bool fitsFreeBricks(const FreeBrickDef* d, int n) {
+    for (int i = 0; i < n; ++i) {
+        if (d[i].w < 1 || d[i].w > FREE_MAX_W || d[i].x < 0 || d[i].x + d[i].w > FREE_REF_W) return false;
+        if (d[i].path != PATH_STILL && d[i].period <= 0) return false;
+    }
+    return true;
+}
+
+// Las tablas se verifican al compilar
+static_assert(levelBrick(LEVELS[1], 0).hp == 3 && levelBrick(LEVELS[1], 2).hp == 2 &&
+              levelBrick(LEVELS[1], 3).ch == '#', "nivel 2: una fila @, dos %, el resto #");
+static_assert(fitsFreeBricks(LEVELS[3].free, LEVELS[3].numFree) &&
+              fitsFreeBricks(LEVELS[4].free, LEVELS[4].numFree),
+              "ladrillos libres: ancho entre 1 y FREE_MAX_W, dentro del área de referencia");
+
+// Zona de los ladrillos libres: desde el primer ladrillo de la grilla hasta
+// unas filas por encima de la paleta
+static void sizeFreeBricks(GameConfig& cfg) {
+    cfg.freeBricks.setBounds(cfg.x0 + 1, cfg.x1 - 1, cfg.y0 + 2, cfg.y1 - 6);
+}
+
+// Carga ladrillos libres definidos en el área de referencia, escalando las
+// columnas al ancho del área. Las posiciones y el hash los arma syncDerivedState
+static void loadFreeBricks(GameConfig& cfg, const FreeBrickDef* defs, int n) {
+    FreeBricks& F = cfg.freeBricks;
+    sizeFreeBricks(cfg);
+    F.resize(n);
+    F.tick = 0;
+    F.moving = 0;
+    const float scale = (float)(cfg.w - 2) / FREE_REF_W;
+    for (int i = 0; i < F.count; ++i) {
+        const FreeBrickDef& d = defs[i];
+        F.baseX[i] = F.minX + d.x * scale;
+        F.baseY[i] = F.minY + d.y;
+        F.w[i] = (short)std::max(1, std::min((int)std::lround(d.w * scale), FREE_MAX_W));
+        F.brick[i] = d.brick;
+        F.path[i] = d.path;
+        F.dx[i] = d.dx * scale;
+        F.dy[i] = d.dy;
+        F.period[i] = std::max(1, d.period);
+        F.phase[i] = (d.phase % F.period[i] + F.period[i]) % F.period[i];
+        F.cellY[i] = -1;
+        if (d.path != PATH_STILL) F.moving++;
+    }
+}
+
+// Carga un nivel: cada fila se llena con el ladrillo de la tabla, y después
+// van los ladrillos libres
+static void buildLevel(GameConfig& cfg, const LevelDef& L) {
+    sizeGrid(cfg);
+    for (int r = 0; r < cfg.rows; ++r) {
+        std::fill(cfg.grid[r].begin(), cfg.grid[r].end(), levelBrick(L, r));
+    }
+    loadFreeBricks(cfg, L.free, L.numFree);
+}
+
+// Quita los power-ups y disparos en pantalla y termina sus efectos
+static void clearEntities(GameConfig& cfg) {
+    cfg.powerUps.clear();
+    cfg.shots.clear();
+    cfg.laserFrames = 0;
+    cfg.laserCooldown = 0;
+    for (int i = 0; i < cfg.numPlayers; ++i) {
+        Paddle& p = cfg.paddles[i];
+        if (p.wideFrames > 0) p.w = p.baseW;
+        p.wideFrames = 0;
+    }
+}
+
+// Coloca una bola nueva sobre la paleta 1, esperando lanzamiento. Los
+// power-ups activos se pierden junto con la vida
+static void parkBallOnPaddle(GameConfig& cfg) {
+    clearEntities(cfg);
+    cfg.balls.clear();
+    const Paddle& p = cfg.paddles[0];
+    cfg.balls.spawn(p.x + p.w / 2.0f, p.y - 1.0f, 0.0f, 0.0f);
+    cfg.ballLaunched = false;
+    cfg.ballJustReset = true;
+}
+
+// Rebote contra una paleta: la dirección horizontal depende de dónde golpeó
+// (rel, de -1 en el borde izquierdo a +1 en el derecho)
+static bool bouncePaddle(float& bx, float& by, float& bvx, float& bvy,
+                         int padX, int padY, int padW, float& rel) {
+    int ballIntY = (int)std::round(by);
+    int ballIntX = (int)std::round(bx);
+    if (ballIntY != padY - 1 && ballIntY != padY) return false;
+    if (ballIntX < padX || ballIntX >= padX + padW) return false;
+
+    by  = padY - 2;
+    bvy = -std::fabs(bvy);
+
+    float center = padX + padW / 2.0f;
+    float half   = std::max(1.0f, padW / 2.0f);
+    rel          = (bx - center) / half; // [-1..+1]
+    bvx = rel * 0.6f;
+    normalizeAngle(bvx, bvy);
+    return true;
+}
+
+// Celda de ladrillo bajo una posición de pantalla, calculada directamente a
+// partir de la geometría (costo constante)
+struct BrickLookup {
+    BrickLayout L;
+    int rowPitch, widePitch, pitch, wideSpan, left;
+
+    explicit BrickLookup(const GameConfig& cfg) {
+        L = computeBrickLayout(cfg);
+        rowPitch  = cfg.brickH + cfg.gapY;
+        widePitch = L.brickW + 1 + cfg.gapX;   // columnas con +1
+        pitch     = L.brickW + cfg.gapX;
+        wideSpan  = L.remainder * widePitch;
+        left      = cfg.x0 + 1;
+    }
+
+    // Devuelve false si la posición no cae dentro de un ladrillo de la grilla
+    bool cell(const GameConfig& cfg, int sx, int sy, int& r, int& c, int& relX, int& thisW) const {
+        int offY = sy - L.startY;
+        if (offY < 0) return false;
+        r = offY / rowPitch;
+        int relY = offY % rowPitch;
+        if (r >= cfg.rows || relY >= cfg.brickH) return false;
+
+        int offX = sx - left;
+        if (offX < 0) return false;
+        if (offX < wideSpan) {
+            c = offX / widePitch;
+            relX = offX % widePitch;
+            thisW = L.brickW + 1;
+        } else {
+            c = L.remainder + (offX - wideSpan) / pitch;
+            relX = (offX - wideSpan) % pitch;
+            thisW = L.brickW;
+        }
+        return c < cfg.cols && relX < thisW;
+    }
+
+    // Centro en pantalla de la celda (r, c)
+    void center(int r, int c, float& cx, float& cy) const {
+        int x = (c < L.remainder) ? c * widePitch : wideSpan + (c - L.remainder) * pitch;
+        int w = L.brickW + (c < L.remainder ? 1 : 0);
+        cx = left + x + w / 2.0f;
+        cy = (float)(L.startY + r * rowPitch);
+    }
+};
+
+// Probabilidad (en %) de que un ladrillo destruido suelte un power-up
+static const int POWERUP_DROP_PERCENT = 12;
+
+// Suma los puntos de un ladrillo destruido y a veces suelta un power-up desde
+// su centro (cx, cy). (r, c) lo identifican en los eventos
+static void destroyBrick(GameConfig& cfg, int r, int c, int points, float cx, float cy) {
+    cfg.score += points;
+    cfg.bricksAlive--;
+    cfg.speedTarget = speedTargetFor(cfg.score);
+    emit(cfg, EV_BRICK_DESTROYED, r, c, points);
+    emit(cfg, EV_SCORE_CHANGED, 0, points, cfg.score);
+    if ((int)(simRandom(cfg) % 100) < POWERUP_DROP_PERCENT) {
+        cfg.powerUps.spawn(cx, cy, 0.3f, (int)(simRandom(cfg) % POWER_COUNT));
+    }
+}
+
+// Quita un punto de vida al ladrillo (r, c) de la grilla
+static void hitGridBrick(GameConfig& cfg, const BrickLookup& B, int r, int c) {
+    Brick& brick = cfg.grid[r][c];
+    brick.hp--;
+    emit(cfg, EV_BRICK_HIT, r, c, std::max(0, brick.hp));
+    if (brick.hp > 0) return;
+    float cx, cy;
+    B.center(r, c, cx, cy);
+    destroyBrick(cfg, r, c, brick.points, cx, cy);
+}
+
+// Quita un punto de vida al ladrillo libre i; destruido, sale del hash
+static void hitFreeBrick(GameConfig& cfg, int i) {
+    FreeBricks& F = cfg.freeBricks;
+    Brick& brick = F.brick[i];
+    brick.hp--;
+    emit(cfg, EV_BRICK_HIT, FREE_BRICK_ROW, i, std::max(0, brick.hp));
+    if (brick.hp > 0) return;
+    F.unlink(i);
+    destroyBrick(cfg, FREE_BRICK_ROW, i, brick.points, F.x[i] + F.w[i] / 2.0f, (float)F.y[i]);
+}
+
+// Reconstruye el índice de colisión de paletas. Las paletas se ordenan por
+// (fila, x) y se barren en ese orden: en columnas donde dos paletas se
+// solapan gana la que empieza más a la izquierda
+static void buildPaddleSweep(GameConfig& cfg) {
+    PaddleSweep& S = cfg.paddleSweep;
+    const int n = cfg.numPlayers;
+
+    // Ordenamiento por inserción (n <= MAX_PLAYERS)
+    for (int i = 0; i < n; ++i) {
+        int k = i;
+        const Paddle& pi = cfg.paddles[i];
+        while (k > 0) {
+            const Paddle& pk = cfg.paddles[S.order[k - 1]];
+            if (pk.y < pi.y || (pk.y == pi.y && pk.x <= pi.x)) break;
+            S.order[k] = S.order[k - 1];
+            --k;
+        }
+        S.order[k] = i;
+    }
+
+    S.numRows = 0;
+    signed char* row = nullptr;
+    for (int k = 0; k < n; ++k) {
+        const Paddle& p = cfg.paddles[S.order[k]];
+        if (S.numRows == 0 || S.rowY[S.numRows - 1] != p.y) {
+            S.rowY[S.numRows] = p.y;
+            row = &S.owner[S.numRows * S.stride];
+            std::fill(row, row + S.stride, (signed char)-1);
+            S.numRows++;
+        }
+        int from = std::max(0, p.x - S.originX);
+        int to   = std::min(S.stride, p.x + p.w - S.originX);
+        for (int c = from; c < to; ++c) {
+            if (row[c] < 0) row[c] = (signed char)S.order[k];
+        }
+    }
+}
+
+/*
+LADRILLOS LIBRES
+*/
+
+void FreeBricks::init(int cap) {
+    baseX.reserve(cap); baseY.reserve(cap); dx.reserve(cap); dy.reserve(cap);
+    w.reserve(cap); path.reserve(cap); period.reserve(cap); phase.reserve(cap);
+    brick.reserve(cap);
+    x.reserve(cap); y.reserve(cap);
+    cellX0.reserve(cap); cellX1.reserve(cap); cellY.reserve(cap);
+    next.reserve(cap * FREE_SPAN); prev.reserve(cap * FREE_SPAN);
+    capacity = cap;
+    clear();
+}
+
+FreeBricks& FreeBricks::operator=(const FreeBricks& o) {
+    if (this == &o) return *this;
+    if (capacity != o.capacity) init(o.capacity);
+    baseX = o.baseX; baseY = o.baseY; dx = o.dx; dy = o.dy;
+    w = o.w; path = o.path; period = o.period; phase = o.phase;
+    brick = o.brick;
+    x = o.x; y = o.y;
+    cellX0 = o.cellX0; cellX1 = o.cellX1; cellY = o.cellY;
+    next = o.next; prev = o.prev;
+    head = o.head;
+    count = o.count;
+    moving = o.moving;
+    tick = o.tick;
+    minX = o.minX; maxX = o.maxX; minY = o.minY; maxY = o.maxY;
+    hashCols = o.hashCols; hashRows = o.hashRows;
+    return *this;
+}
+
+void FreeBricks::resize(int n) {
+    count = std::max(0, std::min(n, capacity));
+    baseX.resize(count); baseY.resize(count); dx.resize(count); dy.resize(count);
+    w.resize(count); path.resize(count); period.resize(count); phase.resize(count);
+    brick.resize(count);
+    x.resize(count); y.resize(count);
+    cellX0.resize(count); cellX1.resize(count); cellY.resize(count);
+    next.resize(count * FREE_SPAN); prev.resize(count * FREE_SPAN);
+}
+
+// El hash cubre la zona [left, right] x [top, bottom]; sólo se redimensiona
+// si cambia la geometría
+void FreeBricks::setBounds(int left, int right, int top, int bottom) {
+    minX = left;
+    maxX = std::max(left, right);
+    minY = top;
+    maxY = std::max(top, bottom);
+    hashCols = (maxX - minX) / FREE_CELL_W + 1;
+    hashRows = (maxY - minY) / FREE_CELL_H + 1;
+    if ((int)head.size() != hashCols * hashRows) head.assign(hashCols * hashRows, -1);
+}
+
+// Enlaza el ladrillo i en las celdas que ocupa su posición actual
+void FreeBricks::link(int i) {
+    const int cy = (y[i] - minY) / FREE_CELL_H;
+    const int c0 = (x[i] - minX) / FREE_CELL_W;
+    const int c1 = std::min(hashCols - 1, (x[i] + w[i] - 1 - minX) / FREE_CELL_W);
+    for (int c = c0, k = 0; c <= c1; ++c, ++k) {
+        int n = i * FREE_SPAN + k;
+        int& h = head[cy * hashCols + c];
+        prev[n] = -1;
+        next[n] = h;
+        if (h >= 0) prev[h] = n;
+        h = n;
+    }
+    cellX0[i] = (short)c0;
+    cellX1[i] = (short)c1;
+    cellY[i] = (short)cy;
+}
+
+void FreeBricks::unlink(int i) {
+    if (cellY[i] < 0) return;
+    for (int c = cellX0[i], k = 0; c <= cellX1[i]; ++c, ++k) {
+        int n = i * FREE_SPAN + k;
+        if (prev[n] >= 0) next[prev[n]] = next[n];
+        else head[cellY[i] * hashCols + c] = next[n];
+        if (next[n] >= 0) prev[next[n]] = prev[n];
+    }
+    cellY[i] = -1;
+}
+
+void FreeBricks::place(int i) {
+    float fx = baseX[i], fy = baseY[i];
+    if (path[i] != PATH_STILL) {
+        float u = (float)((tick + (unsigned)phase[i]) % (unsigned)period[i]) / period[i];
+        if (path[i] == PATH_LINE) {
+            float s = u < 0.5f ? 2.0f * u : 2.0f - 2.0f * u;
+            fx += dx[i] * s;
+            fy += dy[i] * s;
+        } else {
+            float a = 6.2831853f * u;
+            fx += dx[i] * std::cos(a);
+            fy += dy[i] * std::sin(a);
+        }
+    }
+    int nx = std::max(minX, std::min((int)std::lround(fx), maxX - w[i] + 1));
+    int ny = std::max(minY, std::min((int)std::lround(fy), maxY));
+    if (nx == x[i] && ny == y[i] && cellY[i] >= 0) return;
+    x[i] = (short)nx;
+    y[i] = (short)ny;
+    if (brick[i].hp <= 0) return;
+
+    // La mayoría de los pasos no cambian de celda: entonces el hash no se toca
+    int cy = (ny - minY) / FREE_CELL_H;
+    int c0 = (nx - minX) / FREE_CELL_W;
+    int c1 = std::min(hashCols - 1, (nx + w[i] - 1 - minX) / FREE_CELL_W);
+    if (cy == cellY[i] && c0 == cellX0[i] && c1 == cellX1[i]) return;
+    unlink(i);
+    link(i);
+}
+
+void FreeBricks::rebuild() {
+    std::fill(head.begin(), head.end(), -1);
+    for (int i = 0; i < count; ++i) {
+        cellY[i] = -1;
+        place(i);
+    }
+}
+
+int FreeBricks::find(int sx, int sy) const {
+    int ox = sx - minX, oy = sy - minY;
+    if (count == 0 || ox < 0 || oy < 0 || sx > maxX || sy > maxY) return -1;
+    int best = -1;
+    for (int n = head[(oy / FREE_CELL_H) * hashCols + ox / FREE_CELL_W]; n >= 0; n = next[n]) {
+        int i = n / FREE_SPAN;
+        if (y[i] == sy && sx >= x[i] && sx < x[i] + w[i] && (best < 0 || i < best)) best = i;
+    }
+    return best;
+}
+
+// Avanza los ladrillos con recorrido un frame. Sólo se mueven con la bola en
+// juego, así el nivel arranca siempre igual
+static void moveFreeBricks(GameConfig& cfg) {
+    FreeBricks& F = cfg.freeBricks;
+    if (F.moving == 0 || !cfg.ballLaunched) return;
+    F.tick++;
+    for (int i = 0; i < F.count; ++i) {
+        if (F.path[i] != PATH_STILL && F.brick[i].hp > 0) F.place(i);
+    }
+}
+
+/*
+FUNCIONES PÚBLICAS
+*/
+
+void seedRandom(GameConfig& cfg, unsigned int seed) {
+    cfg.rng = seed ? seed : 0x9E3779B9u;   // xorshift no admite estado 0
+}
+
+unsigned int simRandom(GameConfig& cfg) {
+    unsigned int x = cfg.rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    cfg.rng = x;
+    return x;
+}
+
+void initGameConfig(GameConfig& cfg, int numPlayers, int launchBalls) {
+    cfg.numPlayers = numPlayers;
+    cfg.rows = 4;
+    cfg.cols = 10;
+    cfg.gapX = 1;
+    cfg.gapY = 1;
+    cfg.brickH = 1;
+    cfg.level = 1;
+    cfg.launchBalls = launchBalls;
+    cfg.autoplay = false;
+    cfg.substeps = 1;
+    cfg.substep = 0;
+    cfg.balls.init(MAX_BALLS);
+    cfg.powerUps.init(MAX_POWERUPS);
+    cfg.shots.init(MAX_SHOTS);
+    cfg.freeBricks.init(MAX_FREE_BRICKS);
+    cfg.events.init();
+    for (int i = 0; i < MAX_PLAYERS; ++i) cfg.paddles[i].wideFrames = 0;
+    seedRandom(cfg, 1);
+}
+
+bool anyPaddleMoving(const GameConfig& cfg) {
+    for (int i = 0; i < cfg.numPlayers; ++i) {
+        if (cfg.paddles[i].desiredDir != 0) return true;
+    }
+    return false;
+}
+
+BrickLayout computeBrickLayout(const GameConfig& cfg) {
+    BrickLayout L;
+    int totalGaps = (cfg.cols - 1) * cfg.gapX;
+    int usableW   = cfg.w - 2;
+    int cols      = (cfg.cols > 0 ? cfg.cols : 1);
+    L.brickW    = std::max(1, (usableW - totalGaps) / cols);
+    L.remainder = std::max(0, (usableW - totalGaps) - (L.brickW * cols));
+    L.startY    = cfg.y0 + 2;
+    return L;
+}
+
+// Calcula la geometría del área de juego para una pantalla de screenRows x screenCols
+void setupPlayArea(GameConfig& cfg, int screenRows, int screenCols) {
+    setupPlayAreaRect(cfg, screenRows/2 - 12, screenCols/2 - 40,
+                      screenRows/2 + 12, screenCols/2 + 40);
+}
+
+// Geometría a partir del rectángulo del marco (bordes incluidos)
+void setupPlayAreaRect(GameConfig& cfg, int top, int left, int bottom, int right) {
+    cfg.top    = top;
+    cfg.bottom = bottom;
+    cfg.left   = left;
+    cfg.right  = right;
+
+    cfg.x0 = cfg.left + 1;
+    cfg.y0 = cfg.top + 1;
+    cfg.x1 = cfg.right - 1;
+    cfg.y1 = cfg.bottom - 1;
+    cfg.w  = cfg.x1 - cfg.x0 + 1;
+    cfg.h  = cfg.y1 - cfg.y0 + 1;
+}
+
+// Permite reiniciar el nivel
+void resetLevel(GameConfig& cfg) {
+    cfg.score = 0;
+    cfg.lives = 3;
+    cfg.paused = false;
+    cfg.running = true;
+    cfg.restartRequested = false;
+    cfg.won = false;
+    cfg.lost = false;
+
+    // Paletas: todas en la fila fija cerca del borde inferior, repartidas a lo
+    // ancho. Con un jugador la paleta queda en el primer cuarto, como en coop
+    cfg.numPlayers = std::max(1, std::min(cfg.numPlayers, MAX_PLAYERS));
+    const int n = cfg.numPlayers;
+    const int slots = std::max(n, 2);
+    const int padW = std::min(9, std::max(4, cfg.w / n - 3));
+    for (int i = 0; i < n; ++i) {
+        Paddle& p = cfg.paddles[i];
+        p.w = padW;
+        p.baseW = padW;
+        p.wideFrames = 0;
+        p.y = cfg.y1 - 2;
+        p.x = std::min(cfg.x0 + (cfg.w * (2 * i + 1)) / (2 * slots), cfg.x1 - padW);
+        p.desiredDir = 0;
+    }
+
+    // El índice de colisión se dimensiona una sola vez por partida
+    PaddleSweep& S = cfg.paddleSweep;
+    S.originX = cfg.x0;
+    S.stride = cfg.w;
+    if ((int)S.owner.size() != MAX_PLAYERS * S.stride) {
+        S.owner.assign(MAX_PLAYERS * S.stride, -1);
+    }
+
+    cfg.ballSpeed = 1.0f;  // Velocidad inicial normal
+    parkBallOnPaddle(cfg);
+    cfg.frameDrawn = false;
+    cfg.idleWake = true;   // Dibujar el nivel nuevo aunque arranque en reposo
+
+    int idx = (cfg.level >= 1 && cfg.level <= NUM_LEVELS) ? cfg.level - 1 : NUM_LEVELS - 1;
+    buildLevel(cfg, LEVELS[idx]);
+    syncDerivedState(cfg);
+    cfg.frameCounter = 0;
+    emit(cfg, EV_LEVEL_STARTED, 0, 0, cfg.level);
+    cfg.step = 0;
+    cfg.substeps = 1;
+    cfg.substep = 0;
+}
+
+// Lanza la bola que espera sobre la paleta y, en modo estrés, las adicionales
+// repartidas en abanico desde el mismo punto
+void simLaunch(GameConfig& cfg) {
+    if (cfg.ballLaunched || !cfg.running || cfg.balls.count == 0) return;
+
+    cfg.ballLaunched = true;
+    cfg.ballJustReset = false;
+    cfg.balls.vx[0] = (simRandom(cfg) % 2 == 0 ? -0.25f : 0.25f);
+    cfg.balls.vy[0] = -0.5f;
+
+    float px = cfg.balls.x[0], py = cfg.balls.y[0];
+    int extra = std::min(cfg.launchBalls, cfg.balls.capacity) - 1;
+    for (int k = 0; k < extra; ++k) {
+        float t = (extra > 1) ? (float)k / (extra - 1) : 0.5f;   // [0..1]
+        float vx = -0.6f + 1.2f * t;
+        float vy = -0.5f;
+        normalizeAngle(vx, vy);
+        cfg.balls.spawn(px, py, vx, vy);
+    }
+}
+
+// Jugadores de la etapa: constante si está especializada
+template <int Players>
+static inline int playerCount(const GameConfig& cfg) {
+    return Players != PLAYERS_ANY ? Players : cfg.numPlayers;
+}
+
+template <int Players>
+void simPaddlesT(GameConfig& cfg) {
+    if (cfg.paused) return;
+
+    const int PADDLE_SPEED = 2;
+    for (int i = 0; i < playerCount<Players>(cfg); ++i) {
+        Paddle& p = cfg.paddles[i];
+        int newX = p.x + p.desiredDir * PADDLE_SPEED;
+        int minX = cfg.x0 + 1;
+        int maxX = cfg.x1 - p.w;
+        if (newX < minX) newX = minX;
+        if (newX > maxX) newX = maxX;
+        p.x = newX;
+    }
+
+    // Si la bola no ha sido lanzada, mantenerla sobre la paleta 1
+    if (!cfg.ballLaunched && cfg.ballJustReset && cfg.balls.count > 0) {
+        const Paddle& p = cfg.paddles[0];
+        cfg.balls.x[0] = p.x + (p.w / 2.0f);
+        cfg.balls.y[0] = p.y - 1.0f;
+    }
+
+    // Ladrillos móviles: una vez por frame, antes de los subpasos
+    moveFreeBricks(cfg);
+}
+
+int computeSubsteps(const GameConfig& cfg) {
+    if (cfg.paused || !cfg.ballLaunched) return 1;
+
+    // Mayor avance en x o en y de una bola en el frame
+    const int n = cfg.balls.count;
+    const float* __restrict vx = cfg.balls.vx.data();
+    const float* __restrict vy = cfg.balls.vy.data();
+    float v = 0.0f;
+    for (int i = 0; i < n; ++i) {
+        v = std::max(v, std::max(std::fabs(vx[i]), std::fabs(vy[i])));
+    }
+    int k = (int)std::ceil(v * cfg.ballSpeed - 1e-4f);
+    return std::max(1, std::min(k, MAX_SUBSTEPS));
+}
+
+void simBeginSubsteps(GameConfig& cfg) {
+    cfg.substep = 0;
+    cfg.substeps = computeSubsteps(cfg);
+}
+
+bool simNextSubstep(GameConfig& cfg) {
+    return ++cfg.substep < cfg.substeps && cfg.running && cfg.ballLaunched;
+}
+
+// Integración de posiciones: un solo bucle sin ramas sobre arreglos contiguos,
+// que el compilador vectoriza. Cada subpaso avanza su parte del frame
+void simBalls(GameConfig& cfg) {
+    if (cfg.paused || !cfg.ballLaunched) return;
+
+    const int n = cfg.balls.count;
+    const float s = cfg.ballSpeed / std::max(1, cfg.substeps);
+    float* __restrict x  = cfg.balls.x.data();
+    float* __restrict y  = cfg.balls.y.data();
+    const float* __restrict vx = cfg.balls.vx.data();
+    const float* __restrict vy = cfg.balls.vy.data();
+
+    for (int i = 0; i < n; ++i) {
+        x[i] += vx[i] * s;
+        y[i] += vy[i] * s;
+    }
+}
+
+WallBounds computeWallBounds(const GameConfig& cfg) {
+    WallBounds W;
+    W.left = cfg.x0 + 1;
+    W.resetLeft = cfg.x0 + 2;
+    W.right = cfg.x1 - 1;
+    W.resetRight = cfg.x1 - 2;
+    W.ceiling = cfg.y0 + 2;
+    W.resetCeiling = cfg.y0 + 3;
+    W.ceilingBounce = W.ceiling - 0.5f;
+    return W;
+}
+
+// Un solo jugador: el índice es el intervalo de columnas de su paleta
+static void buildSingleSweep(GameConfig& cfg) {
+    PaddleSweep& S = cfg.paddleSweep;
+    const Paddle& p = cfg.paddles[0];
+    S.numRows = 1;
+    S.rowY[0] = p.y;
+    S.spanFrom = std::max(0, p.x - S.originX);
+    S.spanTo = std::min(S.stride, p.x + p.w - S.originX);
+}
+
+template <int Players>
+void simWallsPaddlesT(GameConfig& cfg) {
+    if (cfg.paused || !cfg.ballLaunched) return;
+
+    BallPool& b = cfg.balls;
+    if (Players == 1) buildSingleSweep(cfg);
+    else buildPaddleSweep(cfg);
+    const PaddleSweep& S = cfg.paddleSweep;
+    const WallBounds W = computeWallBounds(cfg);
+    const int floorY = cfg.paddles[0].y + 2;
+
+    // Se recorre de atrás hacia adelante: al eliminar una bola, la que ocupa
+    // su lugar ya fue procesada, así el orden es determinista
+    for (int i = b.count - 1; i >= 0; --i) {
+        // Paredes laterales (en coordenadas de pantalla)
+        if (b.x[i] <= W.left) {
+            b.x[i] = W.resetLeft;
+            b.vx[i] = -b.vx[i];
+            normalizeAngle(b.vx[i], b.vy[i]);
+        }
+        if (b.x[i] >= W.right) {
+            b.x[i] = W.resetRight;
+            b.vx[i] = -b.vx[i];
+            normalizeAngle(b.vx[i], b.vy[i]);
+        }
+
+        // Techo: rebota recién cuando la bola pasaría a la fila de arriba.
+        // La primera fila de ladrillos está en la del techo y los ladrillos
+        // usan la posición redondeada: con `y <= ceiling` la bola rebotaba
+        // antes de llegar a ellos según la fase de su avance
+        if (b.y[i] < W.ceilingBounce) {
+            b.y[i] = W.resetCeiling;
+            b.vy[i] = -b.vy[i];
+            normalizeAngle(b.vx[i], b.vy[i]);
+        }
+
+        // Piso: la bola se pierde
+        if (b.y[i] >= floorY) {
+            b.remove(i);
+            continue;
+        }
+
+        // Colisión con paletas: sólo se consultan las filas donde la bola
+        // puede tocar una paleta, y en ellas la columna indica cuál
+        int ballIntY = (int)std::round(b.y[i]);
+        int col = (int)std::round(b.x[i]) - S.originX;
+        if (col < 0 || col >= S.stride) continue;
+        for (int r = 0; r < S.numRows; ++r) {
+            if (ballIntY != S.rowY[r] - 1 && ballIntY != S.rowY[r]) continue;
+            int owner;
+            if (Players == 1) owner = (col >= S.spanFrom && col < S.spanTo) ? 0 : -1;
+            else owner = S.owner[r * S.stride + col];
+            if (owner < 0) continue;
+            const Paddle& p = cfg.paddles[owner];
+            float rel;
+            if (bouncePaddle(b.x[i], b.y[i], b.vx[i], b.vy[i], p.x, p.y, p.w, rel)) {
+                // Los golpes de paleta son sólo estadística: con miles de bolas
+                // no pueden ocupar el lugar de los eventos de ladrillos
+                if ((int)cfg.events.list.size() < MAX_FRAME_EVENTS / 2) {
+                    emit(cfg, EV_PADDLE_HIT, owner, 0, (int)std::lround(rel * 1000.0f));
+                }
+                break;
+            }
+        }
+    }
+
+    // Sin bolas en juego se pierde una vida
+    if (b.count == 0) {
+        cfg.lives--;
+        parkBallOnPaddle(cfg);
+        emit(cfg, EV_LIFE_LOST, 0, 0, std::max(0, cfg.lives));
+
+        if (cfg.lives <= 0) {
+            cfg.lost = true;
+            cfg.running = false;
+        }
+    }
+}
+
+// Colisiones con ladrillos. La celda de grilla de cada bola se calcula
+// directamente a partir de la geometría y los ladrillos libres se buscan sólo
+// en la celda del hash donde está la bola (costo constante por bola). Las
+// bolas se resuelven en orden de índice: si dos golpean el mismo ladrillo en
+// un frame, cada golpe quita un punto de vida y las que llegan después de que
+// se destruyó lo atraviesan sin rebotar.
+void simBricks(GameConfig& cfg) {
+    if (cfg.paused || !cfg.ballLaunched) return;
+    const bool grid = cfg.rows > 0 && cfg.cols > 0;
+    const bool anyFree = cfg.freeBricks.count > 0;
+    if (!grid && !anyFree) return;
+
+    const BrickLookup B(cfg);
+    BallPool& b = cfg.balls;
+    for (int i = 0; i < b.count; ++i) {
+        const int sx = (int)std::round(b.x[i]), sy = (int)std::round(b.y[i]);
+        int r, c, relX, thisW, k = -1;
+        bool onGrid = grid && B.cell(cfg, sx, sy, r, c, relX, thisW) && cfg.grid[r][c].hp > 0;
+        if (!onGrid) {
+            if (!anyFree || (k = cfg.freeBricks.find(sx, sy)) < 0) continue;
+            relX = sx - cfg.freeBricks.x[k];
+            thisW = cfg.freeBricks.w[k];
+        }
+
+        // Determinar si golpea a los lados o arriba/abajo
+        bool hitSide = (relX == 0 || relX == thisW - 1);
+        if (hitSide) {
+            b.vx[i] = -b.vx[i];
+        } else {
+            b.vy[i] = -b.vy[i];
+        }
+
+        // Reducir HP del ladrillo; si se destruyó, sumar puntos
+        if (onGrid) hitGridBrick(cfg, B, r, c);
+        else hitFreeBrick(cfg, k);
+    }
+}
+
+// Aplica a la paleta `owner` el power-up que atrapó
+static void applyPowerUp(GameConfig& cfg, int owner, int kind) {
+    const int WIDE_FRAMES = 400, LASER_FRAMES = 400;
+    if (kind == POWER_WIDE) {
+        Paddle& p = cfg.paddles[owner];
+        int newW = std::min(p.baseW + p.baseW / 2, cfg.w - 2);
+        p.x = std::max(cfg.x0 + 1, std::min(p.x - (newW - p.w) / 2, cfg.x1 - newW));
+        p.w = newW;
+        p.wideFrames = WIDE_FRAMES;
+    } else if (kind == POWER_MULTI) {
+        // Cada bola en juego suelta dos más, abiertas hacia los lados
+        BallPool& b = cfg.balls;
+        const int n = b.count;
+        for (int i = 0; i < n; ++i) {
+            for (int side = -1; side <= 1; side += 2) {
+                float vx = b.vx[i] + 0.35f * side, vy = b.vy[i];
+                normalizeAngle(vx, vy);
+                if (b.spawn(b.x[i], b.y[i], vx, vy) < 0) return;
+            }
+        }
+    } else if (kind == POWER_LASER) {
+        cfg.laserFrames = LASER_FRAMES;
+    }
+}
+
+template <int Players>
+void simEntitiesT(GameConfig& cfg) {
+    if (cfg.paused || !cfg.ballLaunched) return;
+
+    // Duración de los efectos
+    if (cfg.laserFrames > 0) cfg.laserFrames--;
+    if (cfg.laserCooldown > 0) cfg.laserCooldown--;
+    for (int i = 0; i < playerCount<Players>(cfg); ++i) {
+        Paddle& p = cfg.paddles[i];
+        if (p.wideFrames > 0 && --p.wideFrames == 0) {
+            p.w = p.baseW;
+            p.x = std::min(p.x, cfg.x1 - p.w);
+        }
+    }
+
+    // Integración en bloque de los dos pools (las muertas tienen vy = 0)
+    EntityPool* pools[2] = {&cfg.powerUps, &cfg.shots};
+    for (EntityPool* P : pools) {
+        const int n = P->high;
+        float* __restrict y = P->y.data();
+        const float* __restrict vy = P->vy.data();
+        for (int i = 0; i < n; ++i) y[i] += vy[i];
+    }
+
+    // Power-ups: los atrapa la paleta de su columna; si pasan el piso se pierden
+    EntityPool& U = cfg.powerUps;
+    const PaddleSweep& S = cfg.paddleSweep;
+    const int floorY = cfg.paddles[0].y + 2;
+    for (int i = 0; i < U.high; ++i) {
+        if (!U.alive[i]) continue;
+        if (U.y[i] >= floorY) { U.kill(i); continue; }
+
+        int uy = (int)std::round(U.y[i]);
+        int col = (int)std::round(U.x[i]) - S.originX;
+        if (col < 0 || col >= S.stride) continue;
+        for (int r = 0; r < S.numRows; ++r) {
+            if (uy != S.rowY[r] - 1 && uy != S.rowY[r]) continue;
+            int owner;
+            if (Players == 1) owner = (col >= S.spanFrom && col < S.spanTo) ? 0 : -1;
+            else owner = S.owner[r * S.stride + col];
+            if (owner < 0) continue;
+            int kind = U.kind[i];
+            U.kill(i);
+            applyPowerUp(cfg, owner, kind);
+            emit(cfg, EV_POWERUP_CAUGHT, owner, kind, 0);
+            break;
+        }
+    }
+
+    // Disparos: suben hasta el techo; cada uno quita un punto de vida al
+    // primer ladrillo que toca
+    EntityPool& Sh = cfg.shots;
+    if (Sh.live == 0) return;
+    const BrickLookup B(cfg);
+    for (int i = 0; i < Sh.high; ++i) {
+        if (!Sh.alive[i]) continue;
+        if (Sh.y[i] < cfg.y0 + 2) { Sh.kill(i); continue; }
+
+        const int sx = (int)std::round(Sh.x[i]), sy = (int)std::round(Sh.y[i]);
+        int r, c, relX, thisW, k;
+        if (B.cell(cfg, sx, sy, r, c, relX, thisW) && cfg.grid[r][c].hp > 0) {
+            Sh.kill(i);
+            hitGridBrick(cfg, B, r, c);
+        } else if ((k = cfg.freeBricks.find(sx, sy)) >= 0) {
+            Sh.kill(i);
+            hitFreeBrick(cfg, k);
+        }
+    }
+}
+
+void simFire(GameConfig& cfg) {
+    const int LASER_COOLDOWN = 4;
+    if (cfg.paused || !cfg.ballLaunched || cfg.laserFrames <= 0 || cfg.laserCooldown > 0) return;
+    for (int i = 0; i < cfg.numPlayers; ++i) {
+        const Paddle& p = cfg.paddles[i];
+        cfg.shots.spawn((float)p.x, p.y - 1.0f, -1.0f, 0);
+        cfg.shots.spawn((float)(p.x + p.w - 1), p.y - 1.0f, -1.0f, 0);
+    }
+    cfg.laserCooldown = LASER_COOLDOWN;
+}
+
+void simState(GameConfig& cfg) {
+    // Verificar victoria: el contador de ladrillos vivos baja con cada
+    // ladrillo destruido, así no hace falta recorrer la grilla
+    if (cfg.bricksAlive > 0) return;
+
+    emit(cfg, EV_LEVEL_CLEARED, 0, 0, cfg.level);
+    if (cfg.level >= 1 && cfg.level < NUM_LEVELS) {
+        cfg.restartRequested = true;
+        cfg.level++;
+    }
+    else {
+        cfg.won = true;
+        cfg.running = false;
+    }
+}
+
+// Limita y suaviza la velocidad hacia el objetivo, que se actualiza cuando
+// cambia el score
+void simSpeed(GameConfig& cfg) {
+    cfg.ballSpeed = std::max(0.5f, std::min(2.0f, cfg.ballSpeed));
+
+    // Pequeña auto-aceleración por score (nunca frena)
+    float target = std::max(cfg.ballSpeed, cfg.speedTarget);
+
+    // Lerp suave (interpolación lineal)
+    cfg.ballSpeed += 0.10f * (target - cfg.ballSpeed);
+}
+
+void syncDerivedState(GameConfig& cfg) {
+    int alive = 0;
+    for (int r = 0; r < cfg.rows; ++r) {
+        for (int c = 0; c < cfg.cols; ++c) {
+            if (cfg.grid[r][c].hp > 0) ++alive;
+        }
+    }
+    FreeBricks& F = cfg.freeBricks;
+    sizeFreeBricks(cfg);
+    F.rebuild();
+    for (int i = 0; i < F.count; ++i) {
+        if (F.brick[i].hp > 0) ++alive;
+    }
+    cfg.bricksAlive = alive;
+    cfg.speedTarget = speedTargetFor(cfg.score);
+}
+
+bool brickCellAt(const GameConfig& cfg, int sx, int sy, int& r, int& c) {
+    if (cfg.rows <= 0 || cfg.cols <= 0) return false;
+    int relX, thisW;
+    return BrickLookup(cfg).cell(cfg, sx, sy, r, c, relX, thisW);
+}
+
+int freeBrickAt(const GameConfig& cfg, int sx, int sy) {
+    return cfg.freeBricks.find(sx, sy);
+}
+
+void setFreeBricks(GameConfig& cfg, const FreeBrickDef* defs, int n) {
+    loadFreeBricks(cfg, defs, n);
+    syncDerivedState(cfg);
+}
+
+int levelCount() {
+    return NUM_LEVELS;
+}
+
+// Frame completo. Con Probed el observador ve cada subpaso; sin él las
+// llamadas no se compilan
+template <int Players, bool Probed>
+static void runFrame(GameConfig& cfg, SubstepHook hook, void* user) {
+    if (!cfg.running) return;
+    cfg.events.clear();
+    cfg.frameCounter++;
+    simPaddlesT<Players>(cfg);
+    simBeginSubsteps(cfg);
+    do {
+        if (Probed) hook(cfg, SUB_BEFORE_BALLS, user);
+        simBalls(cfg);
+        if (Probed) hook(cfg, SUB_AFTER_BALLS, user);
+        simWallsPaddlesT<Players>(cfg);
+        // Con la última vida perdida el pipeline del juego cierra el frame aquí
+        if (!cfg.running) return;
+        if (Probed) hook(cfg, SUB_AFTER_WALLS, user);
+        simBricks(cfg);
+    } while (simNextSubstep(cfg));
+    simEntitiesT<Players>(cfg);
+    simState(cfg);
+    if (cfg.frameCounter % 6 == 0) simSpeed(cfg);   // cada ~6 frames
+}
+
+template <int Players>
+void simFrameT(GameConfig& cfg) {
+    runFrame<Players, false>(cfg, nullptr, nullptr);
+}
+
+template void simPaddlesT<1>(GameConfig&);
+template void simPaddlesT<PLAYERS_ANY>(GameConfig&);
+template void simWallsPaddlesT<1>(GameConfig&);
+template void simWallsPaddlesT<PLAYERS_ANY>(GameConfig&);
+template void simEntitiesT<1>(GameConfig&);
+template void simEntitiesT<PLAYERS_ANY>(GameConfig&);
+template void simFrameT<1>(GameConfig&);
+template void simFrameT<PLAYERS_ANY>(GameConfig&);
+
+// Etapas para el modo de la partida (una rama por etapa, no por bola)
+void simPaddles(GameConfig& cfg) {
+    if (cfg.numPlayers == 1) simPaddlesT<1>(cfg);
+    else simPaddlesT<PLAYERS_ANY>(cfg);
+}
+
+void simWallsPaddles(GameConfig& cfg) {
+    if (cfg.numPlayers == 1) simWallsPaddlesT<1>(cfg);
+    else simWallsPaddlesT<PLAYERS_ANY>(cfg);
+}
+
+void simEntities(GameConfig& cfg) {
+    if (cfg.numPlayers == 1) simEntitiesT<1>(cfg);
+    else simEntitiesT<PLAYERS_ANY>(cfg);
+}
+
+void simFrame(GameConfig& cfg) {
+    if (cfg.numPlayers == 1) simFrameT<1>(cfg);
+    else simFrameT<PLAYERS_ANY>(cfg);
+}
+
+void simFrameProbed(GameConfig& cfg, SubstepHook hook, void* user) {
+    if (cfg.numPlayers == 1) runFrame<1, true>(cfg, hook, user);
+    else runFrame<PLAYERS_ANY, true>(cfg, hook, user);
+}
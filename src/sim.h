@@ -0,0 +1,444 @@
+/*
+sim.h - Estado y simulación del juego, separados de los hilos y de ncurses.
+Cada función implementa una etapa del frame sobre un GameConfig sin tomar locks
+ni dibujar nada: los hilos la llaman con el mutex del tablero tomado y las
+herramientas sin terminal (benchmark, entorno de RL) la llaman directamente.
+*/
+#ifndef SIM_H
+#define SIM_H
+
+#include "events.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+
+// Estructura de un ladrillo
+struct Brick {
+    int hp;      // Puntos de vida
+    char ch;     // Carácter visual
+    int points;  // Puntos que otorga
+};
+
+// Recorrido de un ladrillo libre
+enum BrickPath : unsigned char {
+    PATH_STILL,   // Quieto
+    PATH_LINE,    // Va y vuelve en línea recta entre su base y base + (dx, dy)
+    PATH_ORBIT    // Gira alrededor de su base con radios dx, dy
+};
+
+// Ladrillo libre: posición y ancho arbitrarios, fuera de la grilla. x e y son
+// relativos al primer ladrillo de la grilla (columna x0 + 1, fila y0 + 2) en
+// un área de FREE_REF_W columnas útiles; en áreas de otro ancho se escalan
+// las columnas (x, w y dx). Miden una fila de alto
+const int FREE_REF_W = 78;
+struct FreeBrickDef {
+    float x, y;
+    int w;
+    Brick brick;
+    BrickPath path = PATH_STILL;
+    float dx = 0, dy = 0;
+    int period = 0;   // Frames por vuelta del recorrido
+    int phase = 0;    // Frame de la vuelta en que empieza
+};
+
+// Índice espacial de los ladrillos libres: hash uniforme de celdas de
+// FREE_CELL_W x FREE_CELL_H sobre la zona de ladrillos. Un ladrillo ocupa a lo
+// sumo FREE_SPAN celdas (de ahí el ancho máximo)
+const int MAX_FREE_BRICKS = 1024;
+const int FREE_CELL_W = 8;
+const int FREE_CELL_H = 2;
+const int FREE_SPAN = 4;
+const int FREE_MAX_W = FREE_CELL_W * (FREE_SPAN - 1) + 1;
+
+// Ladrillos libres del nivel en formato "structure of arrays". La definición
+// (base, recorrido) no cambia durante el nivel; la posición se deriva de
+// `tick`, así un snapshot sólo necesita el tick y los HP.
+// Cada ladrillo vivo está enlazado en las celdas del hash que ocupa con
+// listas doblemente enlazadas de nodos fijos (nodo = ladrillo * FREE_SPAN + k):
+// moverlo de celda cuesta O(1) y nunca reserva memoria. Los vectores se
+// reservan una sola vez por partida y miden `count`: las copias (snapshot de
+// render) reservan la misma capacidad la primera vez y después sólo copian
+// los ladrillos del nivel
+struct FreeBricks {
+    std::vector<float> baseX, baseY, dx, dy;   // En celdas de pantalla
+    std::vector<short> w;
+    std::vector<unsigned char> path;
+    std::vector<int> period, phase;
+    std::vector<Brick> brick;
+    std::vector<short> x, y;                   // Posición actual
+    std::vector<short> cellX0, cellX1, cellY;  // Celdas enlazadas (cellY < 0: ninguna)
+    std::vector<int> next, prev;               // Nodos del hash
+    std::vector<int> head;                     // Primer nodo de cada celda (-1 = vacía)
+    int count = 0;
+    int moving = 0;          // Ladrillos con recorrido
+    unsigned tick = 0;       // Frames que se movieron en el nivel
+    int minX = 0, maxX = 0, minY = 0, maxY = 0;   // Zona donde pueden estar
+    int hashCols = 0, hashRows = 0;
+    int capacity = 0;
+
+    FreeBricks() = default;
+    FreeBricks(const FreeBricks& o) { *this = o; }
+    FreeBricks& operator=(const FreeBricks& o);
+
+    void init(int cap);      // Reserva la memoria (sólo al iniciar la partida)
+    void resize(int n);      // Hasta la capacidad reservada
+    void clear() { resize(0); }
+    void setBounds(int left, int right, int top, int bottom);
+
+    void link(int i);
+    void unlink(int i);
+    void place(int i);       // Posición según tick; reenlaza sólo si cambió de celdas
+    void rebuild();          // Posiciones y hash desde cero (tras restaurar)
+
+    // Ladrillo vivo en la celda de pantalla (sx, sy); -1 si no hay. Si se
+    // solapan, el de menor índice (no depende del orden de las listas)
+    int find(int sx, int sy) const;
+};
+
+// Capacidad máxima del pool de bolas (se reserva una sola vez por partida)
+const int MAX_BALLS = 4096;
+
+// Velocidad mínima de una bola en cada eje después de un rebote (evita que
+// quede rebotando de lado a lado sin bajar)
+const float BALL_MIN_VX = 0.15f;
+const float BALL_MIN_VY = 0.25f;
+
+// Pool de bolas en formato "structure of arrays": cada componente vive en su
+// propio arreglo contiguo para que la integración se pueda vectorizar.
+// Las bolas vivas ocupan [0, count); eliminar mueve la última al hueco.
+struct BallPool {
+    std::vector<float> x, y;
+    std::vector<float> vx, vy;
+    int count = 0;
+    int capacity = 0;
+
+    // Reserva la memoria del pool (sólo al iniciar la partida)
+    void init(int cap) {
+        x.assign(cap, 0.0f); y.assign(cap, 0.0f);
+        vx.assign(cap, 0.0f); vy.assign(cap, 0.0f);
+        capacity = cap;
+        count = 0;
+    }
+
+    // Agrega una bola; devuelve su índice o -1 si el pool está lleno
+    int spawn(float px, float py, float pvx, float pvy) {
+        if (count >= capacity) return -1;
+        x[count] = px; y[count] = py;
+        vx[count] = pvx; vy[count] = pvy;
+        return count++;
+    }
+
+    void remove(int i) {
+        --count;
+        x[i] = x[count]; y[i] = y[count];
+        vx[i] = vx[count]; vy[i] = vy[count];
+    }
+
+    void clear() { count = 0; }
+
+    BallPool() = default;
+    BallPool(const BallPool&) = default;
+
+    // Copiar un pool a otro de la misma capacidad (snapshot de render) no
+    // reserva memoria y sólo copia las bolas vivas
+    BallPool& operator=(const BallPool& o) {
+        if (this == &o) return *this;
+        if (capacity != o.capacity) {
+            x = o.x; y = o.y;
+            vx = o.vx; vy = o.vy;
+            capacity = o.capacity;
+        } else {
+            std::copy_n(o.x.data(), o.count, x.data());
+            std::copy_n(o.y.data(), o.count, y.data());
+            std::copy_n(o.vx.data(), o.count, vx.data());
+            std::copy_n(o.vy.data(), o.count, vy.data());
+        }
+        count = o.count;
+        return *this;
+    }
+};
+
+// Tipos de power-up que sueltan los ladrillos destruidos
+enum PowerUpKind {
+    POWER_WIDE,     // Paleta más ancha por un tiempo
+    POWER_MULTI,    // Cada bola en juego se divide en tres
+    POWER_LASER,    // La paleta dispara con ESPACIO por un tiempo
+    POWER_COUNT
+};
+
+// Capacidad de los pools de entidades (se reservan una sola vez por partida)
+const int MAX_POWERUPS = 256;
+const int MAX_SHOTS = 512;
+
+// Pool de entidades de capacidad fija (power-ups que caen, disparos).
+// Formato "structure of arrays" con una lista libre: los huecos se reutilizan
+// y las entidades vivas quedan dentro de [0, high), que se recorre de corrido.
+// Las entidades muertas tienen vy = 0, así la integración no necesita ramas
+struct EntityPool {
+    std::vector<float> x, y, vy;
+    std::vector<unsigned char> kind;
+    std::vector<unsigned char> alive;
+    std::vector<int> freeList;     // Huecos libres dentro de [0, high)
+    int freeCount = 0;
+    int high = 0;                  // Índices usados alguna vez desde que se vació
+    int live = 0;
+    int capacity = 0;
+
+    // Reserva la memoria del pool (sólo al iniciar la partida)
+    void init(int cap) {
+        x.assign(cap, 0.0f); y.assign(cap, 0.0f); vy.assign(cap, 0.0f);
+        kind.assign(cap, 0);
+        alive.assign(cap, 0);
+        freeList.assign(cap, 0);
+        capacity = cap;
+        clear();
+    }
+
+    // Agrega una entidad; devuelve su índice o -1 si el pool está lleno
+    int spawn(float px, float py, float pvy, int k) {
+        int i;
+        if (freeCount > 0) i = freeList[--freeCount];
+        else if (high < capacity) i = high++;
+        else return -1;
+        x[i] = px; y[i] = py; vy[i] = pvy;
+        kind[i] = (unsigned char)k;
+        alive[i] = 1;
+        ++live;
+        return i;
+    }
+
+    void kill(int i) {
+        alive[i] = 0;
+        vy[i] = 0.0f;
+        // Al vaciarse el pool, el rango a recorrer vuelve a cero
+        if (--live == 0) { high = 0; freeCount = 0; return; }
+        freeList[freeCount++] = i;
+    }
+
+    void clear() {
+        std::fill(alive.begin(), alive.begin() + high, (unsigned char)0);
+        std::fill(vy.begin(), vy.begin() + high, 0.0f);
+        high = 0; freeCount = 0; live = 0;
+    }
+};
+
+// Máximo de jugadores locales (una paleta por jugador)
+const int MAX_PLAYERS = 8;
+
+// Paleta de un jugador
+struct Paddle {
+    int x, y, w;
+    int desiredDir;   // -1 izquierda, 0 quieta, +1 derecha
+    int baseW;        // Ancho normal (sin power-up)
+    int wideFrames;   // Frames que le quedan al power-up de paleta ancha
+};
+
+// Índice de colisión paleta-bola: por cada fila con paletas, qué paleta ocupa
+// cada columna de pantalla (-1 = ninguna). Se arma con un barrido de los
+// intervalos ordenados por x y permite resolver cada bola en tiempo constante.
+// Con un solo jugador no se llena owner: basta el intervalo de la paleta
+struct PaddleSweep {
+    int numRows = 0;
+    int rowY[MAX_PLAYERS];
+    int spanFrom = 0, spanTo = 0;  // Un jugador: columnas [from, to) relativas a originX
+    int order[MAX_PLAYERS];        // Paletas ordenadas por (y, x)
+    int originX = 0;               // Columna de pantalla de owner[.][0]
+    int stride = 0;                // Columnas por fila
+    std::vector<signed char> owner;
+};
+
+// Estado general del juego, agrupado por quién lo escribe. Cada bloque empieza
+// en su propia línea de caché: lo que se escribe en cada frame no comparte
+// línea con la disposición del nivel (que las etapas sólo leen) ni con lo que
+// escribe otra etapa. El tamaño total queda redondeado a líneas enteras, así
+// dos GameConfig contiguos (tableros de versus, entornos de RL) simulados por
+// hilos distintos tampoco comparten ninguna
+struct GameConfig {
+    /* DISPOSICIÓN: se fija al armar el nivel; durante el frame sólo se lee */
+
+    // Área jugable
+    int top, left, bottom, right;
+    int x0, y0, x1, y1, w, h;
+
+    int numPlayers;
+    int launchBalls;      // Bolas que salen en cada lanzamiento (modo estrés > 1)
+    int rows, cols, gapX, gapY, brickH;   // Grilla de ladrillos
+    int tick_ms;
+    bool autoplay;        // Un autopiloto controla la partida (nunca queda en reposo)
+
+    /* CONTROL DEL PIPELINE: el testigo que se pasan las etapas */
+
+    alignas(CACHE_LINE) int step;
+    bool running;
+    bool paused;
+    unsigned long frameCounter;
+
+    // Subpasos de la física en el frame en curso: bolas, paredes/paletas y
+    // ladrillos se repiten `substeps` veces con la velocidad dividida
+    int substeps;
+    int substep;
+
+    /* PALETAS: etapa de paletas (la dirección la fija la entrada antes del
+       frame) y el índice de colisión que arma la de paredes/paletas */
+
+    alignas(CACHE_LINE) Paddle paddles[MAX_PLAYERS];   // La 0 es la del jugador 1
+    PaddleSweep paddleSweep;
+
+    /* BOLAS: etapas de bolas y de paredes/paletas */
+
+    alignas(CACHE_LINE) BallPool balls;
+    float ballSpeed;      // Multiplicador de velocidad
+    bool ballLaunched;
+    bool ballJustReset;
+    int lives;
+
+    /* LADRILLOS: etapa de ladrillos (y el puntaje que otorgan) */
+
+    alignas(CACHE_LINE) std::vector<std::vector<Brick>> grid;
+    FreeBricks freeBricks;   // Fuera de la grilla (niveles libres y móviles)
+    int bricksAlive;      // Ladrillos con HP > 0 (grilla y libres)
+    int score;
+    float speedTarget;    // Velocidad hacia la que tiende (según el score)
+    unsigned int rng;     // Estado del generador aleatorio de la partida
+
+    /* POWER-UPS Y DISPAROS: etapa de entidades */
+
+    alignas(CACHE_LINE) EntityPool powerUps;
+    EntityPool shots;
+    int laserFrames;      // Frames que le quedan al láser
+    int laserCooldown;    // Frames hasta el próximo disparo
+
+    /* ESTADO DE LA PARTIDA: etapa de estado y bucle de control */
+
+    alignas(CACHE_LINE) int level;
+    bool restartRequested;
+    bool won;
+    bool lost;
+    bool frameDrawn;
+    bool idleWake;       // Fuerza un frame aunque el juego esté en reposo
+
+    // Eventos del frame en curso (los publica quien cierra el frame)
+    FrameEvents events;
+};
+
+static_assert(alignof(GameConfig) == CACHE_LINE && sizeof(GameConfig) % CACHE_LINE == 0,
+              "GameConfig tiene que ocupar líneas de caché enteras");
+
+
+// Geometría de los ladrillos derivada de GameConfig
+struct BrickLayout {
+    int brickW;     // Ancho base de cada ladrillo
+    int remainder;  // Las primeras `remainder` columnas miden brickW + 1
+    int startY;     // Fila de pantalla del primer ladrillo
+};
+
+BrickLayout computeBrickLayout(const GameConfig& cfg);
+
+// Ladrillo (fila, columna de la grilla) que ocupa la celda de pantalla
+// (sx, sy); false si ahí no hay ninguno, vivo o no
+bool brickCellAt(const GameConfig& cfg, int sx, int sy, int& r, int& c);
+
+// Ladrillo libre vivo en la celda de pantalla (sx, sy); -1 si no hay
+int freeBrickAt(const GameConfig& cfg, int sx, int sy);
+
+// Reemplaza los ladrillos libres del nivel en curso (para herramientas:
+// campos de ladrillos armados a mano). Los que no caben en el pool se ignoran
+void setFreeBricks(GameConfig& cfg, const FreeBrickDef* defs, int n);
+
+// Cantidad de niveles incluidos
+int levelCount();
+
+// Límites de rebote de las bolas (paredes laterales y techo), compartidos por
+// las colisiones y por quien necesite predecir trayectorias
+struct WallBounds {
+    float left, right;    // Rebota al llegar a estas columnas...
+    float resetLeft, resetRight;   // ...y queda en éstas
+    float ceiling, resetCeiling;
+    // Altura por debajo de la cual rebota en el techo: la primera fila de
+    // ladrillos está en la del techo, así la bola llega a ella con cualquier
+    // fase de su avance antes de rebotar
+    float ceilingBounce;
+};
+
+WallBounds computeWallBounds(const GameConfig& cfg);
+
+// Preparación de la partida
+void setupPlayArea(GameConfig& cfg, int screenRows, int screenCols);
+void setupPlayAreaRect(GameConfig& cfg, int top, int left, int bottom, int right);
+void resetLevel(GameConfig& cfg);
+
+// Etapas del frame, en el orden del pipeline
+void simPaddles(GameConfig& cfg);       // step 0 (también mueve los ladrillos libres)
+void simBalls(GameConfig& cfg);         // step 1
+void simWallsPaddles(GameConfig& cfg);  // step 2
+void simBricks(GameConfig& cfg);        // step 3
+void simState(GameConfig& cfg);         // step 4
+
+// Subpasos: al empezar la física del frame (después de simPaddles) se elige
+// la menor cantidad que deja el avance de cada bola por subpaso en una celda
+// o menos. Después de simBricks, simNextSubstep indica si hay que volver a
+// simBalls; power-ups, estado y velocidad van una sola vez por frame
+const int MAX_SUBSTEPS = 4;
+int computeSubsteps(const GameConfig& cfg);
+void simBeginSubsteps(GameConfig& cfg);
+bool simNextSubstep(GameConfig& cfg);
+
+// Power-ups y disparos: movimiento, captura con las paletas, impactos en
+// ladrillos y duración de los efectos (step 3, después de simBricks)
+void simEntities(GameConfig& cfg);
+
+// Dispara el láser desde cada paleta si está activo
+void simFire(GameConfig& cfg);
+
+// Indica si algún jugador está moviendo su paleta
+bool anyPaddleMoving(const GameConfig& cfg);
+
+// Control de velocidad (se llama cada ~6 frames)
+void simSpeed(GameConfig& cfg);
+
+// Recalcula lo que se deriva de los ladrillos y el score (ladrillos vivos,
+// posición de los libres y su hash, velocidad objetivo), por ejemplo después
+// de restaurar un snapshot
+void syncDerivedState(GameConfig& cfg);
+
+// Generador aleatorio propio de cada partida (xorshift32), para que una
+// partida sea reproducible a partir de su semilla
+void seedRandom(GameConfig& cfg, unsigned int seed);
+unsigned int simRandom(GameConfig& cfg);
+
+// Valores por defecto de una partida nueva (sin geometría)
+void initGameConfig(GameConfig& cfg, int numPlayers, int launchBalls);
+
+// Lanza las bolas que esperan sobre la paleta
+void simLaunch(GameConfig& cfg);
+
+// Ejecuta un frame completo (todas las etapas en orden)
+void simFrame(GameConfig& cfg);
+
+// Igual que simFrame, pero llama a `hook` en cada subpaso: antes y después de
+// mover las bolas y después de paredes/paletas (antes de los ladrillos). Para
+// herramientas que verifican la física (tools/fuzz.cpp)
+enum SubstepPoint { SUB_BEFORE_BALLS, SUB_AFTER_BALLS, SUB_AFTER_WALLS };
+typedef void (*SubstepHook)(const GameConfig& cfg, SubstepPoint at, void* user);
+void simFrameProbed(GameConfig& cfg, SubstepHook hook, void* user);
+
+// Etapas especializadas en tiempo de compilación según la cantidad de
+// jugadores. Con Players = 1 no se arma el índice de paletas ni hay bucles por
+// jugador; con PLAYERS_ANY se usa cfg.numPlayers. Las versiones sin plantilla
+// eligen una u otra según cfg.numPlayers (el resultado es el mismo)
+const int PLAYERS_ANY = 0;
+template <int Players> void simPaddlesT(GameConfig& cfg);
+template <int Players> void simWallsPaddlesT(GameConfig& cfg);
+template <int Players> void simEntitiesT(GameConfig& cfg);
+template <int Players> void simFrameT(GameConfig& cfg);
+
+extern template void simPaddlesT<1>(GameConfig&);
+extern template void simPaddlesT<PLAYERS_ANY>(GameConfig&);
+extern template void simWallsPaddlesT<1>(GameConfig&);
+extern template void simWallsPaddlesT<PLAYERS_ANY>(GameConfig&);
+extern template void simEntitiesT<1>(GameConfig&);
+extern template void simEntitiesT<PLAYERS_ANY>(GameConfig&);
+extern template void simFrameT<1>(GameConfig&);
+extern template void simFrameT<PLAYERS_ANY>(GameConfig&);
+
+#endif // SIM_H
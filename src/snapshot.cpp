@@ -0,0 +1,461 @@
+#include "snapshot.h"
+#include <algorithm>
+#include <cstring>
+
+/*
+FORMATO BINARIO
+
+Parte dinámica (siempre):
+    u32 magic | u8 tipo | u64 frame | i32 score, lives, level | f32 ballSpeed
+    u32 rng | u8 flags | u8 numPlayers
+    numPlayers x (i16 x, y, w; i8 dir; i16 baseW; u16 wideFrames)
+    u16 rows, cols | u32 tick de los ladrillos libres
+    u32 bolas | f32 x[n], y[n], vx[n], vy[n]
+    u16 laserFrames, laserCooldown
+    power-ups y disparos: u16 high, live, libres | u16 libres[] |
+                          high x (u8 viva [, f32 x, y, vy; u8 tipo])
+Parte de ladrillos:
+    completo: rows*cols x (u8 hp, i8 ch, i16 points)
+              u16 libres | libres x (f32 baseX, baseY, dx, dy; i16 w; u8 hp;
+                                     i8 ch; i16 points; u8 recorrido; u16 period, phase)
+    delta:    u32 cambios | cambios x (u16 índice, u8 hp)
+              (los índices desde rows*cols son ladrillos libres)
+*/
+
+static const uint32_t SNAP_MAGIC = 0x33534B42;   // "BKS3"
+static const uint8_t SNAP_FULL = 1;
+static const uint8_t SNAP_DELTA = 2;
+
+// Escritura secuencial con control de límites (sin reservar memoria)
+struct ByteWriter {
+    uint8_t* p;
+    uint8_t* end;
+    bool ok = true;
+
+    void put(const void* src, size_t n) {
+        if (!ok || (size_t)(end - p) < n) { ok = false; return; }
+        std::memcpy(p, src, n);
+        p += n;
+    }
+    template <typename T> void put(T v) { put(&v, sizeof(T)); }
+};
+
+struct ByteReader {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok = true;
+
+    void get(void* dst, size_t n) {
+        if (!ok || (size_t)(end - p) < n) { ok = false; return; }
+        std::memcpy(dst, p, n);
+        p += n;
+    }
+    template <typename T> T get() { T v{}; get(&v, sizeof(T)); return v; }
+};
+
+static uint8_t packFlags(const GameConfig& cfg) {
+    return (uint8_t)((cfg.paused ? 1 : 0) | (cfg.running ? 2 : 0) | (cfg.won ? 4 : 0) |
+                     (cfg.lost ? 8 : 0) | (cfg.restartRequested ? 16 : 0) |
+                     (cfg.ballLaunched ? 32 : 0) | (cfg.ballJustReset ? 64 : 0));
+}
+
+// Pool de entidades: también se guarda la lista libre, para que los índices
+// que se asignen después de restaurar sean los mismos
+static void writePool(ByteWriter& w, const EntityPool& P) {
+    w.put((uint16_t)P.high);
+    w.put((uint16_t)P.live);
+    w.put((uint16_t)P.freeCount);
+    for (int i = 0; i < P.freeCount; ++i) w.put((uint16_t)P.freeList[i]);
+    for (int i = 0; i < P.high; ++i) {
+        w.put(P.alive[i]);
+        if (!P.alive[i]) continue;
+        w.put(P.x[i]);
+        w.put(P.y[i]);
+        w.put(P.vy[i]);
+        w.put(P.kind[i]);
+    }
+}
+
+static bool readPool(ByteReader& rd, EntityPool& P) {
+    int high = rd.get<uint16_t>();
+    int live = rd.get<uint16_t>();
+    int freeCount = rd.get<uint16_t>();
+    if (!rd.ok || high > P.capacity || live > high || freeCount > high) return false;
+
+    P.clear();
+    for (int i = 0; i < freeCount; ++i) {
+        int f = rd.get<uint16_t>();
+        if (f >= high) return false;
+        P.freeList[i] = f;
+    }
+    for (int i = 0; i < high; ++i) {
+        P.alive[i] = rd.get<unsigned char>();
+        if (!P.alive[i]) continue;
+        P.x[i] = rd.get<float>();
+        P.y[i] = rd.get<float>();
+        P.vy[i] = rd.get<float>();
+        P.kind[i] = rd.get<unsigned char>();
+    }
+    P.high = high;
+    P.live = live;
+    P.freeCount = freeCount;
+    return rd.ok;
+}
+
+static void writeDynamic(ByteWriter& w, const GameConfig& cfg, uint8_t type) {
+    w.put(SNAP_MAGIC);
+    w.put(type);
+    w.put((uint64_t)cfg.frameCounter);
+    w.put((int32_t)cfg.score);
+    w.put((int32_t)cfg.lives);
+    w.put((int32_t)cfg.level);
+    w.put(cfg.ballSpeed);
+    w.put((uint32_t)cfg.rng);
+    w.put(packFlags(cfg));
+    w.put((uint8_t)cfg.numPlayers);
+    for (int p = 0; p < cfg.numPlayers; ++p) {
+        const Paddle& pad = cfg.paddles[p];
+        w.put((int16_t)pad.x);
+        w.put((int16_t)pad.y);
+        w.put((int16_t)pad.w);
+        w.put((int8_t)pad.desiredDir);
+        w.put((int16_t)pad.baseW);
+        w.put((uint16_t)pad.wideFrames);
+    }
+    w.put((uint16_t)cfg.rows);
+    w.put((uint16_t)cfg.cols);
+    w.put((uint32_t)cfg.freeBricks.tick);
+
+    uint32_t n = (uint32_t)cfg.balls.count;
+    w.put(n);
+    w.put(cfg.balls.x.data(), n * sizeof(float));
+    w.put(cfg.balls.y.data(), n * sizeof(float));
+    w.put(cfg.balls.vx.data(), n * sizeof(float));
+    w.put(cfg.balls.vy.data(), n * sizeof(float));
+
+    w.put((uint16_t)cfg.laserFrames);
+    w.put((uint16_t)cfg.laserCooldown);
+    writePool(w, cfg.powerUps);
+    writePool(w, cfg.shots);
+}
+
+static void writeFullGrid(ByteWriter& w, const GameConfig& cfg) {
+    for (int r = 0; r < cfg.rows; ++r) {
+        for (int c = 0; c < cfg.cols; ++c) {
+            const Brick& b = cfg.grid[r][c];
+            w.put((uint8_t)(b.hp < 0 ? 0 : b.hp));
+            w.put((int8_t)b.ch);
+            w.put((int16_t)b.points);
+        }
+    }
+    const FreeBricks& F = cfg.freeBricks;
+    w.put((uint16_t)F.count);
+    for (int i = 0; i < F.count; ++i) {
+        w.put(F.baseX[i]);
+        w.put(F.baseY[i]);
+        w.put(F.dx[i]);
+        w.put(F.dy[i]);
+        w.put((int16_t)F.w[i]);
+        w.put((uint8_t)(F.brick[i].hp < 0 ? 0 : F.brick[i].hp));
+        w.put((int8_t)F.brick[i].ch);
+        w.put((int16_t)F.brick[i].points);
+        w.put((uint8_t)F.path[i]);
+        w.put((uint16_t)F.period[i]);
+        w.put((uint16_t)F.phase[i]);
+    }
+}
+
+// Ladrillos de la grilla seguidos de los libres, como una sola lista de HP
+// para los deltas
+static int brickCells(const GameConfig& cfg) {
+    return cfg.rows * cfg.cols + cfg.freeBricks.count;
+}
+
+static int cellHp(const GameConfig& cfg, int i) {
+    int grid = cfg.rows * cfg.cols;
+    int hp = i < grid ? cfg.grid[i / cfg.cols][i % cfg.cols].hp : cfg.freeBricks.brick[i - grid].hp;
+    return hp < 0 ? 0 : hp;
+}
+
+static void setCellHp(GameConfig& cfg, int i, int hp) {
+    int grid = cfg.rows * cfg.cols;
+    if (i < grid) cfg.grid[i / cfg.cols][i % cfg.cols].hp = hp;
+    else cfg.freeBricks.brick[i - grid].hp = hp;
+}
+
+// Lee la parte dinámica; devuelve el tipo de registro o 0 si es inválida
+static uint8_t readDynamic(ByteReader& rd, GameConfig& cfg) {
+    if (rd.get<uint32_t>() != SNAP_MAGIC) return 0;
+    uint8_t type = rd.get<uint8_t>();
+    uint64_t frame = rd.get<uint64_t>();
+    int32_t score = rd.get<int32_t>();
+    int32_t lives = rd.get<int32_t>();
+    int32_t level = rd.get<int32_t>();
+    float speed = rd.get<float>();
+    uint32_t rng = rd.get<uint32_t>();
+    uint8_t flags = rd.get<uint8_t>();
+    int numPlayers = rd.get<uint8_t>();
+    if (!rd.ok || numPlayers < 1 || numPlayers > MAX_PLAYERS) return 0;
+
+    Paddle pads[MAX_PLAYERS];
+    for (int p = 0; p < numPlayers; ++p) {
+        pads[p].x = rd.get<int16_t>();
+        pads[p].y = rd.get<int16_t>();
+        pads[p].w = rd.get<int16_t>();
+        pads[p].desiredDir = rd.get<int8_t>();
+        pads[p].baseW = rd.get<int16_t>();
+        pads[p].wideFrames = rd.get<uint16_t>();
+    }
+    int rows = rd.get<uint16_t>();
+    int cols = rd.get<uint16_t>();
+    uint32_t freeTick = rd.get<uint32_t>();
+    uint32_t n = rd.get<uint32_t>();
+    if (!rd.ok || (int)n > cfg.balls.capacity) return 0;
+    if ((size_t)(rd.end - rd.p) < 4 * n * sizeof(float)) return 0;
+
+    rd.get(cfg.balls.x.data(), n * sizeof(float));
+    rd.get(cfg.balls.y.data(), n * sizeof(float));
+    rd.get(cfg.balls.vx.data(), n * sizeof(float));
+    rd.get(cfg.balls.vy.data(), n * sizeof(float));
+    cfg.balls.count = (int)n;
+
+    cfg.laserFrames = rd.get<uint16_t>();
+    cfg.laserCooldown = rd.get<uint16_t>();
+    if (!readPool(rd, cfg.powerUps) || !readPool(rd, cfg.shots)) return 0;
+
+    cfg.frameCounter = (unsigned long)frame;
+    cfg.freeBricks.tick = freeTick;
+    cfg.score = score;
+    cfg.lives = lives;
+    cfg.level = level;
+    cfg.ballSpeed = speed;
+    cfg.rng = rng;
+    cfg.paused = flags & 1;
+    cfg.running = flags & 2;
+    cfg.won = flags & 4;
+    cfg.lost = flags & 8;
+    cfg.restartRequested = flags & 16;
+    cfg.ballLaunched = flags & 32;
+    cfg.ballJustReset = flags & 64;
+    cfg.numPlayers = numPlayers;
+    for (int p = 0; p < numPlayers; ++p) cfg.paddles[p] = pads[p];
+
+    // La grilla sólo se redimensiona si el snapshot viene de otra geometría
+    if (rows != cfg.rows || cols != cfg.cols) {
+        cfg.rows = rows;
+        cfg.cols = cols;
+        cfg.grid.assign(rows, std::vector<Brick>(cols));
+    }
+
+    cfg.idleWake = true;
+    return type;
+}
+
+static bool readFullGrid(ByteReader& rd, GameConfig& cfg) {
+    for (int r = 0; r < cfg.rows; ++r) {
+        for (int c = 0; c < cfg.cols; ++c) {
+            Brick& b = cfg.grid[r][c];
+            b.hp = rd.get<uint8_t>();
+            b.ch = (char)rd.get<int8_t>();
+            b.points = rd.get<int16_t>();
+        }
+    }
+    FreeBricks& F = cfg.freeBricks;
+    int n = rd.get<uint16_t>();
+    if (!rd.ok || n > F.capacity) return false;
+    F.resize(n);
+    F.moving = 0;
+    for (int i = 0; i < n; ++i) {
+        F.baseX[i] = rd.get<float>();
+        F.baseY[i] = rd.get<float>();
+        F.dx[i] = rd.get<float>();
+        F.dy[i] = rd.get<float>();
+        F.w[i] = (short)std::max(1, std::min((int)rd.get<int16_t>(), FREE_MAX_W));
+        F.brick[i].hp = rd.get<uint8_t>();
+        F.brick[i].ch = (char)rd.get<int8_t>();
+        F.brick[i].points = rd.get<int16_t>();
+        F.path[i] = rd.get<uint8_t>();
+        F.period[i] = std::max(1, (int)rd.get<uint16_t>());
+        F.phase[i] = rd.get<uint16_t>() % F.period[i];
+        if (F.path[i] > PATH_ORBIT) return false;
+        if (F.path[i] != PATH_STILL) F.moving++;
+    }
+    return rd.ok;
+}
+
+static bool readDeltaGrid(ByteReader& rd, GameConfig& cfg) {
+    uint32_t changes = rd.get<uint32_t>();
+    int cells = brickCells(cfg);
+    for (uint32_t i = 0; i < changes && rd.ok; ++i) {
+        int idx = rd.get<uint16_t>();
+        int hp = rd.get<uint8_t>();
+        if (idx >= cells) return false;
+        setCellHp(cfg, idx, hp);
+    }
+    return rd.ok;
+}
+
+/*
+API DE SNAPSHOTS
+*/
+
+size_t snapshotMaxSize(const GameConfig& cfg) {
+    size_t dyn = 4 + 1 + 8 + 4 * 3 + 4 + 4 + 1 + 1 + MAX_PLAYERS * 11 + 2 * 2 + 4 + 4 + 2 * 2;
+    size_t balls = 4 * sizeof(float) * (size_t)cfg.balls.count;
+    size_t pools = 2 * 3 * 2 + (2 + 1 + 13) * (size_t)(cfg.powerUps.high + cfg.shots.high);
+    size_t grid = 4 * (size_t)cfg.rows * cfg.cols + 2 + 27 * (size_t)cfg.freeBricks.count;
+    return dyn + balls + pools + grid;
+}
+
+size_t serializeState(const GameConfig& cfg, uint8_t* buf, size_t cap) {
+    ByteWriter w{buf, buf + cap};
+    writeDynamic(w, cfg, SNAP_FULL);
+    writeFullGrid(w, cfg);
+    return w.ok ? (size_t)(w.p - buf) : 0;
+}
+
+// Después de restaurar, la grilla cambió entera: se recalcula lo derivado y
+// se avisa como si empezara el nivel, para que el render la reconstruya
+static void afterRestore(GameConfig& cfg) {
+    syncDerivedState(cfg);
+    cfg.events.push(EV_LEVEL_STARTED, 0, 0, cfg.level, cfg.frameCounter);
+}
+
+bool deserializeState(GameConfig& cfg, const uint8_t* buf, size_t len) {
+    ByteReader rd{buf, buf + len};
+    if (readDynamic(rd, cfg) != SNAP_FULL || !readFullGrid(rd, cfg)) return false;
+    afterRestore(cfg);
+    return true;
+}
+
+/*
+BUFFER DE REBOBINADO
+*/
+
+RewindBuffer::RewindBuffer(size_t arenaBytes, int maxFrames, int keyInterval)
+    : arena(arenaBytes), records(maxFrames), keyInterval(keyInterval) {}
+
+void RewindBuffer::clear() {
+    head = 0;
+    count = 0;
+    writePos = 0;
+    sinceKey = 0;
+}
+
+int RewindBuffer::slot(int age) const {
+    int n = (int)records.size();
+    return ((head - 1 - age) % n + n) % n;
+}
+
+bool RewindBuffer::overlaps(size_t from, size_t to) const {
+    const Record& oldest = records[slot(count - 1)];
+    return oldest.offset < to && from < oldest.offset + oldest.size;
+}
+
+// Descarta el registro más antiguo y los deltas que dependían de él, para que
+// el primer registro válido sea siempre un keyframe
+void RewindBuffer::dropOldest() {
+    --count;
+    while (count > 0 && !records[slot(count - 1)].key) --count;
+    if (count == 0) sinceKey = 0;
+}
+
+void RewindBuffer::record(const GameConfig& cfg) {
+    int cells = brickCells(cfg);
+    size_t bound = snapshotMaxSize(cfg);
+    if (bound > arena.size() || records.empty()) return;
+
+    // Keyframe periódico, o forzado si cambió la grilla entera (nivel nuevo)
+    bool key = (count == 0 || sinceKey >= keyInterval || (int)prevHp.size() != cells ||
+                cells > 65535 || cfg.level != prevLevel);
+    int changes = 0;
+    if (!key) {
+        for (int i = 0; i < cells; ++i) {
+            if (cellHp(cfg, i) != prevHp[i]) ++changes;
+        }
+        if (changes > cells / 2) key = true;
+    }
+
+    // Reservar espacio contiguo en el arena, pisando los registros más viejos.
+    // Al volver al inicio, los registros que quedaban al final son los más viejos
+    if (writePos + bound > arena.size()) {
+        while (count > 0 && records[slot(count - 1)].offset >= writePos) dropOldest();
+        writePos = 0;
+    }
+    if (count == (int)records.size()) dropOldest();
+    while (count > 0 && overlaps(writePos, writePos + bound)) dropOldest();
+    if (count == 0) key = true;
+
+    ByteWriter w{arena.data() + writePos, arena.data() + arena.size()};
+    writeDynamic(w, cfg, key ? SNAP_FULL : SNAP_DELTA);
+    size_t gridOffset = (size_t)(w.p - arena.data());
+    if (key) {
+        writeFullGrid(w, cfg);
+    } else {
+        w.put((uint32_t)changes);
+        for (int i = 0; i < cells; ++i) {
+            int hp = cellHp(cfg, i);
+            if (hp != prevHp[i]) {
+                w.put((uint16_t)i);
+                w.put((uint8_t)hp);
+            }
+        }
+    }
+    if (!w.ok) return;
+
+    // El HP de referencia para el próximo delta (se redimensiona sólo si cambia la grilla)
+    if ((int)prevHp.size() != cells) prevHp.resize(cells);
+    for (int i = 0; i < cells; ++i) prevHp[i] = (uint8_t)cellHp(cfg, i);
+
+    prevLevel = cfg.level;
+
+    Record& rec = records[head];
+    rec.offset = writePos;
+    rec.size = (size_t)(w.p - (arena.data() + writePos));
+    rec.gridOffset = gridOffset;
+    rec.key = key;
+    writePos += rec.size;
+    head = (head + 1) % (int)records.size();
+    ++count;
+    sinceKey = key ? 1 : sinceKey + 1;
+}
+
+int RewindBuffer::rewind(GameConfig& cfg, int framesBack) {
+    if (count == 0) return 0;
+    if (framesBack < 0) framesBack = 0;
+    if (framesBack > count - 1) framesBack = count - 1;
+
+    // Keyframe más cercano hacia atrás (el más antiguo siempre lo es)
+    int keyAge = framesBack;
+    while (!records[slot(keyAge)].key) ++keyAge;
+
+    // Ladrillos: keyframe completo + deltas hasta el frame pedido
+    for (int age = keyAge; age >= framesBack; --age) {
+        const Record& rec = records[slot(age)];
+        ByteReader rd{arena.data() + rec.offset, arena.data() + rec.offset + rec.size};
+        if (age == keyAge) {
+            if (readDynamic(rd, cfg) != SNAP_FULL || !readFullGrid(rd, cfg)) return 0;
+        } else {
+            rd.p = arena.data() + rec.gridOffset;
+            if (!readDeltaGrid(rd, cfg)) return 0;
+        }
+    }
+
+    // Resto del estado: el del frame pedido
+    const Record& target = records[slot(framesBack)];
+    ByteReader rd{arena.data() + target.offset, arena.data() + target.offset + target.size};
+    readDynamic(rd, cfg);
+    afterRestore(cfg);
+
+    // Los frames posteriores se descartan: se vuelve a grabar desde aquí
+    head = (slot(framesBack) + 1) % (int)records.size();
+    count -= framesBack;
+    writePos = target.offset + target.size;
+    sinceKey = keyAge - framesBack + 1;
+
+    int cells = brickCells(cfg);
+    if ((int)prevHp.size() != cells) prevHp.resize(cells);
+    for (int i = 0; i < cells; ++i) prevHp[i] = (uint8_t)cellHp(cfg, i);
+    prevLevel = cfg.level;
+    return framesBack;
+}
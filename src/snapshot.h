@@ -0,0 +1,68 @@
+/*
+snapshot.h - Captura y restauración binaria del estado de la simulación, y un
+buffer circular de snapshots por frame para rebobinar la partida.
+
+Los snapshots se escriben en memoria provista por quien llama (sin reservar
+memoria dinámica). El buffer de rebobinado guarda un keyframe completo cada
+cierto número de frames y, entre keyframes, sólo el estado dinámico más los
+ladrillos que cambiaron respecto al frame anterior.
+*/
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "sim.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Tamaño máximo que puede ocupar un snapshot completo de cfg
+size_t snapshotMaxSize(const GameConfig& cfg);
+
+// Escribe el estado completo en buf; devuelve los bytes usados o 0 si no cabe
+size_t serializeState(const GameConfig& cfg, uint8_t* buf, size_t cap);
+
+// Restaura un snapshot completo sobre cfg (misma geometría y pools ya
+// reservados); devuelve false si los datos no son válidos
+bool deserializeState(GameConfig& cfg, const uint8_t* buf, size_t len);
+
+class RewindBuffer {
+private:
+    // Registro de un frame dentro del arena
+    struct Record {
+        size_t offset;
+        size_t size;
+        size_t gridOffset;          // Inicio de la parte de ladrillos
+        bool key;
+    };
+
+    std::vector<uint8_t> arena;     // Bytes de los registros (circular)
+    std::vector<Record> records;    // Índice circular de registros
+    int head = 0;                   // Próximo registro a escribir
+    int count = 0;                  // Registros válidos
+    size_t writePos = 0;            // Próxima posición libre en el arena
+    int keyInterval;
+    int sinceKey = 0;
+    std::vector<uint8_t> prevHp;    // HP del frame anterior (para los deltas)
+    int prevLevel = 0;
+
+    int slot(int age) const;        // Índice del registro de hace `age` frames
+    bool overlaps(size_t from, size_t to) const;
+    void dropOldest();
+
+public:
+    RewindBuffer(size_t arenaBytes = 2u << 20, int maxFrames = 1024, int keyInterval = 32);
+
+    void clear();
+
+    // Guarda el frame actual (llamar una vez por frame)
+    void record(const GameConfig& cfg);
+
+    // Restaura el estado de hace `framesBack` frames (o el más antiguo
+    // disponible) y descarta los registros posteriores. Devuelve los frames
+    // efectivamente rebobinados
+    int rewind(GameConfig& cfg, int framesBack);
+
+    int framesAvailable() const { return count; }
+};
+
+#endif // SNAPSHOT_H
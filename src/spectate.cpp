@@ -0,0 +1,628 @@
+#include "spectate.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/*
+HELPERS LOCALES DE ESTE MÓDULO
+*/
+
+static void put8(std::vector<uint8_t>& o, int v) { o.push_back((uint8_t)v); }
+
+static void put16(std::vector<uint8_t>& o, int v) {
+    uint16_t u = (uint16_t)v;
+    o.push_back((uint8_t)u);
+    o.push_back((uint8_t)(u >> 8));
+}
+
+static void put32(std::vector<uint8_t>& o, uint32_t v) {
+    for (int k = 0; k < 4; ++k) o.push_back((uint8_t)(v >> (8 * k)));
+}
+
+// Lectura de un mensaje: si se termina antes, ok queda en false y se leen ceros
+struct SpectateReader {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok = true;
+
+    bool need(size_t n) {
+        if ((size_t)(end - p) < n) ok = false;
+        return ok;
+    }
+    uint8_t u8() { return need(1) ? *p++ : 0; }
+    int8_t i8() { return (int8_t)u8(); }
+    int16_t i16() {
+        if (!need(2)) return 0;
+        uint16_t v = (uint16_t)(p[0] | (p[1] << 8));
+        p += 2;
+        return (int16_t)v;
+    }
+    uint16_t u16() { return (uint16_t)i16(); }
+    uint32_t u32() {
+        if (!need(4)) return 0;
+        uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        p += 4;
+        return v;
+    }
+};
+
+static uint8_t viewFlags(const GameConfig& cfg) {
+    return (cfg.paused ? SPF_PAUSED : 0) | (cfg.running ? SPF_RUNNING : 0) | (cfg.won ? SPF_WON : 0) |
+           (cfg.lost ? SPF_LOST : 0) | (cfg.ballLaunched ? SPF_LAUNCHED : 0) |
+           (cfg.laserFrames > 0 ? SPF_LASER : 0);
+}
+
+// Secciones comunes a keyframes y deltas
+static void putHud(std::vector<uint8_t>& o, const SpectateView& v) {
+    put32(o, (uint32_t)v.score);
+    put8(o, std::max(0, std::min(v.lives, 255)));
+    put8(o, std::max(0, std::min(v.level, 255)));
+    put8(o, v.flags);
+}
+
+static void getHud(SpectateReader& in, SpectateView& v) {
+    v.score = (int32_t)in.u32();
+    v.lives = in.u8();
+    v.level = in.u8();
+    v.flags = in.u8();
+}
+
+static void putPaddles(std::vector<uint8_t>& o, const SpectateView& v) {
+    put8(o, v.numPlayers);
+    for (int p = 0; p < v.numPlayers; ++p) {
+        put16(o, v.padX[p]);
+        put16(o, v.padY[p]);
+        put16(o, v.padW[p]);
+    }
+}
+
+static void getPaddles(SpectateReader& in, SpectateView& v) {
+    v.numPlayers = std::min((int)in.u8(), MAX_PLAYERS);
+    for (int p = 0; p < v.numPlayers; ++p) {
+        v.padX[p] = in.i16();
+        v.padY[p] = in.i16();
+        v.padW[p] = in.i16();
+    }
+}
+
+// Bolas: si la cantidad no cambió y ninguna se movió más de 127 celdas, van
+// como diferencia de un byte por eje
+static void putBalls(std::vector<uint8_t>& o, const SpectateView& v, const SpectateView* prev) {
+    const size_t n = v.ballX.size();
+    bool small = prev && prev->ballX.size() == n;
+    for (size_t i = 0; small && i < n; ++i) {
+        small = std::abs(v.ballX[i] - prev->ballX[i]) <= 127 && std::abs(v.ballY[i] - prev->ballY[i]) <= 127;
+    }
+    put16(o, (int)n);
+    put8(o, small ? 1 : 0);
+    for (size_t i = 0; i < n; ++i) {
+        if (small) {
+            put8(o, v.ballX[i] - prev->ballX[i]);
+            put8(o, v.ballY[i] - prev->ballY[i]);
+        } else {
+            put16(o, v.ballX[i]);
+            put16(o, v.ballY[i]);
+        }
+    }
+}
+
+static void getBalls(SpectateReader& in, SpectateView& v) {
+    size_t n = in.u16();
+    uint8_t mode = in.u8();
+    if (mode == 1 && n != v.ballX.size()) {
+        in.ok = false;
+        return;
+    }
+    v.ballX.resize(n);
+    v.ballY.resize(n);
+    for (size_t i = 0; i < n && in.ok; ++i) {
+        if (mode == 1) {
+            v.ballX[i] += in.i8();
+            v.ballY[i] += in.i8();
+        } else {
+            v.ballX[i] = in.i16();
+            v.ballY[i] = in.i16();
+        }
+    }
+}
+
+static void putEntities(std::vector<uint8_t>& o, const SpectateView& v) {
+    put16(o, (int)v.entities.size());
+    for (const SpectateEntity& e : v.entities) {
+        put16(o, e.x);
+        put16(o, e.y);
+        put8(o, e.kind);
+    }
+}
+
+static void getEntities(SpectateReader& in, SpectateView& v) {
+    size_t n = in.u16();
+    v.entities.resize(n);
+    for (size_t i = 0; i < n && in.ok; ++i) {
+        v.entities[i].x = in.i16();
+        v.entities[i].y = in.i16();
+        v.entities[i].kind = in.u8();
+    }
+}
+
+static bool sameEntities(const SpectateView& a, const SpectateView& b) {
+    if (a.entities.size() != b.entities.size()) return false;
+    for (size_t i = 0; i < a.entities.size(); ++i) {
+        const SpectateEntity& x = a.entities[i];
+        const SpectateEntity& y = b.entities[i];
+        if (x.x != y.x || x.y != y.y || x.kind != y.kind) return false;
+    }
+    return true;
+}
+
+static void putFree(std::vector<uint8_t>& o, const SpectateView& v) {
+    put16(o, (int)v.freeBricks.size());
+    for (const SpectateBrick& b : v.freeBricks) {
+        put16(o, b.x);
+        put16(o, b.y);
+        put8(o, b.w);
+        put8(o, b.hp);
+        put8(o, b.ch);
+    }
+}
+
+static void getFree(SpectateReader& in, SpectateView& v) {
+    size_t n = in.u16();
+    v.freeBricks.resize(n);
+    for (size_t i = 0; i < n && in.ok; ++i) {
+        SpectateBrick& b = v.freeBricks[i];
+        b.x = in.i16();
+        b.y = in.i16();
+        b.w = in.u8();
+        b.hp = in.u8();
+        b.ch = in.u8();
+    }
+}
+
+static bool sameFree(const SpectateView& a, const SpectateView& b) {
+    if (a.freeBricks.size() != b.freeBricks.size()) return false;
+    for (size_t i = 0; i < a.freeBricks.size(); ++i) {
+        const SpectateBrick& x = a.freeBricks[i];
+        const SpectateBrick& y = b.freeBricks[i];
+        if (x.x != y.x || x.y != y.y || x.w != y.w || x.hp != y.hp || x.ch != y.ch) return false;
+    }
+    return true;
+}
+
+// Cambió algo que un delta no describe: geometría, grilla o nivel
+static bool layoutChanged(const SpectateView& a, const SpectateView& b) {
+    return a.top != b.top || a.left != b.left || a.bottom != b.bottom || a.right != b.right ||
+           a.rows != b.rows || a.cols != b.cols || a.gapX != b.gapX || a.gapY != b.gapY ||
+           a.brickH != b.brickH || a.level != b.level || a.ch != b.ch;
+}
+
+// Empieza un mensaje: deja lugar para el largo
+static void beginMessage(std::vector<uint8_t>& o, SpectateMsg type) {
+    o.clear();
+    put32(o, 0);
+    put8(o, type);
+}
+
+static void endMessage(std::vector<uint8_t>& o) {
+    uint32_t len = (uint32_t)(o.size() - 4);
+    for (int k = 0; k < 4; ++k) o[k] = (uint8_t)(len >> (8 * k));
+}
+
+static void encodeKeyframe(std::vector<uint8_t>& o, const SpectateView& v) {
+    beginMessage(o, SPM_KEYFRAME);
+    put32(o, v.frame);
+    put16(o, v.top);
+    put16(o, v.left);
+    put16(o, v.bottom);
+    put16(o, v.right);
+    put8(o, v.rows);
+    put8(o, v.cols);
+    put8(o, v.gapX);
+    put8(o, v.gapY);
+    put8(o, v.brickH);
+    putHud(o, v);
+    putPaddles(o, v);
+    putBalls(o, v, nullptr);
+    for (size_t i = 0; i < v.hp.size(); ++i) {
+        put8(o, v.hp[i]);
+        put8(o, v.ch[i]);
+    }
+    putEntities(o, v);
+    putFree(o, v);
+    endMessage(o);
+}
+
+// Devuelve false si no cambió nada (no hace falta enviar el frame)
+static bool encodeDelta(std::vector<uint8_t>& o, const SpectateView& v, const SpectateView& prev) {
+    bool hud = v.score != prev.score || v.lives != prev.lives || v.flags != prev.flags;
+    bool paddles = v.numPlayers != prev.numPlayers;
+    for (int p = 0; !paddles && p < v.numPlayers; ++p) {
+        paddles = v.padX[p] != prev.padX[p] || v.padY[p] != prev.padY[p] || v.padW[p] != prev.padW[p];
+    }
+    bool balls = v.ballX != prev.ballX || v.ballY != prev.ballY;
+    int bricks = 0;
+    for (size_t i = 0; i < v.hp.size(); ++i) bricks += (v.hp[i] != prev.hp[i]);
+    bool entities = !sameEntities(v, prev);
+    bool freeBricks = !sameFree(v, prev);
+
+    uint8_t parts = (hud ? SPP_HUD : 0) | (paddles ? SPP_PADDLES : 0) | (balls ? SPP_BALLS : 0) |
+                    (bricks ? SPP_BRICKS : 0) | (entities ? SPP_ENTITIES : 0) | (freeBricks ? SPP_FREE : 0);
+    if (!parts) return false;
+
+    beginMessage(o, SPM_DELTA);
+    put32(o, v.frame);
+    put8(o, parts);
+    if (hud) putHud(o, v);
+    if (paddles) putPaddles(o, v);
+    if (balls) putBalls(o, v, &prev);
+    if (bricks) {
+        put16(o, bricks);
+        for (size_t i = 0; i < v.hp.size(); ++i) {
+            if (v.hp[i] == prev.hp[i]) continue;
+            put8(o, (int)(i / v.cols));
+            put8(o, (int)(i % v.cols));
+            put8(o, v.hp[i]);
+        }
+    }
+    if (entities) putEntities(o, v);
+    if (freeBricks) putFree(o, v);
+    endMessage(o);
+    return true;
+}
+
+/*
+ESTADO DEL ESPECTADOR
+*/
+
+void captureView(const GameConfig& cfg, uint32_t frame, SpectateView& v) {
+    v.valid = true;
+    v.frame = frame;
+    v.top = cfg.top;
+    v.left = cfg.left;
+    v.bottom = cfg.bottom;
+    v.right = cfg.right;
+    v.rows = cfg.rows;
+    v.cols = cfg.cols;
+    v.gapX = cfg.gapX;
+    v.gapY = cfg.gapY;
+    v.brickH = cfg.brickH;
+    v.score = cfg.score;
+    v.lives = cfg.lives;
+    v.level = cfg.level;
+    v.flags = viewFlags(cfg);
+
+    v.numPlayers = cfg.numPlayers;
+    for (int p = 0; p < cfg.numPlayers; ++p) {
+        v.padX[p] = (int16_t)cfg.paddles[p].x;
+        v.padY[p] = (int16_t)cfg.paddles[p].y;
+        v.padW[p] = (int16_t)cfg.paddles[p].w;
+    }
+
+    const BallPool& b = cfg.balls;
+    v.ballX.resize(b.count);
+    v.ballY.resize(b.count);
+    for (int i = 0; i < b.count; ++i) {
+        v.ballX[i] = (int16_t)std::round(b.x[i]);
+        v.ballY[i] = (int16_t)std::round(b.y[i]);
+    }
+
+    v.hp.resize(cfg.rows * cfg.cols);
+    v.ch.resize(cfg.rows * cfg.cols);
+    for (int r = 0; r < cfg.rows; ++r) {
+        for (int c = 0; c < cfg.cols; ++c) {
+            const Brick& brick = cfg.grid[r][c];
+            v.hp[r * cfg.cols + c] = (uint8_t)std::max(0, std::min(brick.hp, 255));
+            v.ch[r * cfg.cols + c] = (uint8_t)brick.ch;
+        }
+    }
+
+    v.entities.clear();
+    const EntityPool& U = cfg.powerUps;
+    for (int i = 0; i < U.high; ++i) {
+        if (!U.alive[i]) continue;
+        v.entities.push_back(SpectateEntity{(int16_t)std::round(U.x[i]), (int16_t)std::round(U.y[i]), U.kind[i]});
+    }
+    const EntityPool& S = cfg.shots;
+    for (int i = 0; i < S.high; ++i) {
+        if (!S.alive[i]) continue;
+        v.entities.push_back(SpectateEntity{(int16_t)std::round(S.x[i]), (int16_t)std::round(S.y[i]), SPECTATE_SHOT});
+    }
+
+    v.freeBricks.clear();
+    const FreeBricks& F = cfg.freeBricks;
+    for (int i = 0; i < F.count; ++i) {
+        if (F.brick[i].hp <= 0) continue;
+        v.freeBricks.push_back(SpectateBrick{F.x[i], F.y[i], (uint8_t)F.w[i],
+                                             (uint8_t)std::min(F.brick[i].hp, 255), (uint8_t)F.brick[i].ch});
+    }
+}
+
+bool applySpectateMessage(SpectateView& v, const uint8_t* msg, size_t len) {
+    SpectateReader in{msg, msg + len};
+    uint8_t type = in.u8();
+    if (type == SPM_KEYFRAME) {
+        v.frame = in.u32();
+        v.top = in.i16();
+        v.left = in.i16();
+        v.bottom = in.i16();
+        v.right = in.i16();
+        v.rows = in.u8();
+        v.cols = in.u8();
+        v.gapX = in.u8();
+        v.gapY = in.u8();
+        v.brickH = in.u8();
+        getHud(in, v);
+        getPaddles(in, v);
+        getBalls(in, v);
+        size_t cells = (size_t)v.rows * v.cols;
+        v.hp.resize(cells);
+        v.ch.resize(cells);
+        for (size_t i = 0; i < cells && in.ok; ++i) {
+            v.hp[i] = in.u8();
+            v.ch[i] = in.u8();
+        }
+        getEntities(in, v);
+        getFree(in, v);
+        v.valid = in.ok;
+        return in.ok;
+    }
+    if (type != SPM_DELTA) return false;
+    if (!v.valid) return true;   // Falta el keyframe: se ignora
+
+    v.frame = in.u32();
+    uint8_t parts = in.u8();
+    if (parts & SPP_HUD) getHud(in, v);
+    if (parts & SPP_PADDLES) getPaddles(in, v);
+    if (parts & SPP_BALLS) getBalls(in, v);
+    if (parts & SPP_BRICKS) {
+        int n = in.u16();
+        for (int k = 0; k < n && in.ok; ++k) {
+            int r = in.u8(), c = in.u8(), hp = in.u8();
+            if (r < v.rows && c < v.cols) v.hp[r * v.cols + c] = (uint8_t)hp;
+        }
+    }
+    if (parts & SPP_ENTITIES) getEntities(in, v);
+    if (parts & SPP_FREE) getFree(in, v);
+    if (!in.ok) v.valid = false;   // Se espera el próximo keyframe
+    return in.ok;
+}
+
+/*
+LADO DEL JUEGO
+*/
+
+bool SpectateStream::open() {
+    close();
+    std::snprintf(path, sizeof(path), "%s%d%s", SPECTATE_PREFIX, (int)getpid(), SPECTATE_SUFFIX);
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        path[0] = 0;
+        return false;
+    }
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    // Una ruta que no entra entera en sun_path se rechaza en vez de recortarse
+    size_t len = std::strlen(path);
+    if (len >= sizeof(addr.sun_path)) {
+        path[0] = 0;
+        close();
+        return false;
+    }
+    std::memcpy(addr.sun_path, path, len);
+    addr.sun_path[len] = 0;
+    unlink(path);
+    if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listenFd, 16) != 0 ||
+        pipe(wakePipe) != 0) {
+        close();
+        return false;
+    }
+    fcntl(wakePipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(wakePipe[1], F_SETFL, O_NONBLOCK);
+
+    // Todo se reserva aquí: publicar un frame no pide memoria (salvo la
+    // primera vez que crecen las bolas)
+    ring.assign(SPECTATE_RING, 0);
+    msg.reserve(SPECTATE_CHUNK);
+    head = 0;
+    reserved = 0;
+    lastKey = 0;
+    prev.valid = false;
+    return true;
+}
+
+void SpectateStream::close() {
+    while (!spectators.empty()) dropSpectator(spectators.size() - 1);
+    if (listenFd >= 0) ::close(listenFd);
+    listenFd = -1;
+    if (path[0]) unlink(path);
+    path[0] = 0;
+    for (int& fd : wakePipe) {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+}
+
+void SpectateStream::wake() {
+    if (wakePipe[1] >= 0) {
+        char b = 1;
+        ssize_t n = write(wakePipe[1], &b, 1);
+        (void)n;
+    }
+}
+
+// Copia el mensaje al buffer circular. Como en un seqlock, `reserved` avisa
+// hasta dónde se va a escribir antes de tocar los bytes; el lector lo mira
+// después de copiar para saber si lo que leyó fue pisado
+void SpectateStream::append(const std::vector<uint8_t>& m, bool key) {
+    const uint64_t h = head.load(std::memory_order_relaxed);
+    const size_t mask = ring.size() - 1;
+    reserved.store(h + m.size(), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    size_t at = h & mask;
+    size_t first = std::min(m.size(), ring.size() - at);
+    std::memcpy(&ring[at], m.data(), first);
+    std::memcpy(&ring[0], m.data() + first, m.size() - first);
+    head.store(h + m.size(), std::memory_order_release);
+    if (key) {
+        lastKey.store(h + 1, std::memory_order_release);   // 0 = todavía no hubo
+        keyBytes = h;
+    }
+    if (sleeping.exchange(false)) wake();
+}
+
+void SpectateStream::publish(const GameConfig& cfg, uint64_t frame) {
+    if (listenFd < 0 || clients.load() == 0) {
+        prev.valid = false;   // Al volver a haber espectadores empieza con keyframe
+        return;
+    }
+    captureView(cfg, (uint32_t)frame, cur);
+    uint64_t h = head.load(std::memory_order_relaxed);
+    bool key = keyWanted.load() || !prev.valid || sinceKey >= KEYFRAME_FRAMES ||
+               h - keyBytes > SPECTATE_RING / 4 || layoutChanged(prev, cur);
+    if (key) {
+        keyWanted = false;
+        encodeKeyframe(msg, cur);
+        append(msg, true);
+        sinceKey = 0;
+    } else {
+        ++sinceKey;
+        if (encodeDelta(msg, cur, prev)) append(msg, false);
+    }
+    std::swap(prev, cur);
+}
+
+// Llena `out` con los mensajes completos que siguen al cursor del
+// espectador. false si no hay nada para enviar
+bool SpectateStream::refill(Spectator& s) {
+    s.out.clear();
+    s.sent = 0;
+    const uint64_t h = head.load(std::memory_order_acquire);
+    const size_t cap = ring.size(), mask = cap - 1;
+
+    if (s.waiting) {
+        uint64_t k = lastKey.load(std::memory_order_acquire);
+        if (k == 0 || k - 1 < s.waitKey) return false;
+        s.cursor = k - 1;
+        s.waiting = false;
+    }
+
+    // Atrasado: lo que le faltaba ya se pisó. Salta al último keyframe (o
+    // espera uno nuevo si ése también se pisó)
+    auto resync = [&]() {
+        ++drops;
+        uint64_t k = lastKey.load(std::memory_order_acquire);
+        if (k != 0 && k - 1 + cap >= reserved.load(std::memory_order_relaxed)) {
+            s.cursor = k - 1;
+        } else {
+            s.waiting = true;
+            s.waitKey = h;
+            keyWanted = true;
+        }
+        s.out.clear();
+        return false;
+    };
+    if (h - s.cursor > cap) return resync();
+
+    // Mensajes enteros, hasta SPECTATE_CHUNK bytes (al menos uno)
+    uint64_t n = 0;
+    while (s.cursor + n + 4 <= h) {
+        uint32_t len = 0;
+        for (int k = 0; k < 4; ++k) len |= (uint32_t)ring[(s.cursor + n + k) & mask] << (8 * k);
+        if (len > cap / 2) return resync();   // Largo leído de bytes ya pisados
+        if (s.cursor + n + 4 + len > h) break;
+        if (n > 0 && n + 4 + len > SPECTATE_CHUNK) break;
+        n += 4 + len;
+    }
+    if (n == 0) return false;
+
+    size_t at = s.cursor & mask;
+    size_t first = std::min((size_t)n, cap - at);
+    s.out.insert(s.out.end(), ring.begin() + at, ring.begin() + at + first);
+    s.out.insert(s.out.end(), ring.begin(), ring.begin() + (n - first));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (reserved.load(std::memory_order_relaxed) > s.cursor + cap) return resync();
+
+    s.cursor += n;
+    return true;
+}
+
+void SpectateStream::dropSpectator(size_t i) {
+    ::close(spectators[i].fd);
+    spectators[i] = std::move(spectators.back());
+    spectators.pop_back();
+    clients.fetch_sub(1);
+}
+
+void SpectateStream::serve(int timeoutMs) {
+    if (listenFd < 0) return;
+
+    // 1) Enviar lo pendiente a cada espectador sin bloquear
+    const uint64_t seen = head.load(std::memory_order_acquire);
+    bool more = false;   // Alguien tiene más para enviar y su socket no está lleno
+    for (size_t i = 0; i < spectators.size();) {
+        Spectator& s = spectators[i];
+        bool alive = true, full = false;
+        for (int round = 0; round < 4 && alive && !full; ++round) {
+            if (s.sent == s.out.size() && !refill(s)) break;
+            ssize_t k = send(s.fd, s.out.data() + s.sent, s.out.size() - s.sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (k > 0) s.sent += (size_t)k;
+            else if (k < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) full = true;
+            else if (!(k < 0 && errno == EINTR)) alive = false;
+        }
+        if (!alive) {
+            dropSpectator(i);
+            continue;
+        }
+        if (!full && !s.waiting && (s.sent < s.out.size() || s.cursor < seen)) more = true;
+        ++i;
+    }
+
+    // 2) Esperar: socket nuevo, bytes nuevos del juego (pipe) o lugar en un
+    // socket lleno
+    std::vector<pollfd>& fds = pollFds;
+    fds.clear();
+    fds.push_back(pollfd{listenFd, POLLIN, 0});
+    fds.push_back(pollfd{wakePipe[0], POLLIN, 0});
+    for (const Spectator& s : spectators) {
+        short ev = POLLIN;
+        if (s.sent < s.out.size()) ev |= POLLOUT;
+        fds.push_back(pollfd{s.fd, ev, 0});
+    }
+    sleeping.store(true);
+    if (more || head.load(std::memory_order_acquire) != seen) timeoutMs = 0;
+    poll(fds.data(), fds.size(), timeoutMs);
+    sleeping.store(false);
+
+    if (fds[1].revents & POLLIN) {
+        char buf[64];
+        while (read(wakePipe[0], buf, sizeof(buf)) > 0) { }
+    }
+
+    // Espectadores que cerraron (no envían nada: lo que lean es el cierre)
+    for (size_t k = spectators.size(); k-- > 0;) {
+        if (!(fds[2 + k].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+        char buf[64];
+        ssize_t r = recv(spectators[k].fd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (r == 0 || (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) dropSpectator(k);
+    }
+
+    // Nuevos: esperan el keyframe que se pide ahora
+    if (fds[0].revents & POLLIN) {
+        int fd;
+        while ((fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+            Spectator s{fd, 0, head.load(std::memory_order_acquire), true, {}, 0};
+            s.out.reserve(SPECTATE_CHUNK);
+            spectators.push_back(std::move(s));
+            clients.fetch_add(1);
+            keyWanted = true;
+        }
+    }
+}
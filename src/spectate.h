@@ -0,0 +1,176 @@
+/*
+spectate.h - Transmisión de la partida a espectadores locales por un socket
+Unix (/tmp/breakout-<pid>.sock).
+
+Cada frame se codifica una sola vez como diferencia con el anterior (bolas y
+paletas que se movieron, HP de los ladrillos que cambiaron, HUD, power-ups,
+disparos y ladrillos libres) y se agrega a un buffer circular en memoria;
+cada KEYFRAME_FRAMES frames, al cambiar de nivel o al conectarse alguien va
+un keyframe con el estado completo. Un hilo aparte reparte los bytes a cada
+espectador con escrituras no bloqueantes. Si uno se atrasa tanto que el
+buffer ya pisó lo que le faltaba, salta al último keyframe. Así el juego
+nunca espera a los espectadores y su costo por frame no depende de cuántos
+haya (sin espectadores no codifica nada).
+
+El cliente (tools/spectate.cpp) reconstruye la partida con SpectateView.
+No depende de ncurses.
+
+MENSAJES: u32 largo (lo que sigue) | u8 tipo | contenido
+
+  keyframe:  u32 frame | i16 top, left, bottom, right | u8 rows, cols, gapX, gapY, brickH
+             | HUD | paletas | bolas (absolutas) | ladrillos (rows x cols: u8 hp, u8 ch)
+             | entidades | libres
+  delta:     u32 frame | u8 partes | [HUD] [paletas] [bolas] [ladrillos] [entidades] [libres]
+
+  HUD:       i32 score | u8 vidas | u8 nivel | u8 estado (SPF_*)
+  paletas:   u8 n | n x (i16 x, y, w)
+  bolas:     u16 n | u8 modo | modo 0: n x (i16 x, y); modo 1: n x (i8 dx, dy)
+  ladrillos: u16 n | n x (u8 fila, u8 columna, u8 hp)           (sólo en delta)
+  entidades: u16 n | n x (i16 x, y, u8 tipo)  power-ups y luego disparos
+  libres:    u16 n | n x (i16 x, y, u8 ancho, hp, ch)  ladrillos libres vivos
+*/
+#ifndef SPECTATE_H
+#define SPECTATE_H
+
+#include "sim.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <poll.h>
+
+#define SPECTATE_PREFIX "/tmp/breakout-"
+#define SPECTATE_SUFFIX ".sock"
+
+const int KEYFRAME_FRAMES = 120;              // Un keyframe cada ~2 s a 60 fps
+const size_t SPECTATE_RING = 4u << 20;        // Bytes del buffer circular (potencia de 2)
+const size_t SPECTATE_CHUNK = 64u << 10;      // Máximo que se copia por espectador de una vez
+
+enum SpectateMsg : uint8_t {
+    SPM_KEYFRAME = 1,
+    SPM_DELTA = 2
+};
+
+// Partes de un delta
+enum SpectatePart : uint8_t {
+    SPP_HUD = 1,
+    SPP_PADDLES = 2,
+    SPP_BALLS = 4,
+    SPP_BRICKS = 8,
+    SPP_ENTITIES = 16,
+    SPP_FREE = 32
+};
+
+// Estado en el HUD
+enum SpectateFlag : uint8_t {
+    SPF_PAUSED = 1,
+    SPF_RUNNING = 2,
+    SPF_WON = 4,
+    SPF_LOST = 8,
+    SPF_LAUNCHED = 16,
+    SPF_LASER = 32
+};
+
+// Power-up (tipo 0..POWER_COUNT-1) o disparo (tipo SPECTATE_SHOT) en pantalla
+const uint8_t SPECTATE_SHOT = 255;
+struct SpectateEntity {
+    int16_t x, y;
+    uint8_t kind;
+};
+
+// Ladrillo libre vivo (fuera de la grilla)
+struct SpectateBrick {
+    int16_t x, y;
+    uint8_t w, hp, ch;
+};
+
+// Lo que ve un espectador, en celdas de pantalla
+struct SpectateView {
+    bool valid = false;          // Ya llegó un keyframe
+    uint32_t frame = 0;
+    int top = 0, left = 0, bottom = 0, right = 0;
+    int rows = 0, cols = 0, gapX = 0, gapY = 0, brickH = 0;
+    int score = 0, lives = 0, level = 0;
+    uint8_t flags = 0;
+    int numPlayers = 0;
+    int16_t padX[MAX_PLAYERS], padY[MAX_PLAYERS], padW[MAX_PLAYERS];
+    std::vector<int16_t> ballX, ballY;
+    std::vector<uint8_t> hp, ch;             // rows x cols
+    std::vector<SpectateEntity> entities;    // Power-ups y disparos
+    std::vector<SpectateBrick> freeBricks;
+};
+
+// Copia a `v` lo que se transmite de la partida (sin reservar memoria una vez
+// que los vectores alcanzaron su tamaño)
+void captureView(const GameConfig& cfg, uint32_t frame, SpectateView& v);
+
+// Aplica un mensaje completo (sin el campo de largo). false si está mal
+// formado; los deltas anteriores al primer keyframe se ignoran
+bool applySpectateMessage(SpectateView& v, const uint8_t* msg, size_t len);
+
+// Lado del juego: codifica los frames en el buffer circular y atiende el
+// socket. publish() la llama quien cierra el frame con el mutex del tablero;
+// serve() la llama sólo el hilo de espectadores
+class SpectateStream {
+private:
+    struct Spectator {
+        int fd;
+        uint64_t cursor;            // Próximo byte del buffer a enviar
+        uint64_t waitKey;           // Espera un keyframe posterior a esta posición
+        bool waiting;
+        std::vector<uint8_t> out;   // Mensajes completos copiados del buffer
+        size_t sent;
+    };
+
+    int listenFd = -1;
+    int wakePipe[2] = {-1, -1};
+    char path[108] = {0};
+
+    std::vector<uint8_t> ring;
+    std::atomic<uint64_t> head{0};       // Bytes escritos en total
+    std::atomic<uint64_t> reserved{0};   // Hasta dónde se está escribiendo
+    std::atomic<uint64_t> lastKey{0};    // Inicio del último keyframe
+    std::atomic<bool> keyWanted{false};  // Alguien se conectó: keyframe en el próximo publish
+    std::atomic<int> clients{0};
+    std::atomic<bool> sleeping{false};   // El hilo está (o va a estar) en poll
+
+    // Estado del productor
+    SpectateView prev, cur;
+    std::vector<uint8_t> msg;
+    int sinceKey = 0;
+    uint64_t keyBytes = 0;               // head al escribir el último keyframe
+
+    std::vector<Spectator> spectators;
+    std::vector<pollfd> pollFds;         // Reusado en cada serve()
+    unsigned long drops = 0;
+
+    void append(const std::vector<uint8_t>& m, bool key);
+    bool refill(Spectator& s);
+    void dropSpectator(size_t i);
+
+public:
+    SpectateStream() = default;
+    ~SpectateStream() { close(); }
+    SpectateStream(const SpectateStream&) = delete;
+    SpectateStream& operator=(const SpectateStream&) = delete;
+
+    bool open();   // Crea el socket; false si no se pudo (se juega igual)
+    void close();
+    const char* socketPath() const { return path; }
+
+    // Agrega el frame (delta o keyframe); sin espectadores no hace nada
+    void publish(const GameConfig& cfg, uint64_t frame);
+
+    // Hay un espectador nuevo y todavía no se escribió su keyframe (el hilo
+    // lo publica él mismo si el juego está en reposo)
+    bool wantsKeyframe() const { return keyWanted.load(); }
+
+    // Acepta espectadores y envía lo pendiente; espera hasta timeoutMs en
+    // poll si no hay nada que hacer (-1: hasta que pase algo)
+    void serve(int timeoutMs);
+    void wake();
+
+    int spectatorCount() const { return clients.load(); }
+    unsigned long dropCount() const { return drops; }
+};
+
+#endif // SPECTATE_H
@@ -0,0 +1,189 @@
+#include "telemetry.h"
+
+/*
+HELPERS LOCALES DE ESTE MÓDULO
+*/
+
+static void putVarint(std::vector<uint8_t>& out, uint32_t v) {
+    while (v >= 0x80) {
+        out.push_back((uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((uint8_t)v);
+}
+
+// Lee un varint; false si se termina el buffer antes
+static bool getVarint(const uint8_t*& p, const uint8_t* end, uint32_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7) {
+        uint8_t byte = *p++;
+        v |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// Zigzag: los negativos chicos también ocupan un byte
+static uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+static int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+static void encodeSigned(std::vector<uint8_t>& out, const std::vector<int32_t>& col) {
+    for (int32_t v : col) putVarint(out, zigzag(v));
+}
+
+static bool decodeSigned(const std::vector<uint8_t>& in, uint32_t rows, std::vector<int32_t>& col) {
+    col.resize(rows);
+    const uint8_t* p = in.data();
+    const uint8_t* end = p + in.size();
+    for (uint32_t i = 0; i < rows; ++i) {
+        uint32_t v;
+        if (!getVarint(p, end, v)) return false;
+        col[i] = unzigzag(v);
+    }
+    return true;
+}
+
+/*
+ESCRITURA
+*/
+
+bool TelemetryWriter::open(const char* path, const TelemetryHeader& header) {
+    close();
+    file = std::fopen(path, "wb");
+    if (!file) return false;
+
+    TelemetryHeader h = header;
+    h.magic = TELEMETRY_MAGIC;
+    h.version = TELEMETRY_VERSION;
+    if (std::fwrite(&h, sizeof(h), 1, file) != 1) {
+        std::fclose(file);
+        file = nullptr;
+        return false;
+    }
+    rows = 0;
+    bytes = sizeof(h);
+    pending.rows = 0;
+    pending.type.reserve(TELEMETRY_BATCH);
+    pending.frame.reserve(TELEMETRY_BATCH);
+    pending.a.reserve(TELEMETRY_BATCH);
+    pending.b.reserve(TELEMETRY_BATCH);
+    pending.value.reserve(TELEMETRY_BATCH);
+    return true;
+}
+
+void TelemetryWriter::close() {
+    if (!file) return;
+    writeBatch();
+    std::fclose(file);
+    file = nullptr;
+}
+
+void TelemetryWriter::add(EventType type, uint32_t frame, int a, int b, int value) {
+    if (!file) return;
+    pending.type.push_back(type);
+    pending.frame.push_back(frame);
+    pending.a.push_back(a);
+    pending.b.push_back(b);
+    pending.value.push_back(value);
+    ++rows;
+    if (++pending.rows >= (uint32_t)TELEMETRY_BATCH) writeBatch();
+}
+
+void TelemetryWriter::flush() {
+    if (!file) return;
+    writeBatch();
+    std::fflush(file);
+}
+
+void TelemetryWriter::writeBatch() {
+    if (pending.rows == 0) return;
+
+    for (auto& c : cols) c.clear();
+    cols[TC_TYPE].assign(pending.type.begin(), pending.type.end());
+    uint32_t last = 0;
+    for (uint32_t f : pending.frame) {
+        putVarint(cols[TC_FRAME], f - last);
+        last = f;
+    }
+    encodeSigned(cols[TC_A], pending.a);
+    encodeSigned(cols[TC_B], pending.b);
+    encodeSigned(cols[TC_VALUE], pending.value);
+
+    uint32_t head[1 + TC_COUNT];
+    head[0] = pending.rows;
+    for (int c = 0; c < TC_COUNT; ++c) head[1 + c] = (uint32_t)cols[c].size();
+    std::fwrite(head, sizeof(head), 1, file);
+    bytes += sizeof(head);
+    for (auto& c : cols) {
+        std::fwrite(c.data(), 1, c.size(), file);
+        bytes += c.size();
+    }
+
+    pending.rows = 0;
+    pending.type.clear();
+    pending.frame.clear();
+    pending.a.clear();
+    pending.b.clear();
+    pending.value.clear();
+}
+
+/*
+LECTURA
+*/
+
+bool TelemetryReader::open(const char* path) {
+    close();
+    file = std::fopen(path, "rb");
+    if (!file) return false;
+    if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+        header.magic != TELEMETRY_MAGIC || header.version != TELEMETRY_VERSION) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void TelemetryReader::close() {
+    if (file) std::fclose(file);
+    file = nullptr;
+}
+
+bool TelemetryReader::next(TelemetryBatch& batch, uint32_t columns) {
+    if (!file) return false;
+    uint32_t head[1 + TC_COUNT];
+    if (std::fread(head, sizeof(head), 1, file) != 1) return false;
+    batch.rows = head[0];
+    if (batch.rows > (uint32_t)TELEMETRY_BATCH) return false;
+
+    for (int c = 0; c < TC_COUNT; ++c) {
+        uint32_t size = head[1 + c];
+        if (!(columns & columnBit((TelemetryColumn)c))) {
+            if (std::fseek(file, size, SEEK_CUR) != 0) return false;
+            continue;
+        }
+        raw.resize(size);
+        if (size > 0 && std::fread(raw.data(), 1, size, file) != size) return false;
+
+        bool ok = true;
+        if (c == TC_TYPE) {
+            ok = size == batch.rows;
+            batch.type.assign(raw.begin(), raw.end());
+        } else if (c == TC_FRAME) {
+            batch.frame.resize(batch.rows);
+            const uint8_t* p = raw.data();
+            const uint8_t* end = p + raw.size();
+            uint32_t last = 0;
+            for (uint32_t i = 0; i < batch.rows && ok; ++i) {
+                uint32_t d;
+                ok = getVarint(p, end, d);
+                last += d;
+                batch.frame[i] = last;
+            }
+        } else {
+            std::vector<int32_t>& col = (c == TC_A) ? batch.a : (c == TC_B) ? batch.b : batch.value;
+            ok = decodeSigned(raw, batch.rows, col);
+        }
+        if (!ok) return false;
+    }
+    return true;
+}
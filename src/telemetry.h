@@ -0,0 +1,107 @@
+/*
+telemetry.h - Archivos de telemetría de una sesión (.bkt): los eventos de la
+partida guardados por columnas para analizarlos después (tools/telemetry.cpp).
+
+El archivo tiene una cabecera y lotes de hasta TELEMETRY_BATCH filas. Cada
+lote guarda por separado las columnas de tipo, frame, a, b y valor, cada una
+comprimida según lo que contiene:
+  - tipo: un byte por fila
+  - frame: diferencia con la fila anterior (crece siempre) en varint
+  - a, b, valor: zigzag + varint (la mayoría son números chicos)
+Delante de las columnas va el tamaño en bytes de cada una, así un lector que
+sólo necesita algunas salta las demás sin decodificarlas.
+
+No depende de ncurses.
+*/
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "events.h"
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+const uint32_t TELEMETRY_MAGIC = 0x31544B42;   // "BKT1"
+const uint32_t TELEMETRY_VERSION = 1;
+const int TELEMETRY_BATCH = 4096;              // Filas por lote
+
+// Columnas de un lote, en el orden en que se guardan
+enum TelemetryColumn {
+    TC_TYPE,
+    TC_FRAME,
+    TC_A,
+    TC_B,
+    TC_VALUE,
+    TC_COUNT
+};
+
+constexpr uint32_t columnBit(TelemetryColumn c) { return 1u << c; }
+const uint32_t TC_ALL = (1u << TC_COUNT) - 1;
+
+struct TelemetryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seed;         // Semilla de la partida
+    uint32_t tickUs;       // Duración de un frame en microsegundos
+    int64_t startUnix;     // Inicio de la sesión
+};
+
+// Filas de un lote ya decodificadas (sólo las columnas pedidas)
+struct TelemetryBatch {
+    uint32_t rows = 0;
+    std::vector<uint8_t> type;
+    std::vector<uint32_t> frame;   // Frames desde el inicio de la sesión
+    std::vector<int32_t> a, b, value;
+};
+
+// Escritura. add() sólo agrega a memoria; el lote se comprime y se escribe
+// cuando se llena, en flush() o en close()
+class TelemetryWriter {
+private:
+    FILE* file = nullptr;
+    TelemetryBatch pending;
+    std::vector<uint8_t> cols[TC_COUNT];
+    unsigned long rows = 0, bytes = 0;
+
+    void writeBatch();
+
+public:
+    TelemetryWriter() = default;
+    ~TelemetryWriter() { close(); }
+    TelemetryWriter(const TelemetryWriter&) = delete;
+    TelemetryWriter& operator=(const TelemetryWriter&) = delete;
+
+    bool open(const char* path, const TelemetryHeader& header);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    // frame: frames desde el inicio de la sesión (no decrece)
+    void add(EventType type, uint32_t frame, int a, int b, int value);
+    void flush();
+
+    unsigned long rowCount() const { return rows; }
+    unsigned long byteCount() const { return bytes; }   // Escritos hasta ahora
+};
+
+// Lectura por lotes, decodificando sólo las columnas de `columns`
+class TelemetryReader {
+private:
+    FILE* file = nullptr;
+    std::vector<uint8_t> raw;
+
+public:
+    TelemetryHeader header{};
+
+    TelemetryReader() = default;
+    ~TelemetryReader() { close(); }
+    TelemetryReader(const TelemetryReader&) = delete;
+    TelemetryReader& operator=(const TelemetryReader&) = delete;
+
+    bool open(const char* path);   // false si no existe o no es un .bkt válido
+    void close();
+
+    // false al terminar el archivo (o si el lote está cortado)
+    bool next(TelemetryBatch& batch, uint32_t columns = TC_ALL);
+};
+
+#endif // TELEMETRY_H
@@ -0,0 +1,63 @@
+#include "term_capture.h"
+#include <unistd.h>
+
+bool TermCapture::open(int rows, int cols, const char* term) {
+    close();
+    out = tmpfile();
+    in = fopen("/dev/null", "r");
+    if (!out || !in) {
+        close();
+        return false;
+    }
+    screen = newterm(term, out, in);
+    if (!screen) {
+        close();
+        return false;
+    }
+    set_term(screen);
+    resizeterm(rows, cols);
+    curs_set(0);
+    noecho();
+    // La entrada es /dev/null, que siempre tiene algo para leer: sin esto
+    // ncurses cortaría cada refresh creyendo que hay teclas pendientes
+    typeahead(-1);
+    refresh();
+
+    vt.resize(rows, cols);
+    drain();
+    vt.endFrame();
+    return true;
+}
+
+void TermCapture::close() {
+    if (screen) {
+        set_term(screen);
+        endwin();
+        delscreen(screen);
+        screen = nullptr;
+    }
+    if (out) fclose(out);
+    if (in) fclose(in);
+    out = in = nullptr;
+}
+
+// Lee lo escrito desde el último frame y vacía el archivo: así nunca crece
+// más que un frame
+size_t TermCapture::drain() {
+    fflush(out);
+    int fd = fileno(out);
+    off_t size = lseek(fd, 0, SEEK_END);
+    if (size <= 0) return 0;
+    buffer.resize((size_t)size);
+    ssize_t n = pread(fd, buffer.data(), buffer.size(), 0);
+    if (n > 0) vt.feed(buffer.data(), (size_t)n);
+    if (ftruncate(fd, 0) != 0) { }
+    rewind(out);
+    return n > 0 ? (size_t)n : 0;
+}
+
+VtStats TermCapture::frame() {
+    if (!out) return VtStats();
+    drain();
+    return vt.endFrame();
+}
@@ -0,0 +1,48 @@
+/*
+term_capture.h - ncurses sin terminal: una pantalla de ncurses (newterm) que
+escribe en un archivo temporal en vez de en la TTY. Después de cada frame,
+frame() pasa lo escrito a una VirtualTerminal y devuelve lo que costó en
+bytes, movimientos del cursor, cambios de atributo y celdas.
+
+Lo usan tools/bench.cpp (para comparar formas de dibujar el tablero) y el
+modo -c de tools/spectate.cpp. Mientras está abierta es la pantalla actual
+de ncurses (stdscr, LINES y COLS son los suyos).
+*/
+#ifndef TERM_CAPTURE_H
+#define TERM_CAPTURE_H
+
+#include "vterm.h"
+#include <cstdio>
+#include <ncurses.h>
+
+class TermCapture {
+private:
+    SCREEN* screen = nullptr;
+    FILE* out = nullptr;
+    FILE* in = nullptr;
+    VirtualTerminal vt;
+    std::vector<char> buffer;
+
+    size_t drain();   // Pasa lo escrito a la terminal virtual; devuelve los bytes
+
+public:
+    TermCapture() = default;
+    ~TermCapture() { close(); }
+    TermCapture(const TermCapture&) = delete;
+    TermCapture& operator=(const TermCapture&) = delete;
+
+    // Abre una pantalla de rows x cols para el tipo de terminal dado (su
+    // terminfo tiene que estar instalado). Lo que ncurses manda al iniciarse
+    // no se cuenta
+    bool open(int rows, int cols, const char* term = "xterm");
+    void close();
+    bool isOpen() const { return screen != nullptr; }
+
+    // Cierra el frame después del refresh()/doupdate(): lo que recibió la
+    // terminal desde el frame anterior
+    VtStats frame();
+
+    const VirtualTerminal& terminal() const { return vt; }
+};
+
+#endif // TERM_CAPTURE_H
@@ -0,0 +1,391 @@
+#include "vterm.h"
+#include <algorithm>
+
+VirtualTerminal::VirtualTerminal(int rows, int cols) {
+    resize(rows, cols);
+}
+
+void VirtualTerminal::resize(int rows, int cols) {
+    numRows = std::max(1, rows);
+    numCols = std::max(1, cols);
+    cells.assign((size_t)numRows * numCols, VtCell{' ', VT_ATTR_DEFAULT});
+    shown = cells;
+    cy = cx = savedY = savedX = 0;
+    wrapPending = false;
+    top = 0;
+    bottom = numRows - 1;
+    attr = VT_ATTR_DEFAULT;
+    lineDrawing = false;
+    state = GROUND;
+    utf8Left = 0;
+    cur = VtStats();
+}
+
+// Los borrados dejan el color de fondo vigente (como xterm, "bce")
+VtCell VirtualTerminal::blank() const {
+    return VtCell{' ', (VT_COLOR_DEFAULT << 8) | (attr & (0x1FFu << 17))};
+}
+
+/*
+TEXTO Y DESPLAZAMIENTO
+*/
+
+// Juego de caracteres de líneas de DEC (ESC ( 0), el que usa ncurses para
+// los bordes ACS
+static uint32_t lineDrawingChar(uint32_t ch) {
+    switch (ch) {
+        case 'j': return 0x2518;  case 'k': return 0x2510;
+        case 'l': return 0x250C;  case 'm': return 0x2514;
+        case 'n': return 0x253C;  case 'q': return 0x2500;
+        case 't': return 0x251C;  case 'u': return 0x2524;
+        case 'v': return 0x2534;  case 'w': return 0x252C;
+        case 'x': return 0x2502;  case 'a': return 0x2592;
+        case '`': return 0x25C6;  case '~': return 0x00B7;
+        case 'f': return 0x00B0;  case 'g': return 0x00B1;
+        default:  return ch;
+    }
+}
+
+void VirtualTerminal::put(uint32_t ch) {
+    if (lineDrawing && ch < 0x80) ch = lineDrawingChar(ch);
+    // Con el cursor en la última columna, la escritura siguiente pasa a la
+    // próxima línea (margen automático de xterm)
+    if (wrapPending) {
+        cx = 0;
+        lineFeed();
+        wrapPending = false;
+    }
+    at(cy, cx) = VtCell{ch, attr};
+    cur.cellsWritten++;
+    lastCh = ch;
+    if (cx + 1 < numCols) ++cx;
+    else wrapPending = true;
+}
+
+void VirtualTerminal::lineFeed() {
+    if (cy == bottom) scrollUp(top, bottom, 1);
+    else if (cy + 1 < numRows) ++cy;
+}
+
+// Sube las líneas [from, to] n posiciones; abajo quedan líneas vacías
+void VirtualTerminal::scrollUp(int from, int to, int n) {
+    n = std::min(n, to - from + 1);
+    if (n <= 0) return;
+    VtCell b = blank();
+    for (int r = from; r <= to; ++r) {
+        for (int c = 0; c < numCols; ++c) at(r, c) = (r + n <= to) ? at(r + n, c) : b;
+    }
+    cur.cellsWritten += (uint64_t)(to - from + 1) * numCols;
+}
+
+void VirtualTerminal::scrollDown(int from, int to, int n) {
+    n = std::min(n, to - from + 1);
+    if (n <= 0) return;
+    VtCell b = blank();
+    for (int r = to; r >= from; --r) {
+        for (int c = 0; c < numCols; ++c) at(r, c) = (r - n >= from) ? at(r - n, c) : b;
+    }
+    cur.cellsWritten += (uint64_t)(to - from + 1) * numCols;
+}
+
+// Borra las columnas [c0, c1) de la fila r
+void VirtualTerminal::eraseCells(int r, int c0, int c1) {
+    c0 = std::max(c0, 0);
+    c1 = std::min(c1, numCols);
+    VtCell b = blank();
+    for (int c = c0; c < c1; ++c) at(r, c) = b;
+    if (c1 > c0) cur.cellsWritten += c1 - c0;
+}
+
+void VirtualTerminal::moveTo(int r, int c) {
+    cy = std::max(0, std::min(r, numRows - 1));
+    cx = std::max(0, std::min(c, numCols - 1));
+    wrapPending = false;
+    cur.cursorMoves++;
+}
+
+/*
+SECUENCIAS DE CONTROL
+*/
+
+int VirtualTerminal::param(int i, int def) const {
+    return (i < numParams && params[i] > 0) ? params[i] : def;
+}
+
+void VirtualTerminal::control(uint8_t b) {
+    switch (b) {
+        case '\r': moveTo(cy, 0); break;
+        case '\n': case 0x0B: case 0x0C:
+            wrapPending = false;
+            lineFeed();
+            cur.cursorMoves++;
+            break;
+        case '\b': moveTo(cy, cx - 1); break;
+        case '\t': moveTo(cy, std::min((cx / 8 + 1) * 8, numCols - 1)); break;
+        case 0x0E: case 0x0F: case 0x07: break;   // SO/SI, campana
+        case 0x1B: state = ESCAPE; break;
+        default: break;
+    }
+}
+
+// SGR: atributos y colores (8, 16 y 256 colores; el color directo se
+// aproxima al 256 más cercano de la paleta de grises, sólo para compararlo)
+void VirtualTerminal::setGraphics() {
+    cur.attrChanges++;
+    if (numParams == 0) {
+        attr = VT_ATTR_DEFAULT;
+        return;
+    }
+    uint32_t flags = attr & 0xFF, fg = vtFg(attr), bg = vtBg(attr);
+    for (int i = 0; i < numParams; ++i) {
+        int p = params[i];
+        if (p == 0) { flags = 0; fg = bg = VT_COLOR_DEFAULT; }
+        else if (p == 1) flags |= VT_BOLD;
+        else if (p == 2) flags |= VT_DIM;
+        else if (p == 3) flags |= VT_ITALIC;
+        else if (p == 4) flags |= VT_UNDERLINE;
+        else if (p == 5) flags |= VT_BLINK;
+        else if (p == 7) flags |= VT_REVERSE;
+        else if (p == 8) flags |= VT_INVISIBLE;
+        else if (p == 22) flags &= ~(VT_BOLD | VT_DIM);
+        else if (p == 23) flags &= ~VT_ITALIC;
+        else if (p == 24) flags &= ~VT_UNDERLINE;
+        else if (p == 25) flags &= ~VT_BLINK;
+        else if (p == 27) flags &= ~VT_REVERSE;
+        else if (p == 28) flags &= ~VT_INVISIBLE;
+        else if (p >= 30 && p <= 37) fg = p - 30;
+        else if (p == 39) fg = VT_COLOR_DEFAULT;
+        else if (p >= 40 && p <= 47) bg = p - 40;
+        else if (p == 49) bg = VT_COLOR_DEFAULT;
+        else if (p >= 90 && p <= 97) fg = p - 90 + 8;
+        else if (p >= 100 && p <= 107) bg = p - 100 + 8;
+        else if ((p == 38 || p == 48) && i + 1 < numParams) {
+            uint32_t color = VT_COLOR_DEFAULT;
+            if (params[i + 1] == 5 && i + 2 < numParams) {
+                color = (uint32_t)std::min(params[i + 2], 255);
+                i += 2;
+            } else if (params[i + 1] == 2 && i + 4 < numParams) {
+                color = 232 + (uint32_t)((params[i + 2] + params[i + 3] + params[i + 4]) / 3 * 23 / 255);
+                i += 4;
+            } else {
+                cur.ignored++;
+                break;
+            }
+            if (p == 38) fg = color;
+            else bg = color;
+        }
+        else cur.ignored++;
+    }
+    attr = flags | (fg << 8) | (bg << 17);
+}
+
+void VirtualTerminal::dispatchCsi(uint8_t final) {
+    // Modos de DEC (cursor visible, pantalla alternativa, teclado): no
+    // cambian lo que se ve
+    if (privateMode || intermediate) {
+        if (final != 'h' && final != 'l') cur.ignored++;
+        return;
+    }
+    int n = param(0, 1);
+    switch (final) {
+        case 'H': case 'f': moveTo(param(0, 1) - 1, param(1, 1) - 1); break;
+        case 'A': moveTo(cy - n, cx); break;
+        case 'B': case 'e': moveTo(cy + n, cx); break;
+        case 'C': case 'a': moveTo(cy, cx + n); break;
+        case 'D': moveTo(cy, cx - n); break;
+        case 'E': moveTo(cy + n, 0); break;
+        case 'F': moveTo(cy - n, 0); break;
+        case 'G': case '`': moveTo(cy, n - 1); break;
+        case 'd': moveTo(n - 1, cx); break;
+
+        case 'J': {
+            int mode = numParams ? params[0] : 0;
+            if (mode == 0) {
+                eraseCells(cy, cx, numCols);
+                for (int r = cy + 1; r < numRows; ++r) eraseCells(r, 0, numCols);
+            } else if (mode == 1) {
+                for (int r = 0; r < cy; ++r) eraseCells(r, 0, numCols);
+                eraseCells(cy, 0, cx + 1);
+            } else {
+                for (int r = 0; r < numRows; ++r) eraseCells(r, 0, numCols);
+            }
+            break;
+        }
+        case 'K': {
+            int mode = numParams ? params[0] : 0;
+            if (mode == 0) eraseCells(cy, cx, numCols);
+            else if (mode == 1) eraseCells(cy, 0, cx + 1);
+            else eraseCells(cy, 0, numCols);
+            break;
+        }
+        case 'X': eraseCells(cy, cx, cx + n); break;
+
+        case '@': {   // Insertar blancos: el resto de la fila se corre a la derecha
+            n = std::min(n, numCols - cx);
+            for (int c = numCols - 1; c >= cx + n; --c) at(cy, c) = at(cy, c - n);
+            eraseCells(cy, cx, cx + n);
+            cur.cellsWritten += numCols - cx - n;
+            break;
+        }
+        case 'P': {   // Borrar caracteres: el resto de la fila se corre a la izquierda
+            n = std::min(n, numCols - cx);
+            for (int c = cx; c + n < numCols; ++c) at(cy, c) = at(cy, c + n);
+            eraseCells(cy, numCols - n, numCols);
+            cur.cellsWritten += numCols - cx - n;
+            break;
+        }
+        case 'L': if (cy >= top && cy <= bottom) scrollDown(cy, bottom, n); break;
+        case 'M': if (cy >= top && cy <= bottom) scrollUp(cy, bottom, n); break;
+        case 'S': scrollUp(top, bottom, n); break;
+        case 'T': scrollDown(top, bottom, n); break;
+        case 'b': for (int i = 0; i < n; ++i) put(lastCh); break;   // Repetir el último carácter
+
+        case 'm': setGraphics(); break;
+        case 'r': {
+            int t = param(0, 1) - 1, b = param(1, numRows) - 1;
+            if (t < b && b < numRows) {
+                top = t;
+                bottom = b;
+            }
+            moveTo(0, 0);
+            break;
+        }
+        case 's': savedY = cy; savedX = cx; break;
+        case 'u': moveTo(savedY, savedX); break;
+        case 'h': case 'l': case 't': case 'n': case 'c': case 'g': case 'q': break;
+        default: cur.ignored++; break;
+    }
+}
+
+void VirtualTerminal::feed(const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    cur.bytes += len;
+    for (size_t i = 0; i < len; ++i) {
+        uint8_t b = p[i];
+        switch (state) {
+            case GROUND:
+                if (utf8Left > 0 && (b & 0xC0) == 0x80) {
+                    utf8 = (utf8 << 6) | (b & 0x3F);
+                    if (--utf8Left == 0) put(utf8);
+                    continue;
+                }
+                utf8Left = 0;
+                if (b < 0x20) control(b);
+                else if (b < 0x7F) put(b);
+                else if (b >= 0xC0 && b < 0xF8) {
+                    utf8Left = b >= 0xF0 ? 3 : b >= 0xE0 ? 2 : 1;
+                    utf8 = b & (0x3F >> utf8Left);
+                }
+                break;
+
+            case ESCAPE:
+                state = GROUND;
+                if (b == '[') {
+                    state = CSI;
+                    numParams = 0;
+                    params[0] = 0;
+                    privateMode = intermediate = false;
+                } else if (b == ']') {
+                    state = OSC;
+                } else if (b == '(' || b == ')' || b == '*' || b == '+') {
+                    state = CHARSET;
+                    params[0] = b == '(';   // Sólo importa G0
+                } else if (b == '7') {
+                    savedY = cy; savedX = cx;
+                } else if (b == '8') {
+                    moveTo(savedY, savedX);
+                } else if (b == 'M') {   // Índice inverso
+                    if (cy == top) scrollDown(top, bottom, 1);
+                    else moveTo(cy - 1, cx);
+                } else if (b == 'D') {
+                    lineFeed();
+                    cur.cursorMoves++;
+                } else if (b == 'E') {
+                    lineFeed();
+                    moveTo(cy, 0);
+                } else if (b == 'c') {
+                    int r = numRows, c = numCols;
+                    VtStats keep = cur;
+                    resize(r, c);
+                    cur = keep;
+                } else if (b != '=' && b != '>') {
+                    cur.ignored++;
+                }
+                break;
+
+            case CHARSET:
+                if (params[0]) lineDrawing = b == '0';
+                state = GROUND;
+                break;
+
+            case CSI:
+                if (b >= '0' && b <= '9') {
+                    if (numParams == 0) numParams = 1;
+                    int& v = params[numParams - 1];
+                    v = std::min(v * 10 + (b - '0'), 99999);
+                } else if (b == ';' || b == ':') {
+                    if (numParams == 0) numParams = 1;
+                    if (numParams < MAX_PARAMS) params[numParams++] = 0;
+                } else if (b >= 0x3C && b <= 0x3F) {
+                    privateMode = true;
+                } else if (b >= 0x20 && b <= 0x2F) {
+                    intermediate = true;
+                } else if (b >= 0x40 && b <= 0x7E) {
+                    dispatchCsi(b);
+                    state = GROUND;
+                } else if (b == 0x1B) {
+                    cur.ignored++;
+                    state = ESCAPE;
+                } else if (b < 0x20) {
+                    control(b);   // Los controles valen también dentro de una secuencia
+                }
+                break;
+
+            case OSC:   // Título de la ventana y similares: hasta BEL o ESC \ .
+                if (b == 0x07) state = GROUND;
+                else if (b == 0x1B) state = OSC_ESCAPE;
+                break;
+
+            case OSC_ESCAPE:
+                state = b == '\\' ? GROUND : OSC;
+                break;
+        }
+    }
+}
+
+VtStats VirtualTerminal::endFrame() {
+    uint64_t changed = 0;
+    for (size_t i = 0; i < cells.size(); ++i) {
+        if (cells[i] != shown[i]) {
+            shown[i] = cells[i];
+            ++changed;
+        }
+    }
+    VtStats s = cur;
+    s.cellsChanged = changed;
+    cur = VtStats();
+    return s;
+}
+
+std::string VirtualTerminal::rowText(int r) const {
+    std::string out;
+    for (int c = 0; c < numCols; ++c) {
+        uint32_t ch = cell(r, c).ch;
+        if (ch < 0x80) {
+            out += (char)ch;
+        } else if (ch < 0x800) {
+            out += (char)(0xC0 | (ch >> 6));
+            out += (char)(0x80 | (ch & 0x3F));
+        } else if (ch < 0x10000) {
+            out += (char)(0xE0 | (ch >> 12));
+            out += (char)(0x80 | ((ch >> 6) & 0x3F));
+            out += (char)(0x80 | (ch & 0x3F));
+        } else {
+            out += (char)(0xF0 | (ch >> 18));
+            out += (char)(0x80 | ((ch >> 12) & 0x3F));
+            out += (char)(0x80 | ((ch >> 6) & 0x3F));
+            out += (char)(0x80 | (ch & 0x3F));
+        }
+    }
+    return out;
+}
@@ -0,0 +1,117 @@
+/*
+vterm.h - Terminal virtual en memoria. Interpreta lo que un programa le manda a
+una terminal tipo xterm (texto, movimientos del cursor, borrados, atributos)
+sobre una grilla de celdas y cuenta, por frame, lo que recibió: bytes,
+movimientos del cursor, cambios de atributo, celdas escritas y celdas que
+terminaron distintas. Con ella se mide el render sin una terminal real
+(src/term_capture.h).
+
+Cubre lo que usa ncurses con TERM=xterm y xterm-256color. Las secuencias que
+no reconoce se saltean y se cuentan en `ignored`: si aparecen, la terminal
+virtual puede haberse desviado de una real.
+
+No depende de ncurses.
+*/
+#ifndef VTERM_H
+#define VTERM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Atributos de una celda: banderas en los 8 bits bajos, color de frente y de
+// fondo (0-255, VT_COLOR_DEFAULT = el de la terminal) en los siguientes
+const uint32_t VT_BOLD = 1, VT_DIM = 2, VT_ITALIC = 4, VT_UNDERLINE = 8,
+               VT_BLINK = 16, VT_REVERSE = 32, VT_INVISIBLE = 64;
+const uint32_t VT_COLOR_DEFAULT = 256;
+inline uint32_t vtFg(uint32_t attr) { return (attr >> 8) & 0x1FF; }
+inline uint32_t vtBg(uint32_t attr) { return (attr >> 17) & 0x1FF; }
+const uint32_t VT_ATTR_DEFAULT = (VT_COLOR_DEFAULT << 8) | (VT_COLOR_DEFAULT << 17);
+
+struct VtCell {
+    uint32_t ch;     // Código Unicode
+    uint32_t attr;
+    bool operator==(const VtCell& o) const { return ch == o.ch && attr == o.attr; }
+    bool operator!=(const VtCell& o) const { return !(*this == o); }
+};
+
+// Lo recibido en un frame (o acumulado en varios)
+struct VtStats {
+    uint64_t bytes = 0;
+    uint64_t cursorMoves = 0;    // Secuencias de posición y \r, \n, \b, \t
+    uint64_t attrChanges = 0;    // Secuencias SGR
+    uint64_t cellsWritten = 0;   // Celdas escritas o borradas, cambien o no
+    uint64_t cellsChanged = 0;   // Celdas distintas al cerrar el frame
+    uint64_t ignored = 0;        // Secuencias que no se reconocieron
+
+    void add(const VtStats& o) {
+        bytes += o.bytes;
+        cursorMoves += o.cursorMoves;
+        attrChanges += o.attrChanges;
+        cellsWritten += o.cellsWritten;
+        cellsChanged += o.cellsChanged;
+        ignored += o.ignored;
+    }
+};
+
+class VirtualTerminal {
+private:
+    enum ParseState { GROUND, ESCAPE, CSI, OSC, OSC_ESCAPE, CHARSET };
+
+    int numRows = 0, numCols = 0;
+    std::vector<VtCell> cells;
+    std::vector<VtCell> shown;      // Celdas al cerrar el frame anterior
+    int cy = 0, cx = 0;             // Cursor
+    int savedY = 0, savedX = 0;
+    bool wrapPending = false;       // Se escribió en la última columna
+    int top = 0, bottom = 0;        // Región de desplazamiento (inclusive)
+    uint32_t attr = VT_ATTR_DEFAULT;
+    uint32_t lastCh = ' ';
+    bool lineDrawing = false;       // G0 con el juego de caracteres de líneas
+
+    ParseState state = GROUND;
+    static const int MAX_PARAMS = 16;
+    int params[MAX_PARAMS];
+    int numParams = 0;
+    bool privateMode = false;       // CSI ? ... (modos de DEC)
+    bool intermediate = false;
+    uint32_t utf8 = 0;              // Código en armado y bytes que le faltan
+    int utf8Left = 0;
+
+    VtStats cur;
+
+    VtCell& at(int r, int c) { return cells[(size_t)r * numCols + c]; }
+    VtCell blank() const;
+    void put(uint32_t ch);
+    void lineFeed();
+    void scrollUp(int from, int to, int n);
+    void scrollDown(int from, int to, int n);
+    void eraseCells(int r, int c0, int c1);
+    void moveTo(int r, int c);
+    int param(int i, int def) const;
+    void dispatchCsi(uint8_t final);
+    void setGraphics();
+    void control(uint8_t b);
+
+public:
+    explicit VirtualTerminal(int rows = 24, int cols = 80);
+
+    // Cambia el tamaño y deja la pantalla vacía
+    void resize(int rows, int cols);
+
+    // Aplica lo que recibiría la terminal
+    void feed(const void* data, size_t len);
+
+    // Cierra el frame: cuenta las celdas que cambiaron desde el anterior y
+    // devuelve lo recibido en él
+    VtStats endFrame();
+
+    int rows() const { return numRows; }
+    int cols() const { return numCols; }
+    const VtCell& cell(int r, int c) const { return cells[(size_t)r * numCols + c]; }
+    std::string rowText(int r) const;   // En UTF-8
+    void cursor(int& r, int& c) const { r = cy; c = cx; }
+};
+
+#endif // VTERM_H
@@ -0,0 +1,790 @@
+/*
+bench.cpp - Benchmark sin terminal de la simulación. Ejecuta frames completos
+(simFrame) con distintas cantidades de bolas y reporta el tiempo por frame y
+por bola, para verificar que el costo escala linealmente. También mide campos
+de cientos de ladrillos libres en movimiento contra el tiempo de un tick.
+El render se mide sobre una terminal virtual (src/term_capture.h): tiempo de
+dibujo y lo que recibe la terminal por frame con cada forma de dibujar.
+
+Uso: bench [frames]
+*/
+#include "../src/sim.h"
+#include "../src/snapshot.h"
+#include "../src/autopilot.h"
+#include "../src/replay.h"
+#include "../src/live_export.h"
+#include "../src/telemetry.h"
+#include "../src/rl/rl_env.h"
+#include "../src/engine.h"
+#include "../src/game.h"
+#include "../src/term_capture.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <new>
+
+// Contador de asignaciones de memoria (reemplaza el operator new global)
+static std::atomic<long> g_allocs{0};
+
+void* operator new(size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+// Contadores de hardware de fallos de caché (perf_event_open) del hilo que
+// los abre y de los hilos que cree después. Si la máquina o el kernel no los
+// ofrecen (máquinas virtuales, perf_event_paranoid) se informan como "n/d"
+struct CacheCounters {
+    int fdMiss = -1, fdRef = -1;
+
+    static int openOne(uint64_t config) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    CacheCounters() {
+        fdMiss = openOne(PERF_COUNT_HW_CACHE_MISSES);
+        fdRef = openOne(PERF_COUNT_HW_CACHE_REFERENCES);
+        for (int fd : {fdMiss, fdRef}) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+    ~CacheCounters() {
+        if (fdMiss >= 0) close(fdMiss);
+        if (fdRef >= 0) close(fdRef);
+    }
+    CacheCounters(const CacheCounters&) = delete;
+    CacheCounters& operator=(const CacheCounters&) = delete;
+
+    // Lo contado hasta ahora; -1 si el contador no se pudo abrir. Los hilos
+    // hijos suman lo suyo al terminar (hay que leer después del join)
+    static long long value(int fd) {
+        long long v = 0;
+        if (fd < 0 || read(fd, &v, sizeof(v)) != (ssize_t)sizeof(v)) return -1;
+        return v;
+    }
+    long long misses() const { return value(fdMiss); }
+    long long references() const { return value(fdRef); }
+};
+
+// Cantidad por unidad, o "n/d" si no hay contador
+static const char* perUnit(char* buf, size_t len, long long count, double units) {
+    if (count < 0 || units <= 0) std::snprintf(buf, len, "n/d");
+    else std::snprintf(buf, len, "%.1f", count / units);
+    return buf;
+}
+
+// Sin terminal se usa una pantalla fija de 120x40
+static void setupHeadless(GameConfig& cfg, int launchBalls) {
+    initGameConfig(cfg, 1, launchBalls);
+    cfg.tick_ms = 0;
+    seedRandom(cfg, 1234);
+    setupPlayArea(cfg, 40, 120);
+    resetLevel(cfg);
+}
+
+// Corre `frames` frames manteniendo las bolas en juego; devuelve ns totales
+// y acumula en ballFrames la cantidad de bola-frames simulados
+static double runFrames(GameConfig& cfg, int frames, double& ballFrames,
+                        void (*frameFn)(GameConfig&) = simFrame) {
+    ballFrames = 0.0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f) {
+        if (!cfg.ballLaunched) simLaunch(cfg);
+        cfg.lives = 3;                       // el benchmark nunca pierde
+        frameFn(cfg);
+        if (cfg.restartRequested || !cfg.running) {
+            cfg.level = 1;
+            resetLevel(cfg);
+        }
+        ballFrames += cfg.balls.count;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count();
+}
+
+// Etapas especializadas: la misma partida de un jugador con las etapas para
+// cualquier cantidad de jugadores y con las de un jugador. El estado final
+// tiene que ser idéntico
+static void runModeBench(int launchBalls, int frames) {
+    GameConfig any{}, one{};
+    setupHeadless(any, launchBalls);
+    setupHeadless(one, launchBalls);
+    double ballFrames;
+    double nsAny = runFrames(any, frames, ballFrames, simFrameT<PLAYERS_ANY>);
+    double nsOne = runFrames(one, frames, ballFrames, simFrameT<1>);
+
+    std::vector<uint8_t> a(1 << 20), b(1 << 20);
+    size_t na = serializeState(any, a.data(), a.size());
+    size_t nb = serializeState(one, b.data(), b.size());
+    bool same = na == nb && std::memcmp(a.data(), b.data(), na) == 0;
+    std::printf("%-10d %14.1f %14.1f %10.2f %6s\n", launchBalls, nsAny / frames, nsOne / frames,
+                nsAny / nsOne, same ? "ok" : "NO");
+}
+
+// Máximo de tableros en versus (como MAX_BOARDS del juego)
+static const int BENCH_MAX_BOARDS = 4;
+
+// Versus: cada tablero en su hilo, sincronizados frame a frame con una
+// barrera (como el compositor), para medir el tiempo de un frame compuesto
+struct VersusBench {
+    GameConfig cfg;
+    pthread_barrier_t* barrier;
+    int frames;
+};
+
+static void* versusWorker(void* arg) {
+    auto* vb = (VersusBench*)arg;
+    double ballFrames = 0.0;
+    for (int f = 0; f < vb->frames; ++f) {
+        runFrames(vb->cfg, 1, ballFrames);
+        pthread_barrier_wait(vb->barrier);
+    }
+    return nullptr;
+}
+
+static double runVersusBench(int boards, int frames, int ballsPerBoard, long long& misses,
+                             long long& refs) {
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, nullptr, boards);
+    VersusBench vb[BENCH_MAX_BOARDS];
+    pthread_t th[BENCH_MAX_BOARDS];
+
+    for (int i = 0; i < boards; ++i) {
+        setupHeadless(vb[i].cfg, ballsPerBoard);
+        vb[i].barrier = &barrier;
+        vb[i].frames = frames;
+    }
+    CacheCounters counters;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < boards; ++i) pthread_create(&th[i], nullptr, versusWorker, &vb[i]);
+    for (int i = 0; i < boards; ++i) pthread_join(th[i], nullptr);
+    auto t1 = std::chrono::steady_clock::now();
+    misses = counters.misses();
+    refs = counters.references();
+
+    pthread_barrier_destroy(&barrier);
+    return std::chrono::duration<double, std::nano>(t1 - t0).count();
+}
+
+// Power-ups y disparos: se mantienen `live` entidades vivas (la mitad de cada
+// tipo) reponiendo las que se pierden, y se mide simEntities por entidad
+static void runEntityBench(int live, int frames) {
+    GameConfig cfg{};
+    setupHeadless(cfg, 1);
+    simLaunch(cfg);
+    double ns = 0.0, entityFrames = 0.0;
+    long a0 = g_allocs.load();
+    for (int f = 0; f < frames; ++f) {
+        while (cfg.powerUps.live < live / 2) {
+            float x = (float)(cfg.x0 + 2 + simRandom(cfg) % (cfg.w - 4));
+            float y = (float)(cfg.y0 + 2 + simRandom(cfg) % (cfg.h - 6));
+            cfg.powerUps.spawn(x, y, 0.3f, (int)(simRandom(cfg) % POWER_COUNT));
+        }
+        while (cfg.shots.live < live - live / 2) {
+            float x = (float)(cfg.x0 + 2 + simRandom(cfg) % (cfg.w - 4));
+            cfg.shots.spawn(x, cfg.y1 - 3.0f, -1.0f, 0);
+        }
+        if (cfg.restartRequested) { cfg.level = 1; resetLevel(cfg); simLaunch(cfg); }
+        cfg.balls.count = 1;                 // el multi-ball no cuenta aquí
+        entityFrames += cfg.powerUps.live + cfg.shots.live;
+
+        auto t0 = std::chrono::steady_clock::now();
+        simEntities(cfg);
+        simState(cfg);
+        auto t1 = std::chrono::steady_clock::now();
+        ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+    }
+    long allocs = g_allocs.load() - a0;
+    std::printf("%-10d %14.1f %16.2f %10ld\n", live, ns / frames, ns / entityFrames, allocs);
+}
+
+// Ladrillos libres: `n` ladrillos en filas que van y vienen (una de cada tres
+// gira) sobre un área de 240x64, con `balls` bolas rebotando entre ellos. El
+// mismo campo quieto da el costo sin movimiento; el frame completo se compara
+// con un tick de 60 fps
+static double runFreeField(int n, int balls, int frames, bool moving, double& avgBalls, long& allocs) {
+    GameConfig cfg{};
+    initGameConfig(cfg, 1, balls);
+    cfg.tick_ms = 0;
+    seedRandom(cfg, 1234);
+    setupPlayAreaRect(cfg, 0, 0, 63, 241);
+    resetLevel(cfg);
+    for (auto& row : cfg.grid) {
+        for (Brick& b : row) b.hp = 0;
+    }
+
+    const int perRow = 16;
+    const int rows = (n + perRow - 1) / perRow;
+    std::vector<FreeBrickDef> defs(n);
+    for (int i = 0; i < n; ++i) {
+        int r = i / perRow, c = i % perRow;
+        FreeBrickDef& d = defs[i];
+        d.x = 2.0f + c * 4.75f;
+        d.y = (float)r * 48 / rows;
+        d.w = 3;
+        d.brick = Brick{200, '%', 1};   // No se terminan durante la medición
+        d.path = !moving ? PATH_STILL : r % 3 == 2 ? PATH_ORBIT : PATH_LINE;
+        d.dx = d.path == PATH_ORBIT ? 2.0f : (r % 2 ? -1.5f : 1.5f);
+        d.dy = d.path == PATH_ORBIT ? 1.0f : 0.0f;
+        d.period = 90 + 7 * r;
+        d.phase = 13 * c;
+    }
+    setFreeBricks(cfg, defs.data(), n);
+
+    double ballFrames = 0.0;
+    runFrames(cfg, frames / 10, ballFrames);       // calentamiento
+    long a0 = g_allocs.load();
+    double ns = runFrames(cfg, frames, ballFrames);
+    allocs = g_allocs.load() - a0;
+    avgBalls = ballFrames / frames;
+    return ns / frames;
+}
+
+static void runFreeBrickBench(int n, int balls, int frames) {
+    double avgBalls, still;
+    long allocs;
+    still = runFreeField(n, balls, frames, false, avgBalls, allocs);
+    double ns = runFreeField(n, balls, frames, true, avgBalls, allocs);
+    std::printf("%-10d %12.1f %12.1f %12.1f %10.3f %8ld\n", n, avgBalls, still, ns,
+                100.0 * ns / 16.667e6, allocs);
+}
+
+// Bus de eventos: el productor publica frames de `perFrame` eventos a dos
+// suscriptores; uno duerme en su cola en otro hilo y el otro la vacía en
+// línea (como el render). Reporta ns por evento publicado y descartados
+struct EventConsumer {
+    EventQueue* queue;
+    std::atomic<bool>* stop;
+    unsigned long received = 0;
+};
+
+static void* eventConsumer(void* arg) {
+    auto* ec = (EventConsumer*)arg;
+    GameEvent ev;
+    while (!ec->stop->load()) {
+        ec->queue->wait();
+        while (ec->queue->pop(ev)) ec->received++;
+    }
+    while (ec->queue->pop(ev)) ec->received++;
+    return nullptr;
+}
+
+static void runEventBench(int perFrame, int frames) {
+    EventBus bus;
+    EventQueue threaded(4096), inlineQ(4096);
+    bus.subscribe(&threaded, EV_ALL);
+    bus.subscribe(&inlineQ, EV_ALL, false);
+
+    std::atomic<bool> stop{false};
+    EventConsumer ec{&threaded, &stop};
+    pthread_t th;
+    pthread_create(&th, nullptr, eventConsumer, &ec);
+
+    FrameEvents events;
+    events.init();
+    GameEvent ev;
+    unsigned long inlineReceived = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f) {
+        for (int e = 0; e < perFrame; ++e) {
+            events.push((EventType)(e % EV_COUNT), e, e, f, (unsigned long)f);
+        }
+        bus.publish(events);
+        while (inlineQ.pop(ev)) inlineReceived++;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    stop.store(true);
+    bus.notifyAll();
+    pthread_join(th, nullptr);
+
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+    std::printf("%-10d %14.2f %12lu %12lu\n", perFrame, ns / ((double)perFrame * frames),
+                ec.received + inlineReceived, threaded.droppedCount() + inlineQ.droppedCount());
+}
+
+// Snapshots: tiempo de guardar/restaurar el estado completo, y verificación
+// de que restaurar y volver a simular reproduce exactamente la misma partida
+static void runSnapshotBench(int balls, int reps) {
+    GameConfig cfg{};
+    setupHeadless(cfg, balls);
+    double ballFrames = 0.0;
+    runFrames(cfg, 50, ballFrames);
+
+    std::vector<uint8_t> buf(snapshotMaxSize(cfg) + 64 * 1024);
+    size_t len = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i) len = serializeState(cfg, buf.data(), buf.size());
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i) deserializeState(cfg, buf.data(), len);
+    auto t2 = std::chrono::steady_clock::now();
+
+    // Determinismo: dos corridas desde el mismo snapshot terminan igual
+    std::vector<uint8_t> a(buf.size()), b(buf.size());
+    runFrames(cfg, 200, ballFrames);
+    size_t lenA = serializeState(cfg, a.data(), a.size());
+    deserializeState(cfg, buf.data(), len);
+    runFrames(cfg, 200, ballFrames);
+    size_t lenB = serializeState(cfg, b.data(), b.size());
+    bool same = lenA == lenB && std::memcmp(a.data(), b.data(), lenA) == 0;
+
+    // Rebobinado: grabar cada frame y volver 50 frames atrás
+    RewindBuffer rewind;
+    for (int f = 0; f < 300; ++f) {
+        runFrames(cfg, 1, ballFrames);
+        rewind.record(cfg);
+    }
+    auto t3 = std::chrono::steady_clock::now();
+    int back = rewind.rewind(cfg, 50);
+    auto t4 = std::chrono::steady_clock::now();
+
+    std::printf("%-10d %10zu %12.2f %12.2f %12.2f %6s\n", balls, len,
+                std::chrono::duration<double, std::micro>(t1 - t0).count() / reps,
+                std::chrono::duration<double, std::micro>(t2 - t1).count() / reps,
+                back > 0 ? std::chrono::duration<double, std::micro>(t4 - t3).count() : 0.0,
+                same ? "ok" : "FALLO");
+}
+
+// Asignaciones de memoria en las operaciones que deben reutilizar lo que la
+// partida reservó al iniciar: cambios de nivel, snapshot de render y frames
+static void runAllocBench(int reps) {
+    GameConfig cfg{};
+    setupHeadless(cfg, 64);
+    GameConfig local{};
+    local = cfg;                               // primera copia: reserva
+
+    long a0 = g_allocs.load();
+    for (int i = 0; i < reps; ++i) {
+        cfg.level = 1 + i % levelCount();
+        resetLevel(cfg);
+    }
+    long a1 = g_allocs.load();
+    for (int i = 0; i < reps; ++i) local = cfg;
+    long a2 = g_allocs.load();
+    double ballFrames = 0.0;
+    runFrames(cfg, reps, ballFrames);
+    long a3 = g_allocs.load();
+
+    std::printf("%-22s %8d %10ld\n", "cambios de nivel", reps, a1 - a0);
+    std::printf("%-22s %8d %10ld\n", "snapshots de render", reps, a2 - a1);
+    std::printf("%-22s %8d %10ld\n", "frames", reps, a3 - a2);
+}
+
+// Partidas completas sin terminal jugadas por el autopiloto (modo de carga):
+// cada sesión tiene su semilla y corre hasta ganar, perder o `maxFrames`.
+// Devuelve las sesiones estancadas: las que llegaron a `maxFrames` sin sumar
+// puntos en los últimos BENCH_STALL_FRAMES (el autopiloto quedó en un ciclo)
+static const int BENCH_STALL_FRAMES = 10 * AUTOPILOT_STALL_FRAMES;
+
+static long runAutopilotBench(int sessions, int maxFrames) {
+    long frames = 0, won = 0, lost = 0, stalled = 0;
+    unsigned long predictions = 0, substeps = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int s = 0; s < sessions; ++s) {
+        GameConfig cfg{};
+        setupHeadless(cfg, 1);
+        seedRandom(cfg, 1000 + s);
+        Autopilot pilot;
+        for (int f = 0; f < maxFrames && cfg.running; ++f) {
+            autopilotStep(pilot, cfg);
+            simFrame(cfg);
+            substeps += cfg.substeps;
+            if (cfg.restartRequested) resetLevel(cfg);   // nivel siguiente
+            ++frames;
+        }
+        won += cfg.won;
+        lost += cfg.lost;
+        if (cfg.running && pilot.stallFrames >= BENCH_STALL_FRAMES) ++stalled;
+        predictions += pilot.predictions;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+    std::printf("%-10d %12ld %10.1f %12.3f %10.3f %8ld %8ld %10ld\n", sessions, frames, ns / frames,
+                (double)predictions / frames, (double)substeps / frames, won, lost, stalled);
+    return stalled;
+}
+
+// Graba una partida del autopiloto como la grabaría el juego: lo que decide
+// antes de cada frame se traduce a comandos de entrada
+static void recordAutopilotSession(InputRecording& rec, uint32_t seed, int maxFrames) {
+    rec.clear();
+    rec.seed = seed;
+    rec.screenRows = 40;
+    rec.screenCols = 120;
+    GameConfig cfg{};
+    setupRecordedGame(cfg, rec);
+    Autopilot pilot;
+    for (int f = 0; f < maxFrames && cfg.running; ++f) {
+        bool launched = cfg.ballLaunched;
+        int dir = cfg.paddles[0].desiredDir;
+        autopilotStep(pilot, cfg);
+        if (!launched && cfg.ballLaunched) {
+            rec.commands.push_back(InputCommand{rec.frames, IN_ACTION, 0, 0});
+        } else if (launched && cfg.laserFrames > 0) {
+            rec.commands.push_back(InputCommand{rec.frames, IN_ACTION, 0, 0});
+        }
+        if (cfg.paddles[0].desiredDir != dir) {
+            int d = cfg.paddles[0].desiredDir;
+            rec.commands.push_back(InputCommand{rec.frames, (uint8_t)(d ? IN_MOVE : IN_RELEASE), 0, (int16_t)d});
+        }
+        if (cfg.restartRequested) resetLevel(cfg);
+        simFrame(cfg);
+        rec.frames++;
+    }
+    rec.finalScore = cfg.score;
+}
+
+// Validación de puntajes: repite las grabaciones en paralelo y cuenta las que
+// llegan al mismo puntaje
+static void runReplayBench(const std::vector<InputRecording>& recs, int threads) {
+    std::vector<int> scores;
+    auto t0 = std::chrono::steady_clock::now();
+    unsigned long frames = replayParallel(recs, scores, threads);
+    auto t1 = std::chrono::steady_clock::now();
+    double secs = std::chrono::duration<double>(t1 - t0).count();
+    int match = 0;
+    for (size_t i = 0; i < recs.size(); ++i) match += (scores[i] == recs[i].finalScore);
+    std::printf("%-10zu %-8d %12lu %14.0f %8.3f %8d\n", recs.size(), threads, frames,
+                frames / secs, secs, match);
+}
+
+// Telemetría: eventos de partidas del autopiloto escritos en un .bkt y
+// leídos de vuelta, completos y sólo con las columnas que usa el análisis
+static void runTelemetryBench(int sessions, int maxFrames) {
+    std::vector<GameEvent> events;
+    for (int s = 0; s < sessions; ++s) {
+        GameConfig cfg{};
+        setupHeadless(cfg, 1);
+        seedRandom(cfg, 1000 + s);
+        Autopilot pilot;
+        uint32_t frame = events.empty() ? 0 : events.back().frame;
+        for (int f = 0; f < maxFrames && cfg.running; ++f) {
+            autopilotStep(pilot, cfg);
+            simFrame(cfg);
+            ++frame;
+            if (cfg.restartRequested) resetLevel(cfg);
+            for (GameEvent ev : cfg.events.list) {
+                ev.frame = frame;
+                events.push_back(ev);
+            }
+            cfg.events.clear();
+        }
+    }
+
+    const char* path = "/tmp/breakout-bench.bkt";
+    auto t0 = std::chrono::steady_clock::now();
+    TelemetryWriter out;
+    out.open(path, TelemetryHeader{});
+    for (const GameEvent& ev : events) out.add(ev.type, ev.frame, ev.a, ev.b, ev.value);
+    out.close();
+    auto t1 = std::chrono::steady_clock::now();
+    double writeNs = std::chrono::duration<double, std::nano>(t1 - t0).count();
+
+    double readNs[2];
+    const uint32_t masks[2] = {TC_ALL, columnBit(TC_TYPE) | columnBit(TC_FRAME) | columnBit(TC_VALUE)};
+    unsigned long rows = 0;
+    for (int k = 0; k < 2; ++k) {
+        TelemetryReader in;
+        TelemetryBatch batch;
+        rows = 0;
+        auto r0 = std::chrono::steady_clock::now();
+        in.open(path);
+        while (in.next(batch, masks[k])) rows += batch.rows;
+        auto r1 = std::chrono::steady_clock::now();
+        readNs[k] = std::chrono::duration<double, std::nano>(r1 - r0).count();
+    }
+    std::remove(path);
+
+    double n = std::max<double>(1, events.size());
+    std::printf("%-10zu %12.2f %10.1f %12.1f %12.1f %8s\n", events.size(), (double)out.byteCount() / n,
+                writeNs / n, readNs[0] / n, readNs[1] / n, rows == events.size() ? "sí" : "NO");
+}
+
+// Exportación del estado a memoria compartida: costo de publicar un frame,
+// sin lectores y con otro hilo leyendo el segmento sin pausa
+struct LiveReaderArgs {
+    const LiveState* st;
+    std::atomic<bool> stop{false};
+    long reads = 0, failed = 0;
+};
+
+static void* liveReader(void* arg) {
+    auto* a = (LiveReaderArgs*)arg;
+    LiveData d;
+    while (!a->stop.load(std::memory_order_relaxed)) {
+        if (readLiveState(a->st, d)) ++a->reads;
+        else ++a->failed;
+    }
+    return nullptr;
+}
+
+static void runLiveBench(int reps) {
+    LiveExport live;
+    if (!live.open()) {
+        std::printf("(no se pudo crear el segmento)\n");
+        return;
+    }
+    GameConfig cfg{};
+    setupHeadless(cfg, 16);
+    LiveTimings t;
+
+    // El lector mapea el segmento por su cuenta, como el monitor
+    char name[64];
+    std::snprintf(name, sizeof(name), "/%s%d", LIVE_PREFIX, (int)getpid());
+    int fd = shm_open(name, O_RDONLY, 0);
+    const LiveState* st = (const LiveState*)mmap(nullptr, sizeof(LiveState), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    for (int readers = 0; readers <= 1; ++readers) {
+        LiveReaderArgs args;
+        args.st = st;
+        pthread_t th;
+        if (readers) pthread_create(&th, nullptr, liveReader, &args);
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < reps; ++i) live.publish(cfg, (uint64_t)i, t);
+        auto t1 = std::chrono::steady_clock::now();
+        args.stop.store(true);
+        if (readers) pthread_join(th, nullptr);
+        double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+        std::printf("%-10d %14.1f %12ld %12ld\n", readers, ns / reps, args.reads, args.failed);
+    }
+    munmap((void*)st, sizeof(LiveState));
+}
+
+// Hilos de una sesión: asignar y recuperar ENGINE_THREADS hilos del motor
+// contra crearlos y esperarlos con pthread. Cada trabajo avisa que arrancó y
+// vuelve enseguida, como una sesión que se detiene apenas empieza
+static void* sessionJob(void* arg) {
+    ((std::atomic<int>*)arg)->fetch_add(1);
+    return nullptr;
+}
+
+static void runEngineBench(int sessions) {
+    std::atomic<int> started{0};
+    EngineJob jobs[ENGINE_THREADS];
+    for (EngineJob& j : jobs) j = EngineJob{sessionJob, &started};
+    EngineThreads engine;
+    engine.start();
+
+    for (bool pooled : {true, false}) {
+        double attachNs = 0.0, readyNs = 0.0, detachNs = 0.0;
+        pthread_t th[ENGINE_THREADS];
+        for (int s = 0; s < sessions; ++s) {
+            started.store(0);
+            auto t0 = std::chrono::steady_clock::now();
+            if (pooled) engine.attach(jobs, ENGINE_THREADS);
+            else for (int i = 0; i < ENGINE_THREADS; ++i) pthread_create(&th[i], nullptr, sessionJob, &started);
+            auto t1 = std::chrono::steady_clock::now();
+            while (started.load() < ENGINE_THREADS) sched_yield();
+            auto t2 = std::chrono::steady_clock::now();
+            if (pooled) engine.detach();
+            else for (int i = 0; i < ENGINE_THREADS; ++i) pthread_join(th[i], nullptr);
+            auto t3 = std::chrono::steady_clock::now();
+            attachNs += std::chrono::duration<double, std::nano>(t1 - t0).count();
+            readyNs += std::chrono::duration<double, std::nano>(t2 - t0).count();
+            detachNs += std::chrono::duration<double, std::nano>(t3 - t2).count();
+        }
+        std::printf("%-16s %12.1f %14.1f %12.1f\n", pooled ? "motor" : "pthread_create",
+                    attachNs / sessions / 1e3, readyNs / sessions / 1e3, detachNs / sessions / 1e3);
+    }
+}
+
+// Render del juego normal sobre una terminal virtual de 40x120: en sus
+// ventanas (como el juego), directo sobre stdscr (si las ventanas no entran)
+// y volviendo a dibujar todo en cada frame. El tiempo es el del dibujo y el
+// refresh; lo demás, lo que recibió la terminal por frame
+enum RenderMode { RENDER_WINDOWS, RENDER_STDSCR, RENDER_FULL };
+
+static void runRenderBench(RenderMode mode, int launchBalls, int frames) {
+    static const char* const names[] = {"ventanas", "stdscr", "completo"};
+    TermCapture cap;
+    if (!cap.open(40, 120)) {
+        std::printf("%-10s %-10d sin terminfo para xterm\n", names[mode], launchBalls);
+        return;
+    }
+    initRenderColors();
+
+    GameConfig cfg{};
+    setupHeadless(cfg, launchBalls);
+    BoardWindows windows;
+    bool useWindows = mode == RENDER_WINDOWS && openBoardWindows(windows, cfg);
+    BrickRows bricks;
+    VtStats total;
+    double ns = 0.0;
+
+    for (int f = -1; f < frames; ++f) {
+        if (!cfg.ballLaunched) simLaunch(cfg);
+        cfg.lives = 3;
+        simFrame(cfg);
+        for (const GameEvent& ev : cfg.events.list) noteBrickEvent(ev, bricks);
+        if (cfg.restartRequested || !cfg.running) {
+            cfg.level = 1;
+            resetLevel(cfg);
+            bricks.valid = false;
+        }
+        updateBrickRows(cfg, bricks);
+
+        // El frame -1 dibuja el marco y no se cuenta
+        bool redrawAll = f < 0 || mode == RENDER_FULL;
+        auto t0 = std::chrono::steady_clock::now();
+        if (useWindows) renderWindows(windows, cfg, bricks, redrawAll);
+        else renderStdscr(cfg, bricks, redrawAll);
+        auto t1 = std::chrono::steady_clock::now();
+        VtStats s = cap.frame();
+        if (f < 0) continue;
+        ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+        total.add(s);
+    }
+    closeBoardWindows(windows);
+    cap.close();
+
+    double n = frames;
+    std::printf("%-10s %-6d %10.0f %10.0f %8.1f %8.1f %10.1f %10.1f %8llu\n", names[mode], launchBalls,
+                ns / n, total.bytes / n, total.cursorMoves / n, total.attrChanges / n,
+                total.cellsWritten / n, total.cellsChanged / n, (unsigned long long)total.ignored);
+}
+
+// Entorno de RL: pasos de entorno por segundo con acciones pseudoaleatorias
+static double runEnvBench(int numEnvs, int threads, int steps, long long& misses) {
+    CacheCounters counters;   // Antes del entorno, para contar a sus hilos
+    BreakoutVecEnv env(numEnvs, threads);
+    long long m0 = counters.misses();
+    std::vector<uint32_t> seeds(numEnvs);
+    std::vector<int> actions(numEnvs);
+    for (int i = 0; i < numEnvs; ++i) seeds[i] = 1000 + i;
+    env.reset(seeds.data());
+
+    unsigned int rng = 42;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int s = 0; s < steps; ++s) {
+        for (int i = 0; i < numEnvs; ++i) {
+            rng = rng * 1664525u + 1013904223u;
+            actions[i] = (int)(rng >> 30);           // 0..3
+        }
+        env.step(actions.data());
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    misses = counters.misses();
+    if (misses >= 0) misses -= m0;
+    double secs = std::chrono::duration<double>(t1 - t0).count();
+    return (double)numEnvs * steps / secs;
+}
+
+int main(int argc, char** argv) {
+    int frames = (argc > 1) ? std::atoi(argv[1]) : 20000;
+
+    const int counts[] = {1, 16, 64, 256, 1024, 4096};
+
+    std::printf("%-10s %12s %14s %14s\n", "bolas", "bolas prom.", "ns/frame", "ns/bola-frame");
+    for (int n : counts) {
+        GameConfig cfg{};
+        setupHeadless(cfg, n);
+        double ballFrames = 0.0;
+        runFrames(cfg, frames / 10, ballFrames);     // calentamiento
+        double ns = runFrames(cfg, frames, ballFrames);
+
+        double avgBalls = ballFrames / frames;
+        std::printf("%-10d %12.1f %14.1f %14.2f\n", n, avgBalls, ns / frames,
+                    ballFrames > 0 ? ns / ballFrames : 0.0);
+    }
+
+    std::printf("\n%-10s %14s %14s %10s %6s\n", "bolas", "ns genérico", "ns 1 jugador",
+                "mejora", "igual");
+    for (int n : {1, 16, 256, 4096}) runModeBench(n, frames);
+
+    char b1[32], b2[32];
+    std::printf("\n%-10s %14s %16s %16s   %s\n", "tableros", "ns/frame", "fallos caché/fr", "refs caché/fr",
+                "(256 bolas c/u)");
+    for (int boards = 1; boards <= BENCH_MAX_BOARDS; boards *= 2) {
+        long long misses, refs;
+        double ns = runVersusBench(boards, frames / 4, 256, misses, refs);
+        std::printf("%-10d %14.1f %16s %16s\n", boards, ns / (frames / 4),
+                    perUnit(b1, sizeof(b1), misses, frames / 4), perUnit(b2, sizeof(b2), refs, frames / 4));
+    }
+
+    std::printf("\n%-16s %12s %14s %12s   (%d hilos por sesión)\n", "hilos", "us asignar",
+                "us en marcha", "us liberar", ENGINE_THREADS);
+    runEngineBench(1000);
+
+    std::printf("\n%-10s %-6s %10s %10s %8s %8s %10s %10s %8s\n", "render", "bolas", "ns/frame",
+                "bytes/fr", "movim.", "atrib.", "celdas", "cambiadas", "ignor.");
+    for (int n : {1, 64}) {
+        for (RenderMode m : {RENDER_WINDOWS, RENDER_STDSCR, RENDER_FULL}) runRenderBench(m, n, frames / 10);
+    }
+
+    std::printf("\n%-10s %14s %16s %10s\n", "entidades", "ns/frame", "ns/entidad-frame", "mallocs");
+    for (int n : {64, 256, 512}) runEntityBench(n, frames / 4);
+
+    std::printf("\n%-10s %12s %12s %12s %10s %8s\n", "libres", "bolas prom.", "ns quietos",
+                "ns móviles", "% tick", "mallocs");
+    for (int n : {128, 512, 1024}) runFreeBrickBench(n, 64, frames / 4);
+
+    std::printf("\n%-10s %14s %12s %12s\n", "eventos/fr", "ns/evento", "recibidos", "descartados");
+    for (int n : {4, 64}) runEventBench(n, frames);
+
+    std::printf("\n%-10s %10s %12s %12s %12s %6s\n", "bolas", "bytes",
+                "us guardar", "us cargar", "us rebobinar", "igual");
+    for (int n : {1, 256, 4096}) runSnapshotBench(n, 1000);
+
+    std::printf("\n%-22s %8s %10s\n", "operación", "veces", "mallocs");
+    runAllocBench(1000);
+
+    std::printf("\n%-10s %12s %10s %12s %10s %8s %8s %10s\n", "sesiones", "frames",
+                "ns/frame", "pred/frame", "sub/frame", "ganadas", "perdidas", "estancadas");
+    long stalled = runAutopilotBench(200, frames * 3);
+
+    std::printf("\n%-10s %12s %10s %12s %12s %8s\n", "eventos", "bytes/ev",
+                "ns escr.", "ns leer", "ns 3 col.", "leídos");
+    runTelemetryBench(200, frames * 3);
+
+    std::printf("\n%-10s %14s %12s %12s\n", "lectores", "ns/publicar", "lecturas", "fallidas");
+    runLiveBench(frames * 50);
+
+    int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    std::vector<InputRecording> recs(200);
+    for (size_t i = 0; i < recs.size(); ++i) recordAutopilotSession(recs[i], 1000 + (uint32_t)i, frames * 3);
+    std::printf("\n%-10s %-8s %12s %14s %8s %8s\n", "grabac.", "hilos", "frames", "frames/s",
+                "s", "iguales");
+    for (int threads : {1, cores}) {
+        runReplayBench(recs, threads);
+        if (cores == 1) break;
+    }
+
+    std::printf("\n%-10s %-8s %16s %16s\n", "entornos", "hilos", "pasos/s", "fallos caché/paso");
+    for (int threads : {1, cores}) {
+        long long misses;
+        double sps = runEnvBench(1024, threads, frames / 40, misses);
+        std::printf("%-10d %-8d %16.0f %16s\n", 1024, threads, sps,
+                    perUnit(b1, sizeof(b1), misses, 1024.0 * (frames / 40)));
+        if (cores == 1) break;
+    }
+
+    if (stalled > 0) {
+        std::printf("\n%ld partidas del autopiloto quedaron en un ciclo sin sumar puntos\n", stalled);
+        return 1;
+    }
+    return 0;
+}
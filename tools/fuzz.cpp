@@ -0,0 +1,558 @@
+/*
+fuzz.cpp - Busca estados en que la física falla. Juega partidas sin terminal
+con semillas, entradas, jugadores, bolas por lanzamiento, nivel inicial y
+velocidad de la bola al azar, repartidas entre todos los núcleos, y verifica
+en cada subpaso y en cada frame que:
+  - toda bola quede dentro del área (x0..x1, y0..y1)
+  - ninguna bola pase sobre un ladrillo vivo o una paleta sin tocarlo (avance
+    de más de una celda en un subpaso)
+  - toda bola en juego respete las velocidades mínimas de normalizeAngle y la
+    partida no pase cientos de frames sin que una bola toque una paleta o un
+    ladrillo o se pierda una vida (bola rebotando de lado a lado)
+  - el score no baje (salvo al rebobinar o empezar un nivel) y el contador de
+    ladrillos vivos coincida con la grilla
+
+Cada partida se graba como entrada (src/replay.h). Ante una violación la
+grabación se achica (se cortan los frames posteriores y se quitan comandos
+mientras la violación se siga produciendo) y se guarda en el directorio de
+salida; con -r se repite con las mismas verificaciones.
+
+Uso: fuzz [-j hilos] [-n partidas] [-f frames] [-t segundos] [-s semilla] [-o dir]
+     fuzz -r grabación.bkr ...
+     -n  partidas a jugar (0 = sin límite, por defecto; termina con -t o Ctrl+C)
+     -f  frames por partida (20000)
+     -t  segundos de búsqueda (0 = sin límite)
+     -s  semilla de la primera partida; cada partida usa la siguiente
+     -o  directorio de las grabaciones (fuzz/)
+     -m  grabaciones guardadas por tipo de violación (3)
+*/
+#include "../src/autopilot.h"
+#include "../src/replay.h"
+#include <pthread.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+enum Violation {
+    V_NONE,
+    V_BOUNDS,          // Bola fuera del área
+    V_BRICK_SKIPPED,   // Pasó sobre un ladrillo vivo sin golpearlo
+    V_PADDLE_SKIPPED,  // Atravesó una paleta bajando
+    V_ANGLE,           // Velocidad bajo los mínimos de normalizeAngle
+    V_STUCK,           // Demasiados frames sin paleta, ladrillo ni vida perdida
+    V_SCORE,           // El score bajó
+    V_BRICK_COUNT,     // bricksAlive no coincide con los ladrillos vivos
+    V_COUNT
+};
+
+// También son los nombres de los archivos
+static const char* VIOLATION_NAMES[V_COUNT] = {
+    "ninguna", "fuera-del-area", "ladrillo-atravesado", "paleta-atravesada",
+    "angulo-minimo", "sin-progreso", "score-decreciente", "ladrillos-vivos"
+};
+
+/*
+VERIFICACIONES
+*/
+
+struct Checker {
+    std::vector<float> px, py;   // Posiciones antes de mover las bolas
+    Violation found = V_NONE;
+    uint32_t frame = 0;          // Frame de la grabación en curso
+    char detail[192] = {0};
+    int prevScore = 0;
+    int idle = 0;                // Frames en juego sin progreso
+    int idleLimit = 0;
+};
+
+static void fail(Checker& ck, Violation v, const char* fmt, ...) {
+    if (ck.found != V_NONE) return;
+    ck.found = v;
+    va_list args;
+    va_start(args, fmt);
+    std::vsnprintf(ck.detail, sizeof(ck.detail), fmt, args);
+    va_end(args);
+}
+
+static void resetChecker(Checker& ck, const GameConfig& cfg) {
+    ck.px.resize(cfg.balls.capacity);
+    ck.py.resize(cfg.balls.capacity);
+    ck.found = V_NONE;
+    ck.frame = 0;
+    ck.detail[0] = 0;
+    ck.prevScore = cfg.score;
+    ck.idle = 0;
+    // Con la velocidad mínima (0.5) y la componente vertical mínima, una bola
+    // cruza la altura del área ida y vuelta en este tiempo
+    ck.idleLimit = (int)(4 * cfg.h / (BALL_MIN_VY * 0.5f)) + 64;
+}
+
+static int roundCell(float v) { return (int)std::round(v); }
+
+// Recorre el tramo que la bola i avanzó en este subpaso. Si saltó más de una
+// celda, cada celda intermedia debía ser libre: simBricks sólo mira la
+// celda de llegada y las paletas rebotan en sus dos filas
+static void checkPath(const GameConfig& cfg, Checker& ck, int i) {
+    const float ax = ck.px[i], ay = ck.py[i];
+    const float bx = cfg.balls.x[i], by = cfg.balls.y[i];
+    const int cx0 = roundCell(ax), cy0 = roundCell(ay);
+    const int cx1 = roundCell(bx), cy1 = roundCell(by);
+    if (std::max(std::abs(cx1 - cx0), std::abs(cy1 - cy0)) <= 1) return;
+
+    int r0 = -1, c0 = -1, r1 = -1, c1 = -1;
+    brickCellAt(cfg, cx0, cy0, r0, c0);
+    brickCellAt(cfg, cx1, cy1, r1, c1);
+    const int f0 = freeBrickAt(cfg, cx0, cy0), f1 = freeBrickAt(cfg, cx1, cy1);
+    const int n = (int)std::ceil(std::max(std::fabs(bx - ax), std::fabs(by - ay)) * 4.0f);
+    for (int k = 1; k < n; ++k) {
+        float t = (float)k / n;
+        int sx = roundCell(ax + (bx - ax) * t), sy = roundCell(ay + (by - ay) * t);
+        int r, c;
+        if (brickCellAt(cfg, sx, sy, r, c) && cfg.grid[r][c].hp > 0 &&
+            !(r == r0 && c == c0) && !(r == r1 && c == c1)) {
+            fail(ck, V_BRICK_SKIPPED, "bola %d de (%.2f,%.2f) a (%.2f,%.2f) pasa por el ladrillo %d,%d",
+                 i, ax, ay, bx, by, r, c);
+            return;
+        }
+        int f = freeBrickAt(cfg, sx, sy);
+        if (f >= 0 && f != f0 && f != f1) {
+            fail(ck, V_BRICK_SKIPPED, "bola %d de (%.2f,%.2f) a (%.2f,%.2f) pasa por el ladrillo libre %d",
+                 i, ax, ay, bx, by, f);
+            return;
+        }
+        if (by <= ay) continue;
+        for (int p = 0; p < cfg.numPlayers; ++p) {
+            const Paddle& pad = cfg.paddles[p];
+            bool band = (sy == pad.y - 1 || sy == pad.y);
+            bool landed = (cy1 == pad.y - 1 || cy1 == pad.y);
+            if (band && !landed && cy0 < pad.y - 1 && sx >= pad.x && sx < pad.x + pad.w) {
+                fail(ck, V_PADDLE_SKIPPED, "bola %d de (%.2f,%.2f) a (%.2f,%.2f) atraviesa la paleta %d",
+                     i, ax, ay, bx, by, p);
+                return;
+            }
+        }
+    }
+}
+
+static void onSubstep(const GameConfig& cfg, SubstepPoint at, void* user) {
+    auto& ck = *(Checker*)user;
+    if (ck.found != V_NONE) return;
+    const BallPool& b = cfg.balls;
+    if (at == SUB_BEFORE_BALLS) {
+        std::copy_n(b.x.data(), b.count, ck.px.data());
+        std::copy_n(b.y.data(), b.count, ck.py.data());
+    } else if (at == SUB_AFTER_BALLS) {
+        for (int i = 0; i < b.count; ++i) checkPath(cfg, ck, i);
+    } else {
+        for (int i = 0; i < b.count; ++i) {
+            if (b.x[i] < cfg.x0 || b.x[i] > cfg.x1 || b.y[i] < cfg.y0 || b.y[i] > cfg.y1) {
+                fail(ck, V_BOUNDS, "bola %d en (%.2f,%.2f), área (%d,%d)-(%d,%d)", i, b.x[i], b.y[i],
+                     cfg.x0, cfg.y0, cfg.x1, cfg.y1);
+                return;
+            }
+        }
+    }
+}
+
+// Verificaciones al cerrar el frame. reset: el score pudo volver atrás
+// (rebobinado, reinicio o nivel nuevo)
+static void checkFrame(const GameConfig& cfg, Checker& ck, bool reset) {
+    bool progress = false;
+    for (const GameEvent& ev : cfg.events.list) {
+        switch (ev.type) {
+        case EV_BRICK_HIT:
+        case EV_PADDLE_HIT:
+        case EV_LIFE_LOST:
+            progress = true;
+            break;
+        case EV_LEVEL_STARTED:
+            reset = true;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (cfg.ballLaunched && !cfg.paused && cfg.running) {
+        const BallPool& b = cfg.balls;
+        for (int i = 0; i < b.count; ++i) {
+            if (std::fabs(b.vx[i]) < BALL_MIN_VX - 1e-4f || std::fabs(b.vy[i]) < BALL_MIN_VY - 1e-4f) {
+                fail(ck, V_ANGLE, "bola %d con velocidad (%.3f,%.3f)", i, b.vx[i], b.vy[i]);
+                break;
+            }
+        }
+        ck.idle = progress ? 0 : ck.idle + 1;
+        if (ck.idle > ck.idleLimit) {
+            fail(ck, V_STUCK, "%d frames sin tocar paleta ni ladrillo (%d bolas, bola 0 en %.2f,%.2f)",
+                 ck.idle, b.count, b.count ? b.x[0] : 0.0f, b.count ? b.y[0] : 0.0f);
+        }
+    } else {
+        ck.idle = 0;
+    }
+
+    if (!reset && cfg.score < ck.prevScore) {
+        fail(ck, V_SCORE, "el score bajó de %d a %d", ck.prevScore, cfg.score);
+    }
+    ck.prevScore = cfg.score;
+
+    if (!cfg.events.list.empty()) {
+        int alive = 0;
+        for (int r = 0; r < cfg.rows; ++r) {
+            for (int c = 0; c < cfg.cols; ++c) alive += (cfg.grid[r][c].hp > 0);
+        }
+        for (int i = 0; i < cfg.freeBricks.count; ++i) alive += (cfg.freeBricks.brick[i].hp > 0);
+        if (alive != cfg.bricksAlive) {
+            fail(ck, V_BRICK_COUNT, "bricksAlive = %d, hay %d ladrillos vivos", cfg.bricksAlive, alive);
+        }
+    }
+}
+
+/*
+PARTIDAS
+*/
+
+// Partida verificada: estado, rebobinado y verificaciones de un hilo
+struct FuzzGame {
+    GameConfig cfg{};
+    RewindBuffer rewind;
+    Checker ck;
+    bool record = false;   // Grabar snapshots (la partida usa IN_REWIND)
+};
+
+static void startGame(FuzzGame& g, const InputRecording& rec, bool rewinds) {
+    setupRecordedGame(g.cfg, rec);
+    g.rewind.clear();
+    g.record = rewinds;
+    resetChecker(g.ck, g.cfg);
+}
+
+// Un frame como en replayRecording: comandos, cambio de nivel pendiente y
+// frame verificado. false si la partida ya no puede seguir
+static bool stepGame(FuzzGame& g, const InputCommand* cmds, size_t n, uint32_t f) {
+    GameConfig& cfg = g.cfg;
+    bool reset = false;
+    for (size_t i = 0; i < n; ++i) {
+        if (cmds[i].type == IN_QUIT) {
+            cfg.running = false;
+            return false;
+        }
+        reset |= applyInput(cfg, g.rewind, cmds[i]);
+    }
+    if (cfg.restartRequested) {
+        resetLevel(cfg);
+        reset = true;
+    }
+    if (!cfg.running) return false;
+
+    g.ck.frame = f;
+    simFrameProbed(cfg, onSubstep, &g.ck);
+    checkFrame(cfg, g.ck, reset);
+    if (g.record && !cfg.lost) g.rewind.record(cfg);
+    return true;
+}
+
+// Repite una grabación con las verificaciones hasta la primera violación
+static Violation runChecked(const InputRecording& rec, FuzzGame& g, unsigned long& frames) {
+    const std::vector<InputCommand>& cmds = rec.commands;
+    bool rewinds = false;
+    for (const InputCommand& c : cmds) rewinds |= (c.type == IN_REWIND);
+    startGame(g, rec, rewinds);
+
+    size_t next = 0;
+    for (uint32_t f = 0; f < rec.frames; ++f) {
+        size_t first = next;
+        while (next < cmds.size() && cmds[next].frame == f) ++next;
+        if (!stepGame(g, cmds.data() + first, next - first, f)) break;
+        ++frames;
+        if (g.ck.found != V_NONE) break;
+    }
+    return g.ck.found;
+}
+
+// Generador de las decisiones del fuzzer (aparte del de la partida, que
+// determina la grabación)
+struct FuzzRandom {
+    uint32_t s;
+    explicit FuzzRandom(uint32_t seed) : s(seed * 2654435761u ^ 0x5BD1E995u) { if (!s) s = 1; }
+    uint32_t next() {
+        s ^= s << 13;
+        s ^= s >> 17;
+        s ^= s << 5;
+        return s;
+    }
+    int below(int n) { return (int)(next() % (uint32_t)n); }
+};
+
+struct FuzzOptions {
+    int threads = 0;
+    long sessions = 0;
+    int frames = 20000;
+    double seconds = 0.0;
+    uint32_t seed = 1;
+    std::string dir = "fuzz";
+    int keep = 3;
+};
+
+// Parámetros de la partida `seed`
+static void randomSession(InputRecording& rec, uint32_t seed, FuzzRandom& rnd) {
+    rec.clear();
+    rec.seed = seed;
+    rec.numPlayers = rnd.below(10) < 6 ? 1 : 2 + rnd.below(3);
+    rec.launchBalls = rnd.below(10) < 7 ? 1 : 1 << (1 + rnd.below(6));   // 2..64
+    rec.screenRows = 24 + rnd.below(40);
+    rec.screenCols = 80 + rnd.below(140);
+    rec.level = 1 + rnd.below(levelCount());
+    rec.ballSpeed = rnd.below(2) ? 0.0f : 0.5f + 0.1f * rnd.below(16);   // 0.5..2.0
+}
+
+// Juega una partida nueva grabando la entrada. El autopiloto (en la mayoría
+// de las partidas) mueve la paleta 1 para que la partida avance; encima se
+// mezclan comandos al azar de todos los jugadores
+static Violation playSession(InputRecording& rec, FuzzGame& g, uint32_t seed, int maxFrames,
+                             unsigned long& frames) {
+    FuzzRandom rnd(seed);
+    randomSession(rec, seed, rnd);
+    const bool pilotOn = rnd.below(10) < 7;
+    const bool rewinds = rnd.below(10) == 0;
+    const int noise = pilotOn ? 64 : 12;   // Un comando al azar cada ~noise frames
+    startGame(g, rec, rewinds);
+
+    GameConfig& cfg = g.cfg;
+    Autopilot pilot;
+    uint32_t unpauseAt = 0;
+    for (uint32_t f = 0; f < (uint32_t)maxFrames; ++f) {
+        // El autopiloto actúa directamente sobre cfg; se graba lo que hizo
+        // (como en el benchmark) y no se vuelve a aplicar
+        if (pilotOn && !cfg.paused && cfg.running) {
+            bool launched = cfg.ballLaunched;
+            int dir = cfg.paddles[0].desiredDir;
+            autopilotStep(pilot, cfg);
+            if ((!launched && cfg.ballLaunched) || (launched && cfg.laserFrames > 0)) {
+                rec.commands.push_back(InputCommand{f, IN_ACTION, 0, 0});
+            }
+            if (cfg.paddles[0].desiredDir != dir) {
+                int d = cfg.paddles[0].desiredDir;
+                rec.commands.push_back(InputCommand{f, (uint8_t)(d ? IN_MOVE : IN_RELEASE), 0, (int16_t)d});
+            }
+        }
+        size_t first = rec.commands.size();
+
+        if (!cfg.running) {
+            rec.commands.push_back(InputCommand{f, IN_RESTART, 0, 0});   // Ganó o perdió
+        } else if (cfg.paused && f >= unpauseAt) {
+            rec.commands.push_back(InputCommand{f, IN_PAUSE, 0, 0});
+        } else if (rnd.below(noise) == 0) {
+            int k = rnd.below(1000);
+            int8_t player = (int8_t)rnd.below(cfg.numPlayers);
+            if (k < 450) {
+                rec.commands.push_back(InputCommand{f, IN_MOVE, player, (int16_t)(rnd.below(2) ? 1 : -1)});
+            } else if (k < 550) {
+                rec.commands.push_back(InputCommand{f, IN_RELEASE, 0, 0});
+            } else if (k < 900) {
+                rec.commands.push_back(InputCommand{f, IN_ACTION, 0, 0});
+            } else if (k < 930) {
+                rec.commands.push_back(InputCommand{f, IN_PAUSE, 0, 0});
+                unpauseAt = f + 1 + rnd.below(30);
+            } else if (k < 960 && rewinds) {
+                rec.commands.push_back(InputCommand{f, IN_REWIND, 0, (int16_t)(1 + rnd.below(120))});
+            } else if (k < 965) {
+                rec.commands.push_back(InputCommand{f, IN_RESTART, 0, 0});
+            }
+        }
+
+        rec.frames = f + 1;
+        bool alive = stepGame(g, rec.commands.data() + first, rec.commands.size() - first, f);
+        ++frames;
+        if (!alive || g.ck.found != V_NONE) break;
+    }
+    rec.finalScore = cfg.score;
+    return g.ck.found;
+}
+
+// Deja la grabación en los frames hasta la violación (que ocurre en `frame`)
+static void cutAt(InputRecording& rec, uint32_t frame) {
+    rec.frames = frame + 1;
+    while (!rec.commands.empty() && rec.commands.back().frame > frame) rec.commands.pop_back();
+}
+
+// Achica la grabación quitando bloques de comandos cada vez más chicos,
+// mientras la misma violación se siga produciendo (sin pasar de `budget`
+// frames simulados)
+static void minimize(InputRecording& rec, Violation kind, FuzzGame& g, unsigned long budget,
+                     unsigned long& frames) {
+    cutAt(rec, g.ck.frame);
+    InputRecording cand;
+    unsigned long spent = 0;
+    for (size_t chunk = rec.commands.size() / 2; chunk >= 1 && spent < budget; chunk /= 2) {
+        for (size_t i = 0; i < rec.commands.size() && spent < budget;) {
+            cand = rec;
+            size_t to = std::min(cand.commands.size(), i + chunk);
+            cand.commands.erase(cand.commands.begin() + i, cand.commands.begin() + to);
+            if (runChecked(cand, g, spent) == kind) {
+                cutAt(cand, g.ck.frame);
+                rec = cand;
+            } else {
+                i += chunk;
+            }
+        }
+    }
+    frames += spent;
+    // Deja g con el detalle de la grabación final
+    runChecked(rec, g, frames);
+}
+
+/*
+BÚSQUEDA EN PARALELO
+*/
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void onSigint(int) { interrupted = 1; }
+
+struct FuzzShared {
+    const FuzzOptions* opt;
+    std::atomic<long> next{0};
+    std::atomic<unsigned long> frames{0};
+    std::atomic<long> sessions{0};
+    std::atomic<long> found[V_COUNT];
+    std::atomic<bool> stop{false};
+    pthread_mutex_t outMutex = PTHREAD_MUTEX_INITIALIZER;   // Salida y archivos
+
+    FuzzShared() { for (auto& f : found) f = 0; }
+};
+
+static void report(FuzzShared& sh, const InputRecording& rec, Violation kind, const Checker& ck,
+                   uint32_t origFrames, size_t origCommands) {
+    long n = sh.found[kind].fetch_add(1) + 1;
+    pthread_mutex_lock(&sh.outMutex);
+    std::string path = "-";
+    if (n <= sh.opt->keep) {
+        path = sh.opt->dir + "/" + VIOLATION_NAMES[kind] + "-" + std::to_string(rec.seed) + ".bkr";
+        if (!saveRecording(rec, path.c_str())) path = "(no se pudo guardar)";
+    }
+    std::printf("[semilla %u] %s en el frame %u: %s\n"
+                "    %d jugadores, %d bolas, nivel %d, velocidad %.1f; %u -> %u frames, %zu -> %zu comandos: %s\n",
+                rec.seed, VIOLATION_NAMES[kind], ck.frame, ck.detail, rec.numPlayers, rec.launchBalls,
+                rec.level, rec.ballSpeed, origFrames, rec.frames, origCommands, rec.commands.size(),
+                path.c_str());
+    std::fflush(stdout);
+    pthread_mutex_unlock(&sh.outMutex);
+}
+
+static void* fuzzWorker(void* arg) {
+    auto& sh = *(FuzzShared*)arg;
+    const FuzzOptions& opt = *sh.opt;
+    FuzzGame g;
+    InputRecording rec;
+    rec.commands.reserve(opt.frames / 4);
+    while (!sh.stop.load()) {
+        long k = sh.next.fetch_add(1);
+        if (opt.sessions > 0 && k >= opt.sessions) break;
+
+        unsigned long frames = 0;
+        uint32_t seed = opt.seed + (uint32_t)k;
+        Violation v = playSession(rec, g, seed, opt.frames, frames);
+        if (v != V_NONE) {
+            uint32_t origFrames = g.ck.frame + 1;
+            size_t origCommands = rec.commands.size();
+            minimize(rec, v, g, 50ul * 1000 * 1000, frames);
+            if (g.ck.found == v) report(sh, rec, v, g.ck, origFrames, origCommands);
+        }
+        sh.frames.fetch_add(frames);
+        sh.sessions.fetch_add(1);
+    }
+    return nullptr;
+}
+
+static int replayFiles(int argc, char** argv, int from) {
+    FuzzGame g;
+    int bad = 0;
+    for (int i = from; i < argc; ++i) {
+        InputRecording rec;
+        if (!loadRecording(rec, argv[i])) {
+            std::printf("%s: no se pudo leer\n", argv[i]);
+            ++bad;
+            continue;
+        }
+        unsigned long frames = 0;
+        Violation v = runChecked(rec, g, frames);
+        if (v == V_NONE) {
+            std::printf("%s: sin violaciones (%lu frames, score %d)\n", argv[i], frames, g.cfg.score);
+        } else {
+            std::printf("%s: %s en el frame %u: %s\n", argv[i], VIOLATION_NAMES[v], g.ck.frame, g.ck.detail);
+            ++bad;
+        }
+    }
+    return bad ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    FuzzOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(a, "-r") == 0) return replayFiles(argc, argv, i + 1);
+        else if (std::strcmp(a, "-j") == 0 && hasValue) opt.threads = std::atoi(argv[++i]);
+        else if (std::strcmp(a, "-n") == 0 && hasValue) opt.sessions = std::atol(argv[++i]);
+        else if (std::strcmp(a, "-f") == 0 && hasValue) opt.frames = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(a, "-t") == 0 && hasValue) opt.seconds = std::atof(argv[++i]);
+        else if (std::strcmp(a, "-s") == 0 && hasValue) opt.seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(a, "-o") == 0 && hasValue) opt.dir = argv[++i];
+        else if (std::strcmp(a, "-m") == 0 && hasValue) opt.keep = std::atoi(argv[++i]);
+        else {
+            std::fprintf(stderr, "uso: fuzz [-j hilos] [-n partidas] [-f frames] [-t segundos] "
+                                 "[-s semilla] [-o dir] [-m n] | fuzz -r grabación.bkr ...\n");
+            return 2;
+        }
+    }
+    if (opt.threads <= 0) opt.threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    mkdir(opt.dir.c_str(), 0755);
+    std::signal(SIGINT, onSigint);
+
+    FuzzShared sh;
+    sh.opt = &opt;
+    std::vector<pthread_t> workers(opt.threads);
+    for (auto& t : workers) pthread_create(&t, nullptr, fuzzWorker, &sh);
+
+    // Progreso cada 10 s hasta agotar partidas, tiempo o Ctrl+C
+    auto t0 = std::chrono::steady_clock::now();
+    double lastReport = 0.0;
+    while (true) {
+        usleep(100 * 1000);
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        bool done = opt.sessions > 0 && sh.sessions.load() >= opt.sessions;
+        if (done || interrupted || (opt.seconds > 0 && secs >= opt.seconds)) break;
+        if (secs - lastReport >= 10.0) {
+            lastReport = secs;
+            pthread_mutex_lock(&sh.outMutex);
+            std::printf("%.0f s: %ld partidas, %.3g frames (%.1f M/s)\n", secs, sh.sessions.load(),
+                        (double)sh.frames.load(), sh.frames.load() / secs / 1e6);
+            std::fflush(stdout);
+            pthread_mutex_unlock(&sh.outMutex);
+        }
+    }
+    sh.stop = true;
+    for (auto& t : workers) pthread_join(t, nullptr);
+
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::printf("\n%ld partidas, %lu frames en %.1f s con %d hilos (%.1f M frames/s)\n",
+                sh.sessions.load(), sh.frames.load(), secs, opt.threads, sh.frames.load() / secs / 1e6);
+    long total = 0;
+    for (int v = 1; v < V_COUNT; ++v) {
+        long n = sh.found[v].load();
+        total += n;
+        if (n > 0) std::printf("  %-22s %ld\n", VIOLATION_NAMES[v], n);
+    }
+    if (total == 0) std::printf("  sin violaciones\n");
+    return total ? 1 : 0;
+}
@@ -0,0 +1,151 @@
+/*
+monitor.cpp - Muestra las partidas en curso en esta máquina leyendo el estado
+que cada una publica en memoria compartida (src/live_export.h). Sólo lee: no
+toma locks ni detiene a los juegos.
+
+Uso: monitor [-1] [-i ms] [pid...]
+     -1  imprime una sola vez (sin limpiar la pantalla)
+     -i  intervalo de actualización (500 ms por defecto)
+     Sin pids busca todos los segmentos /dev/shm/breakout-*
+*/
+#include "../src/live_export.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Segmento mapeado de una sesión
+struct Session {
+    std::string name;
+    const LiveState* st = nullptr;
+};
+
+static bool mapSession(Session& s) {
+    int fd = shm_open(s.name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    void* p = mmap(nullptr, sizeof(LiveState), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+    s.st = (const LiveState*)p;
+    if (s.st->magic != LIVE_MAGIC || s.st->version != LIVE_VERSION) {
+        munmap(p, sizeof(LiveState));
+        s.st = nullptr;
+        return false;
+    }
+    return true;
+}
+
+// Nombres de los segmentos a mostrar: los pids pedidos o todos los de /dev/shm
+static std::vector<std::string> findSessions(const std::vector<int>& pids) {
+    std::vector<std::string> names;
+    for (int pid : pids) names.push_back("/" + std::string(LIVE_PREFIX) + std::to_string(pid));
+    if (!pids.empty()) return names;
+
+    if (DIR* dir = opendir("/dev/shm")) {
+        while (dirent* e = readdir(dir)) {
+            if (std::strncmp(e->d_name, LIVE_PREFIX, std::strlen(LIVE_PREFIX)) == 0) {
+                names.push_back("/" + std::string(e->d_name));
+            }
+        }
+        closedir(dir);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+static const char* statusOf(const LiveState* st, const LiveData& d, double age) {
+    if (kill(st->pid, 0) != 0 && errno == ESRCH) return "sin proceso";
+    if (d.won) return "ganó";
+    if (d.lost) return "perdió";
+    if (!d.running) return "detenido";
+    if (d.paused) return "pausa";
+    if (age > 1.0) return "en reposo";   // Sin frames: bola esperando o menú
+    return "jugando";
+}
+
+static void printTable(std::vector<Session>& sessions) {
+    std::printf("%-8s %-11s %5s %7s %5s %5s %9s %6s %9s", "pid", "estado", "nivel",
+                "score", "vidas", "bolas", "frame", "fps", "frame us");
+    for (int k = 0; k < LIVE_STAGES; ++k) std::printf(" %9s", LIVE_STAGE_NAMES[k]);
+    std::printf(" %6s %3s %3s %8s %9s %8s %13s %8s %6s\n", "attr", "sub", "rb", "resim us", "inicio ms",
+                "hilos us", "bola 0", "paleta 0", "edad");
+
+    uint64_t now = monotonicNs();
+    for (Session& s : sessions) {
+        LiveData d;
+        if (!readLiveState(s.st, d)) {
+            std::printf("%-8d (escribiendo)\n", s.st->pid);
+            continue;
+        }
+        if (d.updatedNs == 0) {
+            std::printf("%-8d %-11s\n", s.st->pid, "sin frames");
+            continue;
+        }
+        double age = (now > d.updatedNs) ? (now - d.updatedNs) / 1e9 : 0.0;
+        double fps = d.tickNs ? 1e9 / d.tickNs : 0.0;
+        std::printf("%-8d %-11s %5d %7d %5d %5d %9llu %6.1f %9.1f", s.st->pid,
+                    statusOf(s.st, d, age), d.level, d.score, d.lives, d.ballCount,
+                    (unsigned long long)d.frame, fps, d.frameNs / 1e3);
+        for (int k = 0; k < LIVE_STAGES; ++k) std::printf(" %9.1f", d.stageNs[k] / 1e3);
+        char ball[32] = "-", pad[16] = "-";
+        if (d.ballCount > 0) std::snprintf(ball, sizeof(ball), "%.1f,%.1f", d.ballX[0], d.ballY[0]);
+        if (d.numPlayers > 0) std::snprintf(pad, sizeof(pad), "%d,%d", d.paddleX[0], d.paddleY[0]);
+        std::printf(" %6u %3d %3d %8.1f %9.2f %8.1f %13s %8s %5.1fs\n", d.attrSwitches, d.substeps,
+                    d.rollbackDepth, d.resimNs / 1e3, d.startNs / 1e6, d.attachNs / 1e3, ball, pad, age);
+    }
+    if (sessions.empty()) {
+        std::printf("(no hay partidas en curso)\n");
+        return;
+    }
+
+    // Despertares por hilo: en pausa o con la bola sin lanzar sólo debería
+    // moverse la entrada
+    std::printf("\ndespertares\n%-8s", "pid");
+    for (int k = 0; k < LIVE_WAKEUP_STAGES; ++k) std::printf(" %9s", LIVE_WAKEUP_NAMES[k]);
+    std::printf("\n");
+    for (Session& s : sessions) {
+        std::printf("%-8d", s.st->pid);
+        for (int k = 0; k < LIVE_WAKEUP_STAGES; ++k) {
+            std::printf(" %9llu", (unsigned long long)s.st->wakeups[k].load(std::memory_order_relaxed));
+        }
+        std::printf("\n");
+    }
+}
+
+int main(int argc, char** argv) {
+    bool once = false;
+    int intervalMs = 500;
+    std::vector<int> pids;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-1") == 0) once = true;
+        else if (std::strcmp(argv[i], "-i") == 0 && i + 1 < argc) intervalMs = std::atoi(argv[++i]);
+        else pids.push_back(std::atoi(argv[i]));
+    }
+
+    while (true) {
+        // Las sesiones se buscan en cada vuelta: aparecen y terminan solas
+        std::vector<Session> sessions;
+        for (const std::string& name : findSessions(pids)) {
+            Session s;
+            s.name = name;
+            if (mapSession(s)) sessions.push_back(s);
+        }
+
+        if (!once) std::printf("\033[H\033[2J");
+        printTable(sessions);
+        std::fflush(stdout);
+
+        for (Session& s : sessions) munmap((void*)s.st, sizeof(LiveState));
+        if (once) break;
+        usleep(intervalMs * 1000);
+    }
+    return 0;
+}
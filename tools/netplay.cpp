@@ -0,0 +1,236 @@
+/*
+netplay.cpp - Prueba del coop en red sin terminal. Lanza dos procesos (quien
+crea y quien se une) que se conectan por UDP en 127.0.0.1 a través del shim
+de latencia y pérdida, juegan con entrada al azar (reinician la partida cuando
+termina) y, al llegar los dos a `frames` frames confirmados, comparan el hash
+de ese estado. Informa rollbacks (cantidad, profundidad, costo de volver a
+simular), ticks sin avanzar, paquetes, RTT y desincronizaciones.
+
+Uso: netplay [-f frames] [-l lag ms] [-j jitter ms] [-p pérdida %] [-t tick us]
+             [-s semilla] [-P puerto]
+     -f  frames a jugar (1200)
+     -l  demora simulada de cada paquete (0)
+     -j  demora extra al azar, hasta este valor (0)
+     -p  porcentaje de paquetes descartados (0)
+     -t  duración del tick en microsegundos (16667, 60 fps)
+     -s  semilla de la partida (por defecto, la hora)
+     -P  puerto UDP de quien crea (47800)
+*/
+#include "../src/netplay.h"
+#include "../src/live_export.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+struct Options {
+    uint32_t frames = 1200;
+    NetShim shim;
+    int tickUs = 16667;
+    uint32_t seed = 0;
+    int port = NET_DEFAULT_PORT;
+};
+
+// Lo que cada proceso le informa al padre por un pipe
+struct Result {
+    bool connected;
+    NetEnd end;
+    NetStats stats;
+    unsigned long sent, received, lost;
+    uint32_t frames;         // Frames simulados
+    uint32_t hash;           // Estado tras `frames` frames confirmados (0 = no llegó)
+    double seconds;
+};
+
+static uint64_t g_handshakeEnd = 0;
+
+static bool beforeDeadline(void*) {
+    return monotonicNs() < g_handshakeEnd;
+}
+
+// Entrada al azar: cambia de dirección de a ratos, lanza y dispara, y
+// reinicia cuando la partida terminó. Sin pausa (la alternarían los dos)
+static uint8_t randomInput(const GameConfig& cfg, uint32_t& rng, uint8_t& dir) {
+    rng = rng * 1664525u + 1013904223u;
+    uint32_t r = rng >> 8;
+    if (r % 8 == 0) dir = (uint8_t)((r >> 3) % 3);   // 0, NI_LEFT o NI_RIGHT
+    uint8_t in = dir;
+    if ((r >> 6) % 30 == 0) in |= NI_ACTION;
+    if (!cfg.running && !cfg.restartRequested) in |= NI_RESTART;
+    return in;
+}
+
+static Result runPeer(bool host, const Options& o) {
+    Result res{};
+    NetLink link;
+    NetSetup setup;
+    bool opened = host ? link.openHost(o.port) : link.openGuest(o.port);
+    link.setShim(o.shim, (uint32_t)getpid() * 2654435761u);
+    g_handshakeEnd = monotonicNs() + (uint64_t)NET_TIMEOUT_MS * 1000000;
+    if (host) {
+        setup.seed = o.seed;
+        setup.launchBalls = 1;
+        setup.screenRows = 30;
+        setup.screenCols = 100;
+        setup.tickUs = o.tickUs;
+        res.connected = opened && netHostHandshake(link, setup, beforeDeadline, nullptr);
+    } else {
+        res.connected = opened && netGuestHandshake(link, 30, 100, setup, beforeDeadline, nullptr);
+    }
+    if (!res.connected) return res;
+
+    GameConfig cfg;
+    setupNetGame(cfg, setup);
+    NetRollback rb;
+    rb.start(cfg, host ? 0 : 1);
+
+    // Después de terminar se siguen enviando paquetes un rato, para que el
+    // compañero también sepa que este lado confirmó el último frame
+    const uint64_t tickNs = (uint64_t)std::max(setup.tickUs, 1000) * 1000;
+    const int lingerTicks = std::max<int>(30, (o.shim.lagMs + o.shim.jitterMs) * 3000000ull / tickNs);
+    uint64_t start = monotonicNs(), next = start + tickNs, lastHeard = start;
+    uint32_t rng = host ? 1 : 2;
+    uint8_t dir = 0;
+    int linger = -1;
+    uint8_t buf[NET_MAX_PACKET];
+
+    while (res.end == NET_PLAYING && linger != 0) {
+        uint64_t now = monotonicNs();
+        while (now < next) {
+            int ms = (int)((next - now + 999999) / 1000000);
+            pollfd pfd{link.socketFd(), POLLIN, 0};
+            poll(&pfd, 1, link.pollTimeoutMs(now, ms));
+            now = monotonicNs();
+            link.flush(now);
+            int n;
+            while ((n = link.recv(buf, sizeof(buf))) >= 0) {
+                if (n == 0) continue;
+                NetEnd bye = readByePacket(buf, n);
+                if (bye != NET_PLAYING) res.end = bye;
+                else if (!(host && netAnswerHello(link, setup, buf, n))) rb.readPacket(buf, n, now);
+                lastHeard = now;
+            }
+        }
+        if (res.end != NET_PLAYING) break;
+        if (now - lastHeard > (uint64_t)NET_TIMEOUT_MS * 1000000) {
+            res.end = NET_TIMEOUT;
+            break;
+        }
+
+        // Mismo ritmo que el hilo de red del juego
+        next += tickNs;
+        if (rb.frameAdvantage(tickNs) >= 2) next += tickNs / 4;
+        if (next + tickNs < now) next = now + tickNs;
+
+        if (rb.canAdvance()) rb.advance(randomInput(cfg, rng, dir), monotonicNs());
+        else rb.stats.stalls++;
+        size_t len = rb.buildPacket(buf, sizeof(buf));
+        if (len) link.send(buf, len);
+
+        if (linger > 0) {
+            --linger;
+        } else if (linger < 0 && rb.confirmedFrames() >= o.frames && rb.peerConfirmedFrames() >= o.frames) {
+            res.hash = rb.confirmedHash(o.frames);
+            linger = lingerTicks;
+        }
+    }
+    if (res.end == NET_PLAYING) res.end = NET_FINISHED;
+
+    size_t len = buildByePacket(buf, sizeof(buf), NET_FINISHED);
+    for (int i = 0; i < 3; ++i) link.send(buf, len);
+    link.drain();
+
+    res.stats = rb.stats;
+    res.sent = link.sent;
+    res.received = link.received;
+    res.lost = link.lost;
+    res.frames = rb.currentFrame();
+    res.seconds = (monotonicNs() - start) / 1e9;
+    return res;
+}
+
+static void usage() {
+    std::fprintf(stderr, "Uso: netplay [-f frames] [-l lag ms] [-j jitter ms] [-p pérdida %%] [-t tick us] "
+                         "[-s semilla] [-P puerto]\n");
+}
+
+static void report(const char* who, const Result& r) {
+    static const char* END_NAMES[] = {"jugando", "terminó", "salió", "el compañero salió", "sin conexión"};
+    const NetStats& s = r.stats;
+    std::printf("%s: %s\n", who, r.connected ? END_NAMES[r.end] : "no se conectó");
+    if (!r.connected) return;
+    std::printf("  frames %u en %.1f s, sin avanzar %lu ticks\n", r.frames, r.seconds, s.stalls);
+    std::printf("  rollbacks %lu (%.1f%% de los frames), frames repetidos %lu, máx. %d\n", s.rollbacks,
+                s.frames ? 100.0 * s.rollbacks / s.frames : 0.0, s.resimFrames, s.maxDepth);
+    std::printf("  profundidad:");
+    for (int d = 1; d <= NET_MAX_ROLLBACK; ++d) {
+        if (s.depthHist[d]) std::printf(" %d:%lu", d, s.depthHist[d]);
+    }
+    std::printf("\n  resim. prom. %.1f us, máx. %.1f us\n", s.rollbacks ? s.resimNs / 1e3 / s.rollbacks : 0.0,
+                s.maxResimNs / 1e3);
+    std::printf("  paquetes enviados %lu (descartados por el shim %lu), recibidos %lu, RTT %.1f ms\n", r.sent,
+                r.lost, r.received, s.rttMs);
+    std::printf("  desincronizaciones %lu\n", s.desyncs);
+}
+
+int main(int argc, char** argv) {
+    Options o;
+    o.seed = (uint32_t)std::time(nullptr);
+    int opt;
+    while ((opt = getopt(argc, argv, "f:l:j:p:t:s:P:h")) != -1) {
+        switch (opt) {
+            case 'f': o.frames = (uint32_t)std::max(1, std::atoi(optarg)); break;
+            case 'l': o.shim.lagMs = std::max(0, std::atoi(optarg)); break;
+            case 'j': o.shim.jitterMs = std::max(0, std::atoi(optarg)); break;
+            case 'p': o.shim.lossPct = std::min(std::max(0, std::atoi(optarg)), 90); break;
+            case 't': o.tickUs = std::max(1000, std::atoi(optarg)); break;
+            case 's': o.seed = (uint32_t)std::strtoul(optarg, nullptr, 10); break;
+            case 'P': o.port = std::atoi(optarg); break;
+            default: usage(); return 2;
+        }
+    }
+
+    std::printf("netplay: %u frames, tick %d us, demora %d+%d ms, pérdida %d%%, semilla %u\n", o.frames,
+                o.tickUs, o.shim.lagMs, o.shim.jitterMs, o.shim.lossPct, o.seed);
+    std::fflush(stdout);
+
+    // Un proceso por jugador, como en el juego; cada uno devuelve su Result
+    int pipes[2][2];
+    pid_t pids[2];
+    for (int i = 0; i < 2; ++i) {
+        if (pipe(pipes[i]) != 0) return 1;
+        pids[i] = fork();
+        if (pids[i] < 0) return 1;
+        if (pids[i] == 0) {
+            close(pipes[i][0]);
+            if (i == 1) usleep(50000);   // Quien se une llega después
+            Result r = runPeer(i == 0, o);
+            ssize_t n = write(pipes[i][1], &r, sizeof(r));
+            _exit(n == (ssize_t)sizeof(r) ? 0 : 1);
+        }
+        close(pipes[i][1]);
+    }
+
+    Result res[2]{};
+    bool ok = true;
+    for (int i = 0; i < 2; ++i) {
+        ssize_t n = read(pipes[i][0], &res[i], sizeof(res[i]));
+        close(pipes[i][0]);
+        waitpid(pids[i], nullptr, 0);
+        if (n != (ssize_t)sizeof(res[i])) {
+            res[i] = Result{};
+            ok = false;
+        }
+    }
+    report("crea", res[0]);
+    report("se une", res[1]);
+
+    bool same = ok && res[0].hash && res[0].hash == res[1].hash;
+    std::printf("estado tras %u frames confirmados: %08x / %08x %s\n", o.frames, res[0].hash, res[1].hash,
+                same ? "(iguales)" : "(DISTINTOS)");
+    return same && !res[0].stats.desyncs && !res[1].stats.desyncs ? 0 : 1;
+}
@@ -0,0 +1,207 @@
+/*
+pipeline.cpp - Prueba de los hilos del juego sin terminal. Juega partidas con
+el tick y las etapas del pipeline (los mismos hilos que el juego normal, sin
+render ni teclado: la prueba encola entrada al azar) y compara el estado final
+con la repetición de su grabación en un solo hilo. La bola arranca a la
+velocidad máxima para que haya frames con varios subpasos. Si el pipeline deja
+de avanzar informa en qué paso quedó y termina con error. Antes de lanzar la
+bola cada partida pasa un rato en pausa: ningún hilo debe despertarse en ese
+tiempo (se miran los contadores de despertares por etapa).
+
+Uso: pipeline [-n partidas] [-f frames] [-b bolas] [-s semilla]
+     -n  partidas a jugar (8)
+     -f  frames como máximo por partida (3000)
+     -b  bolas por lanzamiento (1)
+     -s  semilla de la primera partida (1)
+*/
+#include "../src/game.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <pthread.h>
+#include <unistd.h>
+
+// El juego los define en el menú
+int g_tick_ms = 60000;
+int g_launchBalls = 1;
+bool g_telemetry = false;
+bool g_liveExport = false;
+bool g_spectate = false;
+
+// Tiempo sin frames nuevos (con la bola en juego) que se toma como cuelgue
+static const int HANG_MS = 2000;
+
+// Tiempo en reposo durante el que no debe despertarse ninguna etapa
+static const int PARK_MS = 200;
+
+struct SessionResult {
+    uint32_t frames = 0;
+    uint32_t substepFrames = 0;   // Frames con más de un subpaso (en la repetición)
+    bool same = false;
+    bool quiet = false;           // En pausa y sin lanzar no se despertó nadie
+};
+
+// Estado del tablero serializado (requiere board.mutex tomado)
+static std::vector<uint8_t> stateBytes(const GameConfig& cfg) {
+    std::vector<uint8_t> buf(snapshotMaxSize(cfg));
+    buf.resize(serializeState(cfg, buf.data(), buf.size()));
+    return buf;
+}
+
+// Pausa la partida con la bola sin lanzar y compara los despertares de cada
+// etapa antes y después de PARK_MS (la entrada no corre en esta prueba, y el
+// teclado la despertaría de todos modos). Al terminar quita la pausa
+static bool parkedStaysAsleep(Board& board, uint32_t seed) {
+    GameConfig& cfg = board.cfg;
+    pthread_mutex_lock(&board.mutex);
+    queueInput(&board, IN_PAUSE);
+    pthread_mutex_unlock(&board.mutex);
+
+    // El tick aplica la pausa en un frame más y después se duerme
+    bool parked = false;
+    for (int waited = 0; !parked && waited < HANG_MS; waited += 5) {
+        usleep(5000);
+        pthread_mutex_lock(&board.mutex);
+        parked = cfg.paused && !board.frameOpen && board.pendingInput.empty();
+        pthread_mutex_unlock(&board.mutex);
+    }
+    usleep(20000);   // Que las etapas terminen de volver a esperar
+
+    unsigned long before[STAGE_COUNT];
+    for (int k = 0; k < STAGE_COUNT; ++k) before[k] = getStageWakeups((Stage)k);
+    usleep(PARK_MS * 1000);
+    bool quiet = parked;
+    if (!parked) std::printf("semilla %u: la pausa no llegó a aplicarse\n", seed);
+    for (int k = 0; k < STAGE_COUNT; ++k) {
+        unsigned long n = getStageWakeups((Stage)k) - before[k];
+        if (k == STAGE_INPUT || n == 0) continue;
+        std::printf("semilla %u: en pausa y sin lanzar, la etapa %s se despertó %lu veces\n", seed,
+                    LIVE_WAKEUP_NAMES[k], n);
+        quiet = false;
+    }
+
+    pthread_mutex_lock(&board.mutex);
+    queueInput(&board, IN_PAUSE);
+    pthread_mutex_unlock(&board.mutex);
+    return quiet;
+}
+
+static void runSession(uint32_t seed, int maxFrames, int launchBalls, SessionResult& out) {
+    Board board;
+    InputRecording& rec = board.recording;
+    rec.clear();
+    rec.seed = seed;
+    rec.launchBalls = launchBalls;
+    rec.screenRows = 40;
+    rec.screenCols = 120;
+    rec.ballSpeed = 2.0f;
+    GameConfig& cfg = board.cfg;
+    setupRecordedGame(cfg, rec);
+    cfg.tick_ms = 200;
+
+    EngineFn fns[] = {tickThread, paddleThread, ballThread, collisionsWallsPaddleThread,
+                      collisionsBricksThread, stateThread};
+    const int numThreads = sizeof(fns) / sizeof(fns[0]);
+    pthread_t threads[numThreads];
+    for (int i = 0; i < numThreads; ++i) pthread_create(&threads[i], nullptr, fns[i], &board);
+    out.quiet = parkedStaysAsleep(board, seed);
+
+    // Entrada entre frames, como el hilo de entrada: lanzar cuando la bola
+    // espera, seguir a la primera bola con la paleta y, al azar, soltarla o
+    // rebobinar medio segundo
+    unsigned rng = seed * 2654435761u + 1;
+    uint32_t lastFrames = 0;
+    auto lastProgress = std::chrono::steady_clock::now();
+    std::vector<uint8_t> final;
+    while (true) {
+        usleep(300);
+        pthread_mutex_lock(&board.mutex);
+        if (rec.frames != lastFrames) {
+            lastFrames = rec.frames;
+            lastProgress = std::chrono::steady_clock::now();
+        }
+        bool done = rec.frames >= (uint32_t)maxFrames || !cfg.running;
+        if (done && !board.frameOpen) {
+            // Entre frames: el estado es el de rec.frames frames completos
+            final = stateBytes(cfg);
+            stopBoard(&board);
+            pthread_mutex_unlock(&board.mutex);
+            break;
+        }
+        if (!done && board.pendingInput.empty()) {
+            rng = rng * 1664525u + 1013904223u;
+            int r = (int)(rng >> 24);
+            const Paddle& pad = cfg.paddles[0];
+            int dir = (cfg.balls.count > 0 && cfg.balls.x[0] < pad.x + pad.w / 2) ? -1 : 1;
+            if (!cfg.ballLaunched) queueInput(&board, IN_ACTION);
+            else if (r < 2) queueInput(&board, IN_REWIND, 0, 30);
+            else if (r < 40) queueInput(&board, IN_RELEASE);
+            else if (pad.desiredDir != dir) queueInput(&board, IN_MOVE, 0, dir);
+        }
+        auto idleMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - lastProgress).count();
+        if (idleMs > HANG_MS && !isIdle(&cfg)) {
+            std::printf("semilla %u: el pipeline no avanza desde el frame %u (paso %d, subpaso %d/%d, "
+                        "frame abierto %d)\n", seed, rec.frames, cfg.step, cfg.substep, cfg.substeps,
+                        (int)board.frameOpen);
+            // Los hilos colgados no van a volver: no se espera por ellos
+            std::fflush(stdout);
+            _exit(1);
+        }
+        pthread_mutex_unlock(&board.mutex);
+    }
+    for (pthread_t& t : threads) pthread_join(t, nullptr);
+
+    // La misma grabación en un solo hilo
+    GameConfig ref{};
+    RewindBuffer rewind;
+    ReplayCursor cur;
+    startReplay(cur, rec, ref, rewind);
+    out.frames = rec.frames;
+    out.substepFrames = 0;
+    while (stepReplay(cur, ref, rewind)) {
+        if (ref.substeps > 1) ++out.substepFrames;
+    }
+    out.same = stateBytes(ref) == final;
+}
+
+int main(int argc, char** argv) {
+    int sessions = 8, maxFrames = 3000, launchBalls = 1;
+    uint32_t seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!std::strcmp(argv[i], "-n")) sessions = std::max(1, std::atoi(argv[i + 1]));
+        else if (!std::strcmp(argv[i], "-f")) maxFrames = std::max(1, std::atoi(argv[i + 1]));
+        else if (!std::strcmp(argv[i], "-b")) launchBalls = std::max(1, std::atoi(argv[i + 1]));
+        else if (!std::strcmp(argv[i], "-s")) seed = (uint32_t)std::strtoul(argv[i + 1], nullptr, 10);
+    }
+
+    int failed = 0, restless = 0;
+    uint64_t substepFrames = 0;
+    std::printf("%-10s %8s %12s %8s %8s\n", "semilla", "frames", "c/subpasos", "igual", "reposo");
+    for (int s = 0; s < sessions; ++s) {
+        SessionResult r;
+        runSession(seed + s, maxFrames, launchBalls, r);
+        std::printf("%-10u %8u %12u %8s %8s\n", seed + s, r.frames, r.substepFrames, r.same ? "sí" : "NO",
+                    r.quiet ? "quieto" : "NO");
+        substepFrames += r.substepFrames;
+        if (!r.same) ++failed;
+        if (!r.quiet) ++restless;
+    }
+    if (substepFrames == 0) {
+        std::printf("ningún frame tuvo más de un subpaso: la prueba no cubrió los subpasos\n");
+        return 1;
+    }
+    if (failed) {
+        std::printf("%d partidas terminaron distinto que su repetición\n", failed);
+        return 1;
+    }
+    if (restless) {
+        std::printf("%d partidas despertaron etapas estando en reposo\n", restless);
+        return 1;
+    }
+    std::printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,322 @@
+/*
+spectate.cpp - Mira una partida en curso desde otra terminal. Se conecta al
+socket que abre el juego (src/spectate.h), arma el estado con el keyframe y
+los deltas que llegan y lo dibuja centrado en su propia pantalla. Sólo mira:
+no envía nada al juego.
+
+Uso: spectate [-c frames] [pid | socket]
+     Sin argumentos se conecta a la primera partida de /tmp/breakout-*.sock
+     Q o ESC para salir
+     -c  no usa la terminal: dibuja los próximos `frames` frames sobre una
+         terminal virtual de 40x120 (src/term_capture.h) e imprime lo que
+         costó cada uno en bytes, movimientos del cursor y celdas
+*/
+#include "../src/spectate.h"
+#include "../src/term_capture.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <ncurses.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+enum ColorPair {
+    PAIR_HP1 = 1,
+    PAIR_HP2,
+    PAIR_HP3,
+    PAIR_BALL,
+    PAIR_PADDLE,
+    PAIR_POWERUP
+};
+
+// Mismos atributos que el render del juego
+static attr_t g_hpAttr[4] = {A_NORMAL, A_NORMAL, A_NORMAL, A_BOLD};
+static attr_t g_ballAttr = A_BOLD;
+static attr_t g_paddleAttr = A_REVERSE;
+static attr_t g_powerUpAttr = A_BOLD;
+static attr_t g_shotAttr = A_BOLD;
+
+static void initColors() {
+    if (!has_colors() || start_color() == ERR) return;
+    short bg = (use_default_colors() == OK) ? -1 : COLOR_BLACK;
+    init_pair(PAIR_HP1, COLOR_GREEN, bg);
+    init_pair(PAIR_HP2, COLOR_YELLOW, bg);
+    init_pair(PAIR_HP3, COLOR_RED, bg);
+    init_pair(PAIR_BALL, COLOR_WHITE, bg);
+    init_pair(PAIR_PADDLE, COLOR_CYAN, bg);
+    init_pair(PAIR_POWERUP, COLOR_MAGENTA, bg);
+    g_hpAttr[1] = COLOR_PAIR(PAIR_HP1);
+    g_hpAttr[2] = COLOR_PAIR(PAIR_HP2);
+    g_hpAttr[3] = COLOR_PAIR(PAIR_HP3);
+    g_ballAttr = COLOR_PAIR(PAIR_BALL) | A_BOLD;
+    g_paddleAttr = COLOR_PAIR(PAIR_PADDLE) | A_REVERSE;
+    g_powerUpAttr = COLOR_PAIR(PAIR_POWERUP) | A_BOLD;
+    g_shotAttr = COLOR_PAIR(PAIR_PADDLE) | A_BOLD;
+}
+
+static int connectTo(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Socket pedido (pid o ruta) o el primero de /tmp que acepte la conexión
+static int openSpectate(const char* arg, std::string& path) {
+    std::vector<std::string> paths;
+    if (arg && std::strchr(arg, '/')) {
+        paths.push_back(arg);
+    } else if (arg) {
+        paths.push_back(std::string(SPECTATE_PREFIX) + arg + SPECTATE_SUFFIX);
+    } else if (DIR* dir = opendir("/tmp")) {
+        const char* prefix = std::strrchr(SPECTATE_PREFIX, '/') + 1;
+        while (dirent* e = readdir(dir)) {
+            std::string name = e->d_name;
+            if (name.compare(0, std::strlen(prefix), prefix) == 0 &&
+                name.size() > std::strlen(SPECTATE_SUFFIX) &&
+                name.compare(name.size() - std::strlen(SPECTATE_SUFFIX), std::string::npos, SPECTATE_SUFFIX) == 0) {
+                paths.push_back("/tmp/" + name);
+            }
+        }
+        closedir(dir);
+        std::sort(paths.begin(), paths.end());
+    }
+    for (const std::string& p : paths) {
+        int fd = connectTo(p);
+        if (fd >= 0) {
+            path = p;
+            return fd;
+        }
+    }
+    return -1;
+}
+
+static void drawView(const SpectateView& v, const std::string& path, bool ended) {
+    erase();
+    if (!v.valid) {
+        mvprintw(LINES / 2, std::max(0, (COLS - 30) / 2), "Esperando la partida...");
+        refresh();
+        return;
+    }
+
+    // La partida se dibuja centrada, con las coordenadas del juego corridas
+    int oy = std::max(0, (LINES - (v.bottom - v.top + 2)) / 2) - v.top;
+    int ox = std::max(0, (COLS - (v.right - v.left + 1)) / 2) - v.left;
+    int top = v.top + oy, bottom = v.bottom + oy, left = v.left + ox, right = v.right + ox;
+
+    // Marco y título
+    mvhline(top, left, '=', right - left + 1);
+    mvhline(bottom, left, '=', right - left + 1);
+    mvvline(top, left, '|', bottom - top + 1);
+    mvvline(top, right, '|', bottom - top + 1);
+    mvaddch(top, left, '+');
+    mvaddch(top, right, '+');
+    mvaddch(bottom, left, '+');
+    mvaddch(bottom, right, '+');
+    GameConfig geo{};
+    geo.rows = v.rows;
+    geo.cols = v.cols;
+    geo.gapX = v.gapX;
+    setupPlayAreaRect(geo, top, left, bottom, right);
+    mvaddstr(top, left + (geo.w - 8) / 2, "BREAKOUT");
+
+    char hud[96];
+    std::snprintf(hud, sizeof(hud), " Score: %d | Lives: %d | Level: %d | %s%s ", v.score, v.lives,
+                  v.level, (v.flags & SPF_PAUSED) ? "PAUSED" : "PLAYING", (v.flags & SPF_LASER) ? " | LASER" : "");
+    mvaddnstr(top + 1, left + 2, hud, geo.w - 3);
+
+    // Ladrillos
+    BrickLayout L = computeBrickLayout(geo);
+    int usable = geo.w - 2;
+    for (int r = 0; r < v.rows; ++r) {
+        int by = geo.y0 + 2 + r * (v.brickH + v.gapY);
+        int x = 0;
+        for (int c = 0; c < v.cols; ++c) {
+            int thisW = L.brickW + (c < L.remainder ? 1 : 0);
+            int hp = v.hp[r * v.cols + c];
+            char ch = (char)v.ch[r * v.cols + c];
+            int len = std::min(thisW, usable - x);
+            if (hp > 0 && len > 0) {
+                attrset(g_hpAttr[std::min(hp, 3)] | (ch == '@' ? A_BOLD : A_NORMAL));
+                for (int h = 0; h < v.brickH; ++h) mvhline(by + h, geo.x0 + 1 + x, ch, len);
+            }
+            x += thisW;
+            if (c < v.cols - 1) x += v.gapX;
+        }
+    }
+
+    for (const SpectateBrick& b : v.freeBricks) {
+        attrset(g_hpAttr[std::min((int)b.hp, 3)] | (b.ch == '@' ? A_BOLD : A_NORMAL));
+        mvhline(b.y + oy, b.x + ox, b.ch, b.w);
+    }
+
+    // Power-ups y disparos
+    static const char POWER_CH[] = {'W', 'M', 'L'};
+    for (const SpectateEntity& e : v.entities) {
+        bool shot = e.kind == SPECTATE_SHOT;
+        attrset(shot ? g_shotAttr : g_powerUpAttr);
+        mvaddch(e.y + oy, e.x + ox, shot ? '|' : (e.kind < sizeof(POWER_CH) ? POWER_CH[e.kind] : '?'));
+    }
+
+    // Paletas y bolas
+    attrset(g_paddleAttr);
+    for (int p = 0; p < v.numPlayers; ++p) mvhline(v.padY[p] + oy, v.padX[p] + ox, '=', v.padW[p]);
+    attrset(g_ballAttr);
+    for (size_t i = 0; i < v.ballX.size(); ++i) mvaddch(v.ballY[i] + oy, v.ballX[i] + ox, 'o');
+    attrset(A_NORMAL);
+
+    const char* msg = nullptr;
+    if (v.flags & SPF_WON) msg = "¡GANASTE!";
+    else if (v.flags & SPF_LOST) msg = "PERDISTE";
+    else if (!(v.flags & SPF_LAUNCHED) && (v.flags & SPF_RUNNING)) msg = "Esperando el lanzamiento";
+    if (ended) msg = "La partida terminó - Presiona una tecla";
+    if (msg) {
+        int len = std::min((int)std::strlen(msg), geo.w - 2);
+        mvaddnstr(geo.y0 + geo.h / 2, geo.x0 + (geo.w - len) / 2, msg, len);
+    }
+
+    char foot[160];
+    std::snprintf(foot, sizeof(foot), "Espectador: %s | frame %u | Q/ESC: Salir", path.c_str(), v.frame);
+    mvaddnstr(bottom + 1, left, foot, std::max(0, COLS - left));
+    refresh();
+}
+
+// Lee lo que haya en el socket y aplica los mensajes completos (el resto
+// espera al próximo recv), llamando a onMessage después de cada uno.
+// Devuelve los mensajes aplicados, o -1 si la partida terminó o el flujo no
+// es de un espectador
+template <typename F>
+static int receiveMessages(int fd, std::vector<uint8_t>& buf, SpectateView& view, F onMessage) {
+    uint8_t chunk[64 << 10];
+    ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+    if (n <= 0) return (n < 0 && errno == EINTR) ? 0 : -1;
+    buf.insert(buf.end(), chunk, chunk + n);
+
+    int applied = 0;
+    size_t used = 0;   // Bytes ya aplicados al principio de buf
+    while (buf.size() - used >= 4) {
+        const uint8_t* p = buf.data() + used;
+        uint32_t len = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+        if (len > SPECTATE_RING) return -1;
+        if (buf.size() - used - 4 < len) break;
+        applySpectateMessage(view, p + 4, len);
+        used += 4 + len;
+        ++applied;
+        onMessage();
+    }
+    buf.erase(buf.begin(), buf.begin() + used);
+    return applied;
+}
+
+// Modo -c: cada frame recibido se dibuja sobre la terminal virtual, como lo
+// haría el espectador en una terminal de 40x120
+static int runCapture(int fd, const std::string& path, int frames) {
+    TermCapture cap;
+    if (!cap.open(40, 120)) {
+        std::fprintf(stderr, "spectate: no se pudo abrir la terminal virtual (terminfo de xterm)\n");
+        return 1;
+    }
+    initColors();
+
+    SpectateView view;
+    std::vector<uint8_t> buf;
+    VtStats total, worst;
+    int drawn = 0;
+    bool ended = false;
+    while (!ended && drawn < frames) {
+        pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, -1) < 0 && errno != EINTR) break;
+        int got = receiveMessages(fd, buf, view, [&]() {
+            if (drawn >= frames || !view.valid) return;
+            drawView(view, path, false);
+            VtStats s = cap.frame();
+            total.add(s);
+            worst.bytes = std::max(worst.bytes, s.bytes);
+            worst.cellsChanged = std::max(worst.cellsChanged, s.cellsChanged);
+            ++drawn;
+        });
+        ended = got < 0;
+    }
+    cap.close();
+
+    if (drawn == 0) {
+        std::fprintf(stderr, "spectate: la partida terminó sin frames\n");
+        return 1;
+    }
+    double n = drawn;
+    std::printf("frames %d%s\n", drawn, ended ? " (la partida terminó antes)" : "");
+    std::printf("bytes/frame %.1f (máx %llu)  movimientos %.1f  atributos %.1f\n", total.bytes / n,
+                (unsigned long long)worst.bytes, total.cursorMoves / n, total.attrChanges / n);
+    std::printf("celdas escritas %.1f  cambiadas %.1f (máx %llu)  secuencias ignoradas %llu\n",
+                total.cellsWritten / n, total.cellsChanged / n, (unsigned long long)worst.cellsChanged,
+                (unsigned long long)total.ignored);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    std::string path;
+    int captureFrames = 0;
+    int arg = 1;
+    if (arg + 1 < argc && std::strcmp(argv[arg], "-c") == 0) {
+        captureFrames = std::max(1, std::atoi(argv[arg + 1]));
+        arg += 2;
+    }
+    const char* target = arg < argc ? argv[arg] : nullptr;
+    int fd = openSpectate(target, path);
+    if (fd < 0) {
+        std::fprintf(stderr, "spectate: no hay partidas en curso%s%s\n", target ? " en " : "",
+                     target ? target : "");
+        return 1;
+    }
+    if (captureFrames > 0) {
+        int rc = runCapture(fd, path, captureFrames);
+        close(fd);
+        return rc;
+    }
+
+    initscr();
+    cbreak();
+    noecho();
+    curs_set(0);
+    keypad(stdscr, TRUE);
+    nodelay(stdscr, TRUE);
+    initColors();
+
+    SpectateView view;
+    std::vector<uint8_t> buf;
+    bool ended = false, dirty = true;
+    while (true) {
+        if (dirty) drawView(view, path, ended);
+        dirty = false;
+
+        pollfd fds[2] = {{STDIN_FILENO, POLLIN, 0}, {ended ? -1 : fd, POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0 && errno != EINTR) break;
+
+        int key = getch();
+        if (key == KEY_RESIZE) dirty = true;
+        else if (key != ERR && (ended || key == 'q' || key == 'Q' || key == 27)) break;
+
+        if (!(fds[1].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+        int got = receiveMessages(fd, buf, view, [&]() { dirty = true; });
+        if (got < 0) ended = dirty = true;
+    }
+
+    endwin();
+    close(fd);
+    return 0;
+}
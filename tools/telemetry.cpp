@@ -0,0 +1,208 @@
+/*
+telemetry.cpp - Resume los archivos de telemetría (.bkt) que deja el juego en
+telemetry/: ladrillos destruidos por segundo, dónde golpea la bola en la
+paleta, tiempo hasta perder una vida y cuánto tarda cada nivel.
+
+Los archivos se reparten entre hilos y de cada lote sólo se decodifican las
+columnas de tipo, frame y valor.
+
+Uso: telemetry [-j hilos] [directorio|archivo.bkt ...]
+     Sin argumentos lee el directorio telemetry/
+     -j  hilos de lectura (0 = uno por núcleo, por defecto)
+*/
+#include "../src/telemetry.h"
+#include <pthread.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const int MAX_LEVELS = 5;
+const int REL_BINS = 10;   // Histograma del golpe en la paleta, de -1 a +1
+
+// Acumulados de un hilo (se suman al final)
+struct Summary {
+    long files = 0, bad = 0, games = 0;
+    unsigned long rows = 0, bytes = 0;
+    double seconds = 0.0;              // Tiempo jugado (frames simulados)
+    long bricks = 0, powerups = 0;
+    long relBins[REL_BINS] = {};
+    std::vector<float> lifeSecs;       // Del inicio del nivel o la vida anterior a perder una
+    long levelStarted[MAX_LEVELS + 1] = {}, levelCleared[MAX_LEVELS + 1] = {};
+    double levelSecs[MAX_LEVELS + 1] = {};
+
+    void merge(const Summary& o) {
+        files += o.files; bad += o.bad; games += o.games;
+        rows += o.rows; bytes += o.bytes; seconds += o.seconds;
+        bricks += o.bricks; powerups += o.powerups;
+        for (int i = 0; i < REL_BINS; ++i) relBins[i] += o.relBins[i];
+        lifeSecs.insert(lifeSecs.end(), o.lifeSecs.begin(), o.lifeSecs.end());
+        for (int l = 0; l <= MAX_LEVELS; ++l) {
+            levelStarted[l] += o.levelStarted[l];
+            levelCleared[l] += o.levelCleared[l];
+            levelSecs[l] += o.levelSecs[l];
+        }
+    }
+};
+
+static void scanFile(const std::string& path, Summary& s, TelemetryBatch& batch) {
+    TelemetryReader in;
+    if (!in.open(path.c_str())) {
+        ++s.bad;
+        return;
+    }
+    ++s.files;
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) s.bytes += st.st_size;
+
+    double secPerFrame = in.header.tickUs / 1e6;
+    uint32_t levelStart = 0, lifeStart = 0, lastFrame = 0;
+    int level = 0;
+    while (in.next(batch, columnBit(TC_TYPE) | columnBit(TC_FRAME) | columnBit(TC_VALUE))) {
+        s.rows += batch.rows;
+        for (uint32_t i = 0; i < batch.rows; ++i) {
+            uint32_t f = batch.frame[i];
+            int32_t v = batch.value[i];
+            lastFrame = f;
+            switch (batch.type[i]) {
+            case EV_BRICK_DESTROYED:
+                ++s.bricks;
+                break;
+            case EV_PADDLE_HIT: {
+                int bin = (int)((v + 1000) * REL_BINS / 2001);
+                s.relBins[std::min(std::max(bin, 0), REL_BINS - 1)]++;
+                break;
+            }
+            case EV_POWERUP_CAUGHT:
+                ++s.powerups;
+                break;
+            case EV_LIFE_LOST:
+                s.lifeSecs.push_back((float)((f - lifeStart) * secPerFrame));
+                lifeStart = f;
+                break;
+            case EV_LEVEL_STARTED:
+                level = std::min(std::max(v, 0), MAX_LEVELS);
+                levelStart = lifeStart = f;
+                s.levelStarted[level]++;
+                if (v == 1) ++s.games;
+                break;
+            case EV_LEVEL_CLEARED:
+                s.levelCleared[level]++;
+                s.levelSecs[level] += (f - levelStart) * secPerFrame;
+                break;
+            }
+        }
+    }
+    s.seconds += lastFrame * secPerFrame;
+}
+
+// Reparto de archivos entre hilos (cada hilo toma el siguiente libre)
+struct ScanShared {
+    const std::vector<std::string>* paths;
+    std::atomic<size_t> next{0};
+};
+
+struct ScanWorker {
+    ScanShared* shared;
+    Summary sum;
+};
+
+static void* scanWorker(void* arg) {
+    auto* w = (ScanWorker*)arg;
+    TelemetryBatch batch;
+    size_t i;
+    while ((i = w->shared->next.fetch_add(1)) < w->shared->paths->size()) {
+        scanFile((*w->shared->paths)[i], w->sum, batch);
+    }
+    return nullptr;
+}
+
+static bool endsWith(const std::string& s, const char* suffix) {
+    size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+static void addPath(const std::string& path, std::vector<std::string>& paths) {
+    DIR* dir = opendir(path.c_str());
+    if (!dir) {
+        paths.push_back(path);
+        return;
+    }
+    while (dirent* e = readdir(dir)) {
+        std::string name = e->d_name;
+        if (endsWith(name, ".bkt")) paths.push_back(path + "/" + name);
+    }
+    closedir(dir);
+}
+
+static float percentile(std::vector<float>& v, double p) {
+    if (v.empty()) return 0.0f;
+    size_t k = std::min(v.size() - 1, (size_t)(p * v.size()));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+int main(int argc, char** argv) {
+    int threads = 0;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc) threads = std::atoi(argv[++i]);
+        else addPath(argv[i], paths);
+    }
+    if (argc == 1 || paths.empty()) addPath("telemetry", paths);
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    threads = std::max(1, std::min<int>(threads, (int)paths.size()));
+
+    auto t0 = std::chrono::steady_clock::now();
+    ScanShared shared;
+    shared.paths = &paths;
+    std::vector<ScanWorker> workers(threads);
+    std::vector<pthread_t> tids(threads);
+    for (int t = 0; t < threads; ++t) {
+        workers[t].shared = &shared;
+        pthread_create(&tids[t], nullptr, scanWorker, &workers[t]);
+    }
+    Summary s;
+    for (int t = 0; t < threads; ++t) {
+        pthread_join(tids[t], nullptr);
+        s.merge(workers[t].sum);
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::printf("archivos: %ld (%ld inválidos)   partidas: %ld   eventos: %lu   %.1f MB\n",
+                s.files, s.bad, s.games, s.rows, s.bytes / 1e6);
+    std::printf("lectura: %.3f s con %d hilos, %.0f eventos/s, %.1f MB/s\n", secs, threads,
+                s.rows / std::max(secs, 1e-9), s.bytes / 1e6 / std::max(secs, 1e-9));
+
+    std::printf("\ntiempo jugado: %.1f s   ladrillos: %ld (%.2f/s)   power-ups: %ld\n",
+                s.seconds, s.bricks, s.seconds > 0 ? s.bricks / s.seconds : 0.0, s.powerups);
+
+    long hits = 0;
+    for (long n : s.relBins) hits += n;
+    std::printf("\ngolpes en la paleta: %ld\n", hits);
+    for (int i = 0; i < REL_BINS; ++i) {
+        double pct = hits ? 100.0 * s.relBins[i] / hits : 0.0;
+        std::printf("  %+4.1f..%+4.1f %6.1f%% %s\n", -1.0 + 0.2 * i, -0.8 + 0.2 * i, pct,
+                    std::string((size_t)(pct / 2), '#').c_str());
+    }
+
+    double lifeMean = 0.0;
+    for (float x : s.lifeSecs) lifeMean += x;
+    if (!s.lifeSecs.empty()) lifeMean /= s.lifeSecs.size();
+    std::printf("\nvidas perdidas: %zu   segundos hasta perderla: prom %.1f  p50 %.1f  p90 %.1f\n",
+                s.lifeSecs.size(), lifeMean, percentile(s.lifeSecs, 0.5), percentile(s.lifeSecs, 0.9));
+
+    std::printf("\n%-6s %10s %10s %12s\n", "nivel", "empezados", "superados", "s prom.");
+    for (int l = 1; l <= MAX_LEVELS; ++l) {
+        std::printf("%-6d %10ld %10ld %12.1f\n", l, s.levelStarted[l], s.levelCleared[l],
+                    s.levelCleared[l] ? s.levelSecs[l] / s.levelCleared[l] : 0.0);
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+/*
+validate.cpp - Valida una tabla de puntajes repitiendo sin terminal la
+grabación de cada entrada. Las partidas se simulan a toda velocidad (sin la
+pausa del tick) y repartidas entre todos los núcleos; una entrada se acepta
+sólo si la repetición llega exactamente al puntaje informado.
+
+Uso: validate [-w] [-j hilos] [highscores.txt]
+     -w  reescribe la tabla dejando sólo las entradas aceptadas
+*/
+#include "../src/highscores.h"
+#include "../src/replay.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+int main(int argc, char** argv) {
+    bool write = false;
+    int threads = 0;
+    const char* file = "highscores.txt";
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-w") == 0) write = true;
+        else if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc) threads = std::atoi(argv[++i]);
+        else file = argv[i];
+    }
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    HighscoreManager table(file);
+    const std::vector<HighscoreEntry> entries = table.getScores();
+
+    // Se cargan todas las grabaciones antes de repetir (la lectura no entra
+    // en la medición)
+    std::vector<InputRecording> recs;
+    std::vector<int> recIndex(entries.size(), -1);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].replay.empty()) continue;
+        InputRecording rec;
+        if (!loadRecording(rec, table.replayPath(entries[i]).c_str())) continue;
+        recIndex[i] = (int)recs.size();
+        recs.push_back(rec);
+    }
+
+    std::vector<int> scores;
+    auto t0 = std::chrono::steady_clock::now();
+    unsigned long frames = replayParallel(recs, scores, threads);
+    auto t1 = std::chrono::steady_clock::now();
+    double secs = std::chrono::duration<double>(t1 - t0).count();
+
+    std::vector<HighscoreEntry> accepted;
+    std::printf("%-4s %8s %-12s %-10s %10s  %s\n", "#", "score", "fecha", "nombre", "repetido", "estado");
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const HighscoreEntry& e = entries[i];
+        const char* status;
+        int replayed = -1;
+        if (e.replay.empty()) {
+            status = "sin grabación";
+        } else if (recIndex[i] < 0) {
+            status = "grabación ilegible";
+        } else {
+            replayed = scores[recIndex[i]];
+            status = (replayed == e.score) ? "ok" : "no coincide";
+        }
+        if (replayed == e.score) accepted.push_back(e);
+
+        char rep[16] = "-";
+        if (replayed >= 0) std::snprintf(rep, sizeof(rep), "%d", replayed);
+        std::printf("%-4zu %8d %-12s %-10s %10s  %s\n", i + 1, e.score, e.date.c_str(),
+                    e.name.c_str(), rep, status);
+    }
+
+    std::printf("\n%zu aceptadas, %zu rechazadas; %lu frames en %.3f s (%.0f frames/s, %d hilos)\n",
+                accepted.size(), entries.size() - accepted.size(), frames, secs,
+                secs > 0 ? frames / secs : 0.0, threads);
+
+    if (write && !table.setScores(accepted)) {
+        std::fprintf(stderr, "no se pudo escribir %s\n", file);
+        return 1;
+    }
+    return accepted.size() == entries.size() ? 0 : 2;
+}